@@ -0,0 +1,56 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstdint>
+#include <ostream>
+
+// 内存分配计数
+// make ALLOC_COUNT=1编译时替换全局的operator new，按线程统计分配次数（线程局部计数，不需要同步），
+// 用于测试和基准测试检查游戏帧和渲染帧在预热之后不再分配内存。默认编译时不替换，计数始终为0
+class AllocationCounter {
+public:
+    // 是否编译了分配计数
+    static bool isEnabled();
+
+    // 当前线程累计的分配次数
+    static uint64_t getThreadCount();
+};
+
+// 检查一段反复执行的代码（例如一个游戏帧）在预热之后是否分配内存
+// begin和end必须在同一个线程中调用
+class AllocationCheck {
+private:
+    const char* name;
+    uint64_t warmup;
+    uint64_t runs;
+    uint64_t start;
+    // 预热之后分配了内存的次数、分配总数和单次最多的分配次数
+    uint64_t failedRuns;
+    uint64_t allocations;
+    uint64_t worst;
+
+public:
+    // 前warmup次不检查（容器在这期间增长到稳定的容量）
+    AllocationCheck(const char* name, uint64_t warmup);
+
+    void begin() { start = AllocationCounter::getThreadCount(); }
+    void end();
+
+    // 预热之后是否从未分配内存
+    bool isClean() const { return failedRuns == 0; }
+
+    // 输出检查结果（未编译分配计数时不输出）
+    void report(std::ostream& out) const;
+};
+
+// 在作用域内检查一次执行
+class AllocationScope {
+private:
+    AllocationCheck& check;
+
+public:
+    explicit AllocationScope(AllocationCheck& check) : check(check) { check.begin(); }
+    ~AllocationScope() { check.end(); }
+};
+
+#endif // ALLOCATION_COUNTER_H
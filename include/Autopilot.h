@@ -0,0 +1,131 @@
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+#include <vector>
+#include <cstdint>
+#include "Simulation.h"
+
+// 自动驾驶玩家：用于无人值守的演示模式和长时间稳定性测试
+// 在占用表上用BFS寻找到最佳食物的路径。占用表记录每个格子还要多少帧才会空出来
+// （蛇身第i节在蛇尾移动len-i次后空出，对手蛇同样计算），因此可以安全地追着自己的尾巴走。
+// 路径在帧之间保留，只有目标消失、路径被挡或下一步不安全时才重新规划。
+// 占用表和搜索状态与地图一样按16x16的块存放，块在一帧中第一次用到时才分配，下一帧开始时全部回收；
+// 搜索只到最后一个食物过期为止（最多SEARCH_LIMIT个格子），没有安全路径时活动空间最多数到蛇长的两倍，
+// 因此每帧的耗时和内存只与蛇长和食物的剩余时间有关，与地图大小无关
+class Autopilot {
+private:
+    // 一个格子的占用和搜索状态
+    struct ScratchCell {
+        uint32_t visited;    // 最近一次访问它的搜索的标记
+        int32_t dist;        // 到达时间（visited等于当前标记时有效）
+        int32_t parent;      // BFS中的上一个格子（同上）
+        uint16_t freeAfter;  // 还要多少帧才空出（0表示空，BLOCKED表示不能进入）
+    };
+
+    static const int CHUNK_SHIFT = 4;
+    static const int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+    static const int CHUNK_MASK = CHUNK_SIZE - 1;
+    static const int CHUNK_CELLS = CHUNK_SIZE * CHUNK_SIZE;
+    static const uint32_t NO_CHUNK = 0xFFFFFFFF;
+    // 构造或改变地图尺寸时为块池预留的块数上限（4MB），不超过这个数的帧不再为块申请内存
+    static const size_t RESERVED_CHUNKS = 1024;
+
+    int width;
+    int height;
+    // 每行的块数向上取为2的幂（2^columnShift），格子编号只需移位和掩码就能得到块和块内偏移
+    int columnShift;
+
+    // 本帧每个块在池中的序号，按格子编号的高位索引（NO_CHUNK表示本帧还没有用到，其中的格子都是空的）
+    std::vector<uint32_t> chunkIndex;
+    // 本帧已分配块的格子，每块CHUNK_CELLS个，块内按行存放；容量在帧之间保留
+    std::vector<ScratchCell> chunkPool;
+    // 上面两个数组的起始地址（BFS的内层循环不经过vector的下标运算，块池扩大时更新）
+    uint32_t* chunkIndexData;
+    ScratchCell* cellData;
+    // 本帧已分配的块下标（下一帧开始时据此回收）
+    std::vector<uint32_t> usedSlots;
+    // 有关卡时的地图，新分配的块从中读取墙（没有关卡时为nullptr）
+    const Map* wallMap;
+
+    // BFS的工作数组（容量为一次搜索最多访问的格子数，每帧不再分配内存）
+    std::vector<int> queue;
+    uint32_t visitStamp;
+
+    // 当前规划的路径（反向存放，back()是下一步要进入的格子）
+    std::vector<int> path;
+    int targetCell;
+
+    // 统计
+    uint64_t planCount;
+    uint64_t reuseCount;
+
+    static const uint16_t BLOCKED = 0xFFFF;
+
+    // 一次搜索最多访问的格子数（不超过它的地图上搜索覆盖整个可到达的区域）
+    static const int SEARCH_LIMIT = 1 << 16;
+
+    // 没有安全路径时比较各方向的活动空间，至少数到这么多格子
+    static const int FALLBACK_AREA = 1024;
+
+    // 格子编号：块下标（块行 << columnShift | 块列）在高位，块内偏移（行 << 4 | 列）在低8位
+    int cellId(int x, int y) const {
+        return (((y >> CHUNK_SHIFT) << columnShift | (x >> CHUNK_SHIFT)) << (2 * CHUNK_SHIFT)) |
+               ((y & CHUNK_MASK) << CHUNK_SHIFT) | (x & CHUNK_MASK);
+    }
+    int cellX(int cell) const {
+        return ((cell >> (2 * CHUNK_SHIFT)) & ((1 << columnShift) - 1)) << CHUNK_SHIFT | (cell & CHUNK_MASK);
+    }
+    int cellY(int cell) const {
+        return (cell >> (2 * CHUNK_SHIFT + columnShift)) << CHUNK_SHIFT | ((cell >> CHUNK_SHIFT) & CHUNK_MASK);
+    }
+
+    // 获取格子的状态，所在的块本帧还没有用到时先分配
+    ScratchCell& at(int cell);
+
+    // 为块下标slot分配一个块，格子为空（有关卡时墙为BLOCKED）
+    uint32_t allocateChunk(int slot, int firstX, int firstY);
+
+    // 确保BFS队列能容纳limit个格子
+    void reserveQueue(int limit);
+
+    // 回收上一帧的块，根据蛇、墙和炸弹重建占用表
+    void buildOccupancy(const Simulation& sim);
+
+    // 开始新一轮搜索（使visited全部失效）
+    void nextStamp();
+
+    // 从起点开始按到达时间做BFS，结果写入dist和parent（第一步不进入excluded）
+    // 只搜索到达时间不超过maxArrival的格子，最多访问SEARCH_LIMIT个格子
+    void search(int start, int excluded, int maxArrival);
+
+    // 从起点可以到达的格子数，达到limit时提前返回
+    int reachableArea(int start, int limit);
+
+    // 进入指定格子后是否还能活动（可到达的格子不少于蛇长）
+    bool isSafe(int cell, int length);
+
+    // 重新选择目标并规划路径
+    bool plan(const Simulation& sim, int head, int excluded);
+
+    // 获取相邻格子，越界时返回-1
+    int neighbor(int cell, Direction direction) const;
+
+    // 按DIRECTIONS的顺序获取四个相邻格子，越界时为-1
+    void neighbors(int cell, int* result) const;
+
+public:
+    // 构造函数
+    Autopilot();
+
+    // 开始新的一局时清除规划的路径
+    void reset();
+
+    // 为下一帧选择方向
+    Direction chooseDirection(const Simulation& sim);
+
+    // 完整规划的次数和直接沿用上一帧路径的次数
+    uint64_t getPlanCount() const { return planCount; }
+    uint64_t getReuseCount() const { return reuseCount; }
+};
+
+#endif // AUTOPILOT_H
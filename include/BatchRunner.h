@@ -0,0 +1,43 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <string>
+#include <cstdint>
+#include "Game.h"
+
+// 批量模拟选项
+struct BatchOptions {
+    // 局数
+    int games;
+    // 工作线程数（0表示使用全部CPU核心）
+    int threads;
+    // 基础种子，第i局的种子由它和i导出，结果与线程数无关
+    uint64_t seed;
+    // 玩家类型（AUTOPILOT或SOLVER）
+    PlayerKind player;
+    // 地图尺寸（格子数）
+    int mapWidth;
+    int mapHeight;
+    // 单局最多执行的帧数，超过后按存活计
+    uint64_t maxTicks;
+    // 游戏规则
+    SimulationRules rules;
+    // 每局结果的CSV输出路径（为空则不输出）
+    std::string outputPath;
+    // 关卡（nullptr表示没有墙），地图尺寸必须与关卡相同
+    const Level* level;
+
+    BatchOptions()
+        : games(1000), threads(0), seed(1), player(PlayerKind::AUTOPILOT), mapWidth(20), mapHeight(12),
+          maxTicks(100000), level(nullptr) {}
+};
+
+// 解析一条规则设置（例如speed-min=120或food-weights=60,20,15,5），失败时返回false
+bool parseSimulationRule(const std::string& setting, SimulationRules& rules);
+
+// 批量无头模拟：在工作窃取线程池中并行进行多局独立的游戏，每局使用独立的确定性随机数流，
+// 汇总得分、长度和存活时间的统计
+// 返回进程退出码（0表示成功）
+int runBatch(const BatchOptions& options);
+
+#endif // BATCH_RUNNER_H
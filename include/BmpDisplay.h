@@ -3,6 +3,7 @@
 
 #include <linux/fb.h>
 #include <string>
+#include <vector>
 
 // BMP文件头结构体
 #pragma pack(1)
@@ -38,6 +39,9 @@ void lcd_draw_bmp(const char *fbp, struct fb_var_screeninfo *scrinfo, int x0, in
 // 绘制BMP图片并移除指定颜色（实现透明背景效果）
 void lcd_draw_bmp_transparent(const char *fbp, struct fb_var_screeninfo *scrinfo, int x0, int y0, const char *path_name, unsigned int transparent_color);
 
+// 把BMP图片解码为从上到下逐行排列的ARGB像素（用于预先解码只绘制一次的覆盖层），失败时返回false
+bool bmp_decode(const char *path_name, int *width, int *height, std::vector<unsigned int>& pixels);
+
 // BMP显示函数（已弃用，保留接口仅为兼容性，内部实现改为调用lcd_draw_bmp）
 int bmp_display(const char *fbp, struct fb_var_screeninfo *scrinfo, const char *bmp_path, int x, int y);
 
@@ -0,0 +1,50 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+// 跟随蛇头的摄像机（以格子为单位）
+// 地图大于屏幕时只显示从摄像机左上角开始的一块区域。蛇头进入距离屏幕边缘不到margin格的区域时，
+// 摄像机向该方向移动，使蛇头回到边距上；蛇头跳到屏幕之外（例如开始新的一局）时以蛇头为中心。
+// 摄像机不会超出地图边界，地图不大于屏幕时固定在原点
+class Camera {
+private:
+    int viewColumns;
+    int viewRows;
+    int worldWidth;
+    int worldHeight;
+    int x;
+    int y;
+
+    // 把一个轴上的位置限制在地图范围内
+    static int clampAxis(int position, int view, int world);
+
+    // 沿一个轴跟随，返回新位置
+    static int followAxis(int position, int head, int view, int world);
+
+public:
+    // 构造函数（视口和地图尺寸均为格子数）
+    Camera(int viewColumns, int viewRows);
+
+    // 设置视口尺寸，地图尺寸未设置时与视口相同
+    void setView(int columns, int rows);
+
+    // 设置地图尺寸并回到原点
+    void setWorld(int width, int height);
+
+    // 跟随蛇头，dx和dy为摄像机移动的格子数，返回是否移动
+    bool follow(int headX, int headY, int& dx, int& dy);
+
+    // 摄像机左上角的地图坐标
+    int getX() const { return x; }
+    int getY() const { return y; }
+
+    // 视口尺寸
+    int getViewColumns() const { return viewColumns; }
+    int getViewRows() const { return viewRows; }
+
+    // 格子是否在视口内
+    bool isVisible(int cellX, int cellY) const {
+        return cellX >= x && cellX < x + viewColumns && cellY >= y && cellY < y + viewRows;
+    }
+};
+
+#endif // CAMERA_H
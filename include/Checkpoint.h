@@ -0,0 +1,100 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+class Simulation;
+
+// 检查点中保存的一个坐标
+struct CheckpointCell {
+    int16_t x;
+    int16_t y;
+};
+
+// 检查点中保存的一个食物
+struct CheckpointFood {
+    int16_t x;
+    int16_t y;
+    uint8_t type;
+    uint8_t reserved[3];
+    int64_t expirationTime;  // 模拟时间（毫秒）
+};
+
+// 检查点中最多保存的食物数量
+const size_t CHECKPOINT_MAX_FOODS = 8;
+
+// RNG状态的大小（直接按内存布局保存，文件头中记录大小以拒绝不同平台生成的文件）
+const size_t CHECKPOINT_RNG_SIZE = 5120;
+
+// 模拟状态的固定布局部分，蛇身坐标紧跟其后
+struct CheckpointState {
+    uint32_t seed;
+    uint32_t score;
+    int32_t gameSpeed;
+    int32_t originalGameSpeed;
+    uint8_t pepperEffectActive;
+    uint8_t gameOver;
+    uint8_t direction;
+    uint8_t growing;
+    uint64_t tickCount;
+    int64_t timeMs;
+    int64_t pepperEffectEndTime;
+    uint32_t foodCount;
+    uint32_t bodyLength;
+    CheckpointFood foods[CHECKPOINT_MAX_FOODS];
+    uint32_t rngSize;
+    uint8_t rng[CHECKPOINT_RNG_SIZE];
+};
+
+// 计算CRC32（检查点和关卡文件共用），crc为之前数据的结果，第一段数据传0
+uint32_t crc32Update(uint32_t crc, const void* data, size_t length);
+
+// 内存映射的游戏状态检查点
+// 文件由一个文件头和两个槽组成，两个槽轮流写入：先写状态和序号，最后写CRC。
+// 写入只修改映射的内存页，由内核在后台回写，游戏帧中不调用fsync。
+// 读取时选择CRC正确且序号最大的槽，因此写到一半（进程被杀或断电）的槽会被拒绝，
+// 最多回退到上一帧的状态；CRC正确但内容不合法的槽同样被拒绝并改用另一个槽
+class Checkpoint {
+private:
+    friend int runCheckpointCheck();
+
+    int fd;
+    uint8_t* base;
+    size_t fileSize;
+    size_t slotSize;
+    size_t maxCells;
+    uint64_t lastSeq;
+
+    // 获取指定槽的起始地址
+    uint8_t* slot(int index) const;
+
+    // 检查槽是否完整，返回其序号（不完整返回0）
+    uint64_t validateSlot(int index) const;
+
+public:
+    Checkpoint();
+    ~Checkpoint();
+
+    // 打开（必要时创建）与地图尺寸对应的检查点文件
+    // 文件头版本或尺寸不符时清空文件
+    bool open(const std::string& path, int mapWidth, int mapHeight);
+
+    // 关闭并解除映射
+    void close();
+
+    // 是否已打开
+    bool isOpen() const { return base != nullptr; }
+
+    // 保存模拟状态（在游戏帧之间调用，不阻塞于磁盘）
+    bool save(const Simulation& sim);
+
+    // 从最新的完整检查点恢复模拟状态，最新的槽无法恢复时使用另一个槽，没有可用检查点时返回false
+    bool load(Simulation& sim);
+};
+
+// 检查点的自检（--checkpoint-check）：最新的槽CRC正确但蛇身越界、不相邻或重复时应退回到另一个槽，返回0表示通过
+int runCheckpointCheck();
+
+#endif // CHECKPOINT_H
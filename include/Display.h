@@ -2,6 +2,7 @@
 #define DISPLAY_H
 
 #include <string>
+#include <vector>
 #include <linux/fb.h>
 #include <fcntl.h>
 #include <sys/mman.h>
@@ -11,9 +12,13 @@
 #include "Snake.h"
 #include "Food.h"
 #include "BmpDisplay.h"
+#include "Camera.h"
+#include "Minimap.h"
+#include "Level.h"
 
 // 前向声明
 enum class GameState;
+struct GameSnapshot;
 
 // 显示接口类
 class Display {
@@ -74,13 +79,88 @@ private:
 
     // 定义透明色（白色）
     static const unsigned int TRANSPARENT_COLOR = 0xFFFFFFFF;
+    
+    // 小地图与屏幕边缘的距离（像素），摄像机范围和蛇头的颜色
+    static const int MINIMAP_MARGIN = 8;
+    static const unsigned int MINIMAP_VIEW_COLOR = 0x00FFFFFF;
+    static const unsigned int MINIMAP_HEAD_COLOR = 0x00FFFF00;
+
+    // 墙格子的颜色和边框颜色
+    static const unsigned int WALL_COLOR = 0x00A05030;
+    static const unsigned int WALL_EDGE_COLOR = 0x00602818;
+
+    // 生成的覆盖层面板的底色、边框和符号颜色（符号不能是透明色）
+    static const unsigned int PANEL_COLOR = 0xFF202020;
+    static const unsigned int PANEL_EDGE_COLOR = 0xFFC0C0C0;
+    static const unsigned int GAME_OVER_SYMBOL_COLOR = 0xFFE03030;
+    static const unsigned int RESTART_SYMBOL_COLOR = 0xFFF0F0F0;
+
+    // 预先解码的覆盖层（从上到下逐行的ARGB像素，等于透明色的像素不绘制）
+    struct Overlay {
+        int width;
+        int height;
+        std::vector<unsigned int> pixels;
+
+        Overlay() : width(0), height(0) {}
+    };
+
+    // 游戏结束画面和重新开始的提示，加载资源时准备好，游戏结束时直接从内存合成，不再读取BMP文件
+    Overlay gameOverOverlay;
+    Overlay restartOverlay;
 
     // 背景缓冲区（用于减少频闪）
     char* bgBuffer;
     
     // 背景是否已绘制的标志
     bool backgroundDrawn;
-    bool getBmpSize(const std::string& filePath, int* width, int* height);
+    
+    // 无头模式：帧缓冲区为内存缓冲区，不打开/dev/fb0
+    bool headless;
+    
+    // 绘制蛇时复制蛇身坐标的缓冲区（复用容量，避免每帧分配）
+    std::vector<std::pair<int, int>> snakeBody;
+    
+    // 跟随蛇头的摄像机，地图大于屏幕时决定显示哪一块
+    Camera camera;
+    
+    // 两种草地格子的像素（帧缓冲格式），滚动时绘制新露出的格子不再读取BMP文件
+    std::vector<char> grassTiles;
+    bool grassTilesCached;
+    
+    // 关卡（墙和草地一起画在背景缓冲区中，每帧不再重画），以及墙格子的像素（第一次使用时生成）
+    const Level* level;
+    std::vector<char> wallTile;
+    
+    // 参考绘制模式：每帧从BMP文件重新绘制整个背景，不使用背景缓冲区、草地和墙的缓存和滚动，
+    // 作为优化绘制路径的对照（--verify-frames）
+    bool referenceMode;
+    
+    // 地图坐标转换为屏幕坐标，格子不在屏幕上时返回false
+    bool cellToScreen(int cellX, int cellY, int* screenX, int* screenY) const;
+    
+    // 从背景缓冲区中保存两种草地格子
+    void cacheGrassTiles();
+    
+    // 在背景缓冲区中绘制视口第column列、第row行的草地或墙
+    void drawBackgroundCell(int column, int row);
+    
+    // 视口第column列、第row行是否是墙
+    bool isWallCell(int column, int row) const;
+    
+    // 在buffer中绘制一个墙格子
+    void drawWallTile(char* buffer, int screenX, int screenY);
+    
+    // 摄像机移动后滚动背景缓冲区：已绘制的部分整块移动，只绘制新露出的行和列
+    void scrollBackground(int dx, int dy);
+    
+    // 参考绘制模式下直接在帧缓冲区中逐个格子绘制草地和墙
+    void drawReferenceBackground();
+    
+    // 生成边长为size的面板覆盖层，playSymbol为true时画播放符号（重新开始），否则画叉
+    static void buildPanelOverlay(Overlay& overlay, int size, bool playSymbol);
+    
+    // 以(x, y)为左上角把覆盖层合成到帧缓冲区
+    void drawOverlay(const Overlay& overlay, int x, int y);
 public:
     // 构造函数
     Display(int width, int height, int cellSize = 40);
@@ -91,21 +171,45 @@ public:
     // 初始化显示
     bool initialize();
     
+    // 以无头模式初始化（32位内存帧缓冲区），用于没有屏幕的测试和基准
+    bool initializeHeadless();
+    
     // 清空屏幕
     void clear();
     
     // 加载BMP资源
     bool loadResources(const std::string& path);
     
+    // 设置地图尺寸（格子数），地图大于屏幕时由摄像机跟随蛇头滚动
+    void setWorldSize(int width, int height);
+    
+    // 设置关卡（nullptr表示没有墙），墙在下一次drawMap时画进背景
+    void setLevel(const Level* newLevel);
+    
+    // 让摄像机跟随蛇头（在drawMap之前调用），摄像机移动时滚动背景
+    void followHead(int headX, int headY);
+    
+    // 获取摄像机
+    const Camera& getCamera() const { return camera; }
+    
     // 绘制地图
     void drawMap(const Map* map);
     
+    // 按快照绘制一帧（摄像机跟随蛇头、背景、食物、对手蛇和蛇），游戏的渲染帧和画面校验使用相同的顺序
+    void drawFrame(const GameSnapshot& snapshot);
+    
     // 绘制蛇
     void drawSnake(const Snake* snake);
     
+    // 根据身体坐标和移动方向绘制蛇（用于从快照渲染）
+    void drawSnakeBody(const std::vector<std::pair<int, int>>& body, Direction snakeDirection);
+    
     // 绘制食物
     void drawFood(const Food* food);
     
+    // 在屏幕右下角绘制小地图，并标出摄像机范围和蛇头
+    void drawMinimap(const Minimap& minimap, int headX, int headY);
+    
     // 绘制分数
     void drawScore(int score);
     
@@ -127,8 +231,11 @@ public:
     // 绘制一个像素点
     void drawPoint(int x, int y, unsigned int color);
 
-    //绘制游戏结束界面
-    void drawGameOver(); 
+    // 在屏幕中央合成游戏结束画面
+    void drawGameOver();
+    
+    // 在游戏结束画面下方合成重新开始的提示
+    void drawRestartPrompt();
 
     // 获取屏幕宽度
     int getScreenWidth() const { return screenWidth; }
@@ -138,6 +245,17 @@ public:
     
     // 获取单元格大小
     int getCellSize() const { return cellSize; }
+    
+    // 是否为无头模式
+    bool isHeadless() const { return headless; }
+    
+    // 切换参考绘制模式（在第一次drawMap之前调用）
+    void setReferenceMode(bool enabled) { referenceMode = enabled; }
+    
+    // 帧缓冲区及其每行字节数和每像素字节数（用于比较画面）
+    const char* getFrameBuffer() const { return fbp; }
+    size_t getLineBytes() const { return static_cast<size_t>(vinfo.xres_virtual) * (vinfo.bits_per_pixel / 8); }
+    int getBytesPerPixel() const { return vinfo.bits_per_pixel / 8; }
 };
 
 #endif // DISPLAY_H 
\ No newline at end of file
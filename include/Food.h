@@ -2,9 +2,11 @@
 #define FOOD_H
 
 #include "Map.h"
-#include "Snake.h"
 #include <cstdlib>
 #include <ctime>
+#include <random>
+
+class Level;
 
 // 食物类型枚举
 enum class FoodType {
@@ -20,10 +22,16 @@ private:
     int y;  // 食物的Y坐标
     FoodType type;  // 食物类型
 
+    // 按权重随机选择食物类型
+    void chooseType(std::mt19937& rng, const int typeWeights[4]);
+
 public:
     // 构造函数
     Food(int x = 0, int y = 0);
     
+    // 构造指定类型的食物（用于恢复保存的状态）
+    Food(int x, int y, FoodType type);
+    
     // 获取食物的X坐标
     int getX() const;
     
@@ -33,8 +41,20 @@ public:
     // 获取食物类型
     FoodType getType() const;
     
-    // 在地图上随机生成食物，避开蛇的位置
-    void generate(const Map& map, const Snake& snake);
+    // 在地图的空格子上随机生成食物（地图上必须已经标出蛇的位置）；没有空位时返回false
+    bool generate(const Map& map);
+    
+    // 使用指定的随机数生成器生成食物（用于可复现的模拟）
+    bool generate(const Map& map, std::mt19937& rng);
+    
+    // 使用指定的随机数生成器和类型权重（苹果、辣椒、肉、炸弹）生成食物
+    bool generate(const Map& map, std::mt19937& rng, const int typeWeights[4]);
+    
+    // 在关卡的食物区中随机选一个格子生成食物，选中的格子不空时返回false（调用者可以重试）
+    bool generateInZone(const Map& map, std::mt19937& rng, const int typeWeights[4], const Level& level);
+    
+    // 食物在地图上对应的元素类型
+    MapElementType getMapElement() const;
     
     // 更新地图上的食物位置
     void updateMap(Map& map) const;
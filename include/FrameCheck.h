@@ -0,0 +1,15 @@
+#ifndef FRAME_CHECK_H
+#define FRAME_CHECK_H
+
+#include <string>
+#include "Game.h"
+
+// 画面校验：无头执行一局回放（选项中给出录像时）或自动驾驶、哈密顿回路玩家的游戏，
+// 每帧分别用参考绘制（每帧从BMP文件重画整个背景，不使用任何缓存）和游戏使用的优化绘制
+// 画到两块内存帧缓冲区上，按格子比较两者的哈希，报告第一个不同的帧和格子。
+// 用于确认背景缓存、滚动等绘制优化没有改变画面。最多校验frames帧，游戏结束时提前停止
+// 返回进程退出码（0表示所有帧一致）
+int runFrameCheck(int frames, uint32_t seed, int mapWidth, int mapHeight, const std::string& resourcePath,
+                  const GameOptions& options = GameOptions());
+
+#endif // FRAME_CHECK_H
@@ -3,52 +3,103 @@
 
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <chrono>
 #include <vector>
+#include <ostream>
 #include "Map.h"
 #include "Snake.h"
 #include "Food.h"
 #include "Display.h"
+#include "Minimap.h"
 #include "Input.h"
+#include "Latency.h"
+#include "GameSnapshot.h"
+#include "TripleBuffer.h"
+#include "Simulation.h"
+#include "Replay.h"
+#include "Checkpoint.h"
+#include "Autopilot.h"
+#include "HamiltonianPlayer.h"
+#include "MctsPlayer.h"
+#include "TickScheduler.h"
+#include "ProfiledMutex.h"
+#include "Watchdog.h"
+#include "AllocationCounter.h"
+#include "UiState.h"
 
-// 游戏状态枚举
-enum class GameState {
-    RUNNING,
-    PAUSED,
-    GAME_OVER,
-    EXIT
+// 待处理的转向（携带时间戳用于延迟统计）
+struct TurnCommand {
+    Direction direction;
+    int64_t eventTime;  // 内核事件时间戳
+    int64_t readTime;   // 输入线程读到的时间
 };
 
-// 带有生存时间的食物结构体
-struct FoodWithLifetime {
-    Food food;
-    std::chrono::time_point<std::chrono::steady_clock> expirationTime;
-    bool isExpired() const {
-        return std::chrono::steady_clock::now() >= expirationTime;
-    }
+// 运行模式
+enum class RuntimeMode {
+    THREADED,    // 游戏、渲染、输入各一个线程
+    EVENT_LOOP   // 单线程epoll事件循环，游戏帧由timerfd驱动
+};
+
+// 玩家类型
+enum class PlayerKind {
+    HUMAN,      // 玩家通过触摸屏或按键操作
+    AUTOPILOT,  // 自动驾驶（演示模式和稳定性测试），游戏结束后自动开始下一局
+    SOLVER,     // 哈密顿回路玩家，能填满整个地图（最坏情况测试），游戏结束后自动开始下一局
+    MCTS        // 蒙特卡洛树搜索玩家，多线程推演，游戏结束后自动开始下一局
+};
+
+// 游戏启动选项
+struct GameOptions {
+    // 无头模式：不打开帧缓冲设备，渲染到内存缓冲区
+    bool headless;
+    // 是否探测/dev/input下的输入设备和标准输入
+    bool probeInputDevices;
+    // 运行模式
+    RuntimeMode runtime;
+    // 随机种子（0表示使用当前时间）
+    uint32_t seed;
+    // 录像文件路径（为空则不录制）
+    std::string recordPath;
+    // 回放的录像文件路径（为空则正常游戏），回放时忽略玩家的转向
+    std::string replayPath;
+    // 检查点文件路径（为空则不保存），启动时从中恢复上一次未结束的游戏
+    std::string checkpointPath;
+    // 玩家类型
+    PlayerKind player;
+    // 演示模式：自动驾驶，玩家操作时接管并开始新的一局
+    bool attractMode;
+    // MCTS玩家的线程数和每次决策的时间预算
+    MctsSettings mcts;
+    // 地图尺寸（格子数，0表示与屏幕相同），大于屏幕时摄像机跟随蛇头滚动
+    int mapWidth;
+    int mapHeight;
+    // 游戏规则（对手蛇数量等）
+    SimulationRules rules;
+    // 关卡（nullptr表示没有墙），由调用者持有；地图尺寸必须与关卡相同
+    const Level* level;
+    // 游戏帧错过截止时间后跳过还是追赶
+    TickPolicy tickPolicy;
+    // 卡顿阈值（毫秒，0表示不启用监视），游戏帧或渲染帧的间隔超过目标加上阈值时写出跟踪文件
+    int watchdogMs;
+    std::string watchdogDumpPath;
+    
+    GameOptions()
+        : headless(false), probeInputDevices(true), runtime(RuntimeMode::THREADED), seed(0),
+          player(PlayerKind::HUMAN), attractMode(false), mapWidth(0), mapHeight(0), level(nullptr),
+          tickPolicy(TickPolicy::SKIP), watchdogMs(0), watchdogDumpPath("stall-trace.json") {}
 };
 
 // 游戏类
+// 负责线程、输入、渲染和录像，游戏规则和状态在Simulation中
 class Game {
 private:
     // 游戏状态
     std::atomic<GameState> state;
     
-    // 游戏地图
-    Map map;
-    
-    // 蛇
-    Snake snake;
-    
-    // 食物列表
-    std::vector<FoodWithLifetime> foods;
-    
-    // 最大同时存在的食物数量
-    const size_t maxFoods = 5;
-    
-    // 食物生存时间（秒）
-    const unsigned int foodLifetime = 15;
+    // 游戏逻辑模拟（受gameMutex保护）
+    Simulation sim;
     
     // 显示接口
     Display display;
@@ -59,10 +110,76 @@ private:
     // 游戏线程
     std::thread gameThread;
     std::thread renderThread;
-    std::thread inputThread;
     
-    // 线程同步
-    std::mutex gameMutex;
+    // 线程同步（make PROFILE_LOCKS=1时统计竞争）
+    ProfiledMutex gameMutex;
+    
+    // 待处理转向队列（输入线程写入，游戏线程每帧取出一个）
+    static const size_t TURN_QUEUE_CAPACITY = 4;
+    TurnCommand pendingTurns[TURN_QUEUE_CAPACITY];
+    size_t pendingTurnHead;
+    size_t pendingTurnCount;
+    ProfiledMutex turnMutex;
+    
+    // 输入延迟统计
+    LatencyTracker latency;
+    
+    // 最近一次应用的转向（受gameMutex保护，随快照发布给渲染线程）
+    uint64_t turnSerial;
+    int64_t turnEventTime;
+    int64_t turnTickTime;
+    
+    // 渲染线程已经统计过显示延迟的转向序号（只由渲染线程访问）
+    uint64_t presentedTurnSerial;
+    
+    // 小地图及其对应的游戏帧和地图重建次数（只由渲染线程访问，地图大于屏幕时才显示）
+    Minimap minimap;
+    uint64_t minimapTick;
+    uint32_t minimapGeneration;
+    bool minimapValid;
+    
+    // 渲染线程最近画出的游戏帧号（用于统计跳过的帧）
+    uint64_t renderedTick;
+    
+    // 渲染快照三缓冲：游戏线程在gameMutex内发布，渲染线程无锁读取
+    TripleBuffer<GameSnapshot> snapshots;
+    
+    // 录像写入和回放（受gameMutex保护）
+    ReplayWriter replayWriter;
+    ReplayReader replayReader;
+    bool replaying;
+    
+    // 游戏状态检查点（受gameMutex保护）
+    Checkpoint checkpoint;
+    
+    // 自动驾驶、哈密顿回路和MCTS玩家（受gameMutex保护），是否由它们控制可在输入线程中修改
+    Autopilot autopilot;
+    HamiltonianPlayer solver;
+    MctsPlayer mctsPlayer;
+    std::atomic<bool> autopilotActive;
+    LatencyHistogram plannerTime;
+    
+    // 游戏帧的节拍（只在游戏线程或事件循环中使用）
+    TickScheduler scheduler;
+    
+    // 游戏帧和渲染帧的抖动与卡顿监视（--watchdog）
+    Watchdog watchdog;
+    
+    // 预热之后游戏帧和渲染帧不应分配内存（make ALLOC_COUNT=1时检查）
+    AllocationCheck tickAllocations;
+    AllocationCheck frameAllocations;
+    
+    // 启动选项
+    GameOptions options;
+    
+    // 游戏开始的时间（用于计算CPU占用率）
+    int64_t startTime;
+    
+    // 渲染帧率
+    static const int TARGET_FPS = 15;
+    
+    // 分配检查前不检查的帧数（容器在这期间增长到稳定的容量）
+    static const int ALLOCATION_WARMUP = 30;
     
     // 屏幕尺寸
     int screenWidth;
@@ -71,50 +188,75 @@ private:
     // 单元格大小
     int cellSize;
     
-    // 游戏速度（毫秒/帧）
-    int gameSpeed;
+    // 资源路径
+    std::string resourcePath;
     
-    // 原始游戏速度（用于辣椒效果结束后恢复）
-    int originalGameSpeed;
+    // 界面状态机（游戏结束画面、重新开始的提示及其超时），受uiMutex保护，状态可以无锁读取。
+    // 加锁顺序为gameMutex在前；持有uiMutex时不获取gameMutex，也不休眠
+    UiStateMachine ui;
+    std::mutex uiMutex;
+    // 游戏状态或界面截止时间改变时唤醒等待的游戏线程（多线程模式）和事件循环（eventfd）
+    std::condition_variable uiChanged;
+    int uiEventFd;
     
-    // 辣椒效果持续时间（毫秒）
-    std::chrono::time_point<std::chrono::steady_clock> pepperEffectEndTime;
+    // 渲染线程已经合成到画面上的界面状态（RUNNING表示没有覆盖层，只由渲染线程访问）
+    UiState overlayState;
+
+    // 执行一个游戏帧，返回距下一帧的间隔（毫秒）
+    int tick();
     
-    // 辣椒效果是否激活
-    bool pepperEffectActive;
+    // 在调度器的截止时间执行一个游戏帧，并计算下一帧的截止时间
+    void scheduledTick();
     
-    // 资源路径
-    std::string resourcePath;
+    // 绘制一帧；游戏结束画面和重新开始的提示各合成一次，之后不再重画，直到新的一局开始
+    void renderFrame();
     
-    bool isGameOverDrawn = false;
-
-    // 游戏主循环
+    // 游戏主循环（多线程模式）
     void gameLoop();
     
-    // 渲染循环
+    // 渲染循环（多线程模式）
     void renderLoop();
     
-    // 输入处理循环
-    void inputLoop();
+    // 单线程事件循环（事件循环模式）
+    void eventLoop();
+    
+    // 输入事件回调（在输入线程中调用）
+    void onInputEvent(const InputEvent& event);
+    
+    // 设置游戏状态并通知界面状态机（RUNNING和PAUSED），唤醒等待状态改变的线程
+    void setState(GameState next);
     
-    // 更新游戏状态
-    void update();
+    // 唤醒等待状态改变或界面截止时间的游戏线程和事件循环
+    void notifyUi();
     
-    // 处理碰撞
-    void handleCollisions();
+    // 暂停或游戏结束时等待状态改变或界面超时（不持有gameMutex），超时交给状态机处理
+    void waitForUiEvent();
     
-    // 检查辣椒效果是否结束
-    void checkPepperEffect();
+    // 界面截止时间到达时调用状态机并执行它要求的动作
+    void handleUiTimeout();
     
-    // 生成食物
-    void generateFood();
+    // 执行状态机要求的动作（调用者不能持有gameMutex或uiMutex）
+    void dispatchUiAction(UiAction action);
     
-    // 检查和移除过期食物
-    void checkAndRemoveExpiredFoods();
+    // 取出一个有效的待处理转向并应用到蛇上（调用者必须持有gameMutex）
+    void applyPendingTurn(uint64_t tick);
+    
+    // 发布当前状态的渲染快照（调用者必须持有gameMutex）
+    void publishSnapshot();
+    
+    // 按快照更新小地图：连续的帧只应用改变的格子，跳帧或地图重建后从蛇和食物重新生成
+    void updateMinimap(const GameSnapshot& snapshot);
+    
+    // 为新的一局选择随机种子
+    uint32_t chooseSeed() const;
+    
+    // 写入录像结束标记（调用者必须持有gameMutex或已停止所有线程）
+    void finishRecording();
     
 public:
     // 构造函数
-    Game(int width, int height, int cellSize = 40, const std::string& resourcePath = "./assets/pic");
+    Game(int width, int height, int cellSize = 40, const std::string& resourcePath = "./assets/pic",
+         const GameOptions& options = GameOptions());
     
     // 析构函数
     ~Game();
@@ -134,16 +276,37 @@ public:
     // 结束游戏
     void exit();
     
-    // 重置游戏
+    // 重置游戏（复用显示、输入设备、线程和所有容器）。不是常数时间：在gameMutex内清空上一局分配的地图块
+    // （块数最多与上一局的蛇长成正比）、重新写入关卡的墙、按行计数查找空位生成食物（与地图高度成正比），
+    // 启用检查点时再写入一次检查点，然后发布快照；不随地图面积增长（--reset-bench测量与上一局长度的关系）
     void reset();
     
+    // 重置并开始新的一局（玩家在游戏结束画面上操作或自动玩家的结束画面超时时调用）
+    void restart();
+    
     // 等待所有线程结束
     void waitForThreads();
     
     // 获取当前游戏状态
     GameState getState() const;
     
-    void updateMap();
+    // 获取当前界面状态
+    UiState getUiState() const { return ui.getState(); }
+    
+    // 获取输入处理对象（用于在start之前注入额外的事件源）
+    Input& getInput() { return input; }
+    
+    // 获取输入延迟统计
+    const LatencyTracker& getLatencyTracker() const { return latency; }
+    
+    // 输出运行时统计（CPU占用和上下文切换）
+    void reportRuntimeStats(std::ostream& out) const;
+    
+    // 预热之后游戏帧和渲染帧是否都没有分配内存（未编译分配计数时总是true）
+    bool isAllocationFree() const { return tickAllocations.isClean() && frameAllocations.isClean(); }
+    
+    // 开启或关闭自动驾驶
+    void setAutopilot(bool active);
 };
 
-#endif // GAME_H
\ No newline at end of file
+#endif // GAME_H
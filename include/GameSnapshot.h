@@ -0,0 +1,55 @@
+#ifndef GAME_SNAPSHOT_H
+#define GAME_SNAPSHOT_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "Snake.h"
+#include "Food.h"
+#include "Map.h"
+
+class Simulation;
+
+// 游戏状态枚举
+enum class GameState {
+    RUNNING,
+    PAUSED,
+    GAME_OVER,
+    EXIT
+};
+
+// 渲染所需的游戏状态快照
+// 游戏线程在每个游戏帧结束后写入并发布，渲染线程只读，不需要持有gameMutex
+struct GameSnapshot {
+    // 产生该快照的游戏帧序号
+    uint64_t tick;
+    // 游戏状态
+    GameState state;
+    // 蛇的移动方向和身体（第一个元素为蛇头）
+    Direction direction;
+    std::vector<std::pair<int, int>> body;
+    // 对手蛇的身体和移动方向（死亡的对手蛇身体为空）
+    std::vector<std::vector<std::pair<int, int>>> rivalBodies;
+    std::vector<Direction> rivalDirections;
+    // 当前的食物
+    std::vector<Food> foods;
+    // 该帧地图上改变的格子和地图重建的次数（渲染线程据此增量更新小地图）
+    std::vector<MapChange> mapChanges;
+    uint32_t mapGeneration;
+    // 辣椒效果是否激活
+    bool pepperActive;
+    // 最近一次应用的转向（序号为0表示还没有转向），用于统计显示延迟
+    uint64_t turnSerial;
+    int64_t turnEventTime;
+    int64_t turnTickTime;
+
+    GameSnapshot()
+        : tick(0), state(GameState::PAUSED), direction(Direction::RIGHT), mapGeneration(0), pepperActive(false),
+          turnSerial(0), turnEventTime(0), turnTickTime(0) {}
+
+    // 从模拟中复制帧号、蛇、食物、对手蛇和地图变化（容量足够时不分配内存）；
+    // 游戏状态和转向序号由调用者填写
+    void capture(const Simulation& sim);
+};
+
+#endif // GAME_SNAPSHOT_H
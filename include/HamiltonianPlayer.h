@@ -0,0 +1,53 @@
+#ifndef HAMILTONIAN_PLAYER_H
+#define HAMILTONIAN_PLAYER_H
+
+#include "Simulation.h"
+
+// 哈密顿回路玩家：用于让蛇填满整个地图的最坏情况测试
+// 按当前地图尺寸构造一条经过每个格子恰好一次的回路，蛇沿回路前进时永远不会撞到自己。
+// 蛇较短时允许沿回路方向抄近路，只要不越过蛇尾（保留余量），蛇身始终保持回路上的顺序。
+// 抄近路后蛇头到蛇尾之间剩余的空格必须容得下沿途的食物带来的增长；炸弹使蛇变短后严格沿回路走，
+// 直到蛇尾走过原来蛇身占据的一段
+class HamiltonianPlayer {
+private:
+    int width;
+    int height;
+
+    // 上一次决策时的蛇长和帧号（帧号变小表示开始了新的一局），以及严格沿回路走到的帧号
+    size_t lastLength;
+    uint64_t lastTick;
+    uint64_t strictUntilTick;
+
+    // 回路的长度（不存在回路时为0）
+    int cycleLength;
+
+    // 按地图尺寸确定回路（回路是固定的蛇形，序号由坐标直接计算，不按格子存表，大地图上不占内存）
+    void build(int mapWidth, int mapHeight);
+
+    // 格子在回路上的序号
+    int cycleIndex(int cell) const;
+
+    // 回路上第index个格子
+    int cycleCell(int index) const;
+
+    // 沿回路从a走到b的距离
+    int cycleDistance(int from, int to) const;
+
+    // 获取相邻格子，越界时返回-1
+    int neighbor(int cell, Direction direction) const;
+
+    // 抄近路到cell之后，沿回路到蛇尾的空格是否容得下途中食物带来的增长
+    bool hasRoomAfter(const Simulation& sim, int cell, int tail) const;
+
+public:
+    // 构造函数
+    HamiltonianPlayer();
+
+    // 为下一帧选择方向
+    Direction chooseDirection(const Simulation& sim);
+
+    // 指定尺寸的地图是否存在哈密顿回路（至少一边为偶数）
+    static bool cycleExists(int mapWidth, int mapHeight);
+};
+
+#endif // HAMILTONIAN_PLAYER_H
@@ -2,13 +2,15 @@
 #define INPUT_H
 
 #include <string>
-#include <queue>
-#include <mutex>
-#include <condition_variable>
+#include <vector>
+#include <functional>
 #include <thread>
 #include <atomic>
+#include <cstdint>
 #include "Snake.h"
 
+struct input_event;
+
 // 输入事件类型
 enum class InputEventType {
     NONE,
@@ -24,83 +26,124 @@ struct InputEvent {
     InputEventType type;
     int x;
     int y;
-    Direction direction;  // 用于TOUCH_MOVE事件
-    int keyCode;          // 用于键盘事件（预留）
-    
-    InputEvent() : type(InputEventType::NONE), x(0), y(0), direction(Direction::RIGHT), keyCode(0) {}
+    Direction direction;  // 用于TOUCH_MOVE和KEY_PRESS事件
+    int keyCode;          // 用于键盘事件
+    int64_t eventTime;    // 内核事件时间戳（CLOCK_MONOTONIC纳秒）
+    int64_t readTime;     // 输入线程读到事件的时间（CLOCK_MONOTONIC纳秒）
+
+    InputEvent() : type(InputEventType::NONE), x(0), y(0), direction(Direction::RIGHT), keyCode(0),
+                   eventTime(0), readTime(0) {}
+};
+
+// 输入设备类型（通过探测设备能力得到）
+enum class InputDeviceKind {
+    TOUCH,     // 触摸屏（绝对坐标 + BTN_TOUCH）
+    KEYBOARD,  // 键盘（方向键或WASD）
+    GAMEPAD    // 手柄（方向键/十字键）
 };
 
 // 输入接口类
+// 一个输入线程阻塞在epoll_wait上，同时监听所有探测到的evdev设备和标准输入，
+// 有数据时批量读取并立即通过回调转发事件，不再使用睡眠轮询
 class Input {
+public:
+    // 事件回调（在输入线程中调用）
+    typedef std::function<void(const InputEvent&)> EventHandler;
+
 private:
-    // 输入设备文件描述符
-    int touchFd;
+    // 已打开的evdev设备
+    struct Device {
+        int fd;
+        InputDeviceKind kind;
+        std::string path;
+        // 触摸屏坐标范围（来自EVIOCGABS）
+        int absMinX, absMaxX;
+        int absMinY, absMaxY;
+        // 当前触摸位置（屏幕坐标）
+        int touchX, touchY;
+        // 按下时的起始位置
+        int startX, startY;
+        // 本帧BTN_TOUCH状态（-1表示无变化），在SYN_REPORT时处理
+        int pendingTouch;
+    };
+
+    // 已打开的设备列表
+    std::vector<Device> devices;
+    // epoll实例
+    int epollFd;
+    // 用于唤醒输入线程退出的eventfd
+    int wakeFd;
+    // 是否监听标准输入
+    bool stdinWatched;
     // 是否初始化成功
     bool initialized;
-    // 上一次触摸位置
-    int lastTouchX;
-    int lastTouchY;
-    // 设备路径
-    std::string devicePath;
-    
-    // 事件队列，存储待处理的输入事件
-    std::queue<InputEvent> eventQueue;
-    // 互斥锁，保护事件队列
-    std::mutex eventMutex;
-    // 条件变量，用于通知有新事件
-    std::condition_variable hasEvent;
-    // 当前方向
-    std::atomic<Direction> currentDirection;
-    std::mutex directionMutex;
-    bool newInput;
-    
-    // 读取设备数据的线程函数
+    // 屏幕尺寸（用于触摸坐标缩放）
+    int screenWidth;
+    int screenHeight;
+
+    // 输入线程
+    std::thread readerThread;
+    std::atomic<bool> running;
+
+    // 事件回调
+    EventHandler eventHandler;
+
+    // 探测并打开/dev/input下所有可用设备
+    void probeDevices();
+    // 根据设备能力判断设备类型，不支持的设备返回false
+    bool classifyDevice(int fd, InputDeviceKind& kind);
+    // 将fd加入epoll监听（data.u32为设备索引）
+    bool watchFd(int fd, uint32_t tag);
+    // 输入线程函数
     void readDeviceThread();
-    // 检查设备是否就绪的函数
-    bool isDeviceReady();
+    // 批量读取并处理一个设备上的所有事件
+    void drainDevice(Device& device);
+    // 批量读取并处理标准输入
+    void drainStdin();
+    // 处理单个evdev事件
+    void handleDeviceEvent(Device& device, const struct input_event& ev, int64_t readTime);
+    // 转发事件
+    void dispatch(const InputEvent& event);
 
 public:
     // 构造函数
-    Input();
-    
+    Input(int screenWidth = 800, int screenHeight = 480);
+
     // 析构函数
     ~Input();
-    
-    // 初始化输入设备
-    bool initialize();
-    
-    // 获取输入事件
-    bool getEvent(InputEvent& event);
-    
+
+    // 初始化输入设备，probeDevices为false时只监听通过addDevice添加的设备（用于无头测试）
+    bool initialize(bool probeDevices = true);
+
+    // 添加一个输出struct input_event记录的fd（例如管道或uinput替身），必须在启动输入线程之前调用，fd由Input负责关闭
+    bool addDevice(int fd, InputDeviceKind kind, const std::string& name);
+
+    // 设置事件回调，必须在startInputThread之前调用
+    void setEventHandler(const EventHandler& handler);
+
     // 将输入事件转换为蛇的方向
     Direction convertEventToDirection(const InputEvent& event, Direction currentDirection);
-    
+
     // 关闭输入设备
     void close();
-    
+
     // 检查输入设备是否已初始化
     bool isInitialized() const { return initialized; }
-    
-    // 获取当前方向
-    Direction getDirection() const;
-    
-    // 检查是否有新的输入
-    bool hasNewInput() const;
-    
-    // 清除新输入标记
-    void clearNewInput();
-    
-    // 添加事件到队列
-    void addEvent(const InputEvent& event);
-    
-    // 处理键盘输入
-    void processKeyboardInput();
-    
+
+    // 获取已打开的设备数量
+    size_t getDeviceCount() const { return devices.size(); }
+
+    // 获取可供外部事件循环监听的fd（有输入就绪时可读）
+    int getPollFd() const { return epollFd; }
+
+    // 处理已就绪的输入并分发事件，timeoutMs为等待时间（-1为一直等待），出错时返回false
+    bool pollEvents(int timeoutMs);
+
     // 启动输入线程
-    std::thread* startInputThread();
-    
-    // 设置当前方向
-    void setDirection(Direction dir);
+    bool startInputThread();
+
+    // 停止并等待输入线程结束
+    void stopInputThread();
 };
 
-#endif // INPUT_H 
\ No newline at end of file
+#endif // INPUT_H
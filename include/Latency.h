@@ -0,0 +1,82 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// 返回CLOCK_MONOTONIC时间（纳秒），与evdev设置为CLOCK_MONOTONIC后的事件时间戳同一时钟
+int64_t monotonicNanos();
+
+// 延迟直方图（按2的幂划分微秒桶，无锁，可在任意线程记录）
+class LatencyHistogram {
+public:
+    // 桶i覆盖[2^i, 2^(i+1))微秒，桶0包含小于2微秒的值，最后一个桶包含所有更大的值
+    static const int BUCKET_COUNT = 26;
+
+    LatencyHistogram();
+
+    // 记录一个延迟值（纳秒），负值视为0
+    void record(int64_t nanos);
+
+    // 清空统计
+    void reset();
+
+    // 获取样本数
+    uint64_t getCount() const { return count.load(std::memory_order_relaxed); }
+
+    // 获取最大值（微秒）
+    int64_t getMaxMicros() const { return maxMicros.load(std::memory_order_relaxed); }
+
+    // 获取平均值（微秒）
+    int64_t getMeanMicros() const;
+
+    // 获取某个桶的样本数
+    uint64_t getBucket(int index) const { return buckets[index].load(std::memory_order_relaxed); }
+
+    // 估算百分位数（微秒，返回所在桶的上界）
+    int64_t getPercentileMicros(double percentile) const;
+
+private:
+    std::atomic<uint64_t> buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sumMicros;
+    std::atomic<int64_t> maxMicros;
+};
+
+// 输入到显示的各个阶段
+enum class LatencyStage {
+    KERNEL_TO_READER,  // 内核事件时间戳 → 输入线程读到
+    READER_TO_TICK,    // 输入线程读到 → 游戏帧应用转向
+    TICK_TO_PRESENT,   // 游戏帧应用转向 → 第一次显示该转向的画面
+    END_TO_END,        // 内核事件时间戳 → 显示
+    COUNT
+};
+
+// 输入延迟统计
+class LatencyTracker {
+public:
+    // 记录某个阶段的延迟（纳秒）
+    void record(LatencyStage stage, int64_t nanos);
+
+    // 获取某个阶段的直方图
+    const LatencyHistogram& getHistogram(LatencyStage stage) const;
+
+    // 清空所有阶段
+    void reset();
+
+    // 输出文本报告
+    void report(std::ostream& out) const;
+
+    // 将报告写入文件
+    bool writeReport(const std::string& path) const;
+
+    // 获取阶段名称
+    static const char* stageName(LatencyStage stage);
+
+private:
+    LatencyHistogram histograms[static_cast<int>(LatencyStage::COUNT)];
+};
+
+#endif // LATENCY_H
@@ -0,0 +1,15 @@
+#ifndef LATENCY_BENCH_H
+#define LATENCY_BENCH_H
+
+#include <string>
+#include "Game.h"
+
+// 无头输入延迟测试：通过管道注入合成的evdev按键事件，
+// 在内存帧缓冲区上运行完整的游戏线程，测量从事件时间戳到画面显示的端到端延迟
+// 可以指定运行模式，以便比较多线程和事件循环两种模式的延迟与CPU占用；
+// 传入的选项中的种子和录像路径同样生效，可用于生成测试录像
+// 返回进程退出码（0表示成功测量到延迟）
+int runLatencyBench(const std::string& resourcePath, int turnCount, const std::string& reportPath,
+                    const GameOptions& baseOptions = GameOptions());
+
+#endif // LATENCY_BENCH_H
@@ -0,0 +1,97 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// 关卡中一行内连续的一段格子（墙或食物区）
+struct LevelRun {
+    uint16_t x;
+    uint16_t y;
+    uint16_t length;
+    uint16_t reserved;
+};
+
+// 关卡中的出生点：蛇头位置和移动方向（Direction的值），蛇身在蛇头后方
+struct LevelSpawn {
+    uint16_t x;
+    uint16_t y;
+    uint8_t direction;
+    uint8_t reserved[3];
+};
+
+// 关卡文件（小端）：
+//   文件头：魔数"SNKL"、版本、地图宽高、各段的数量、CRC（覆盖文件头之后的全部数据）
+//   墙：wallRunCount个LevelRun
+//   出生点：spawnCount个LevelSpawn（至少一个；第一个给玩家，其余给对手蛇）
+//   食物区：zoneRunCount个LevelRun（食物只在这些格子中生成，没有时在整个地图生成）
+// 文件用mmap只读映射，墙、出生点和食物区直接在映射的内存上读取，不复制
+class Level {
+private:
+    int fd;
+    const uint8_t* base;
+    size_t fileSize;
+
+    int width;
+    int height;
+    const LevelRun* wallRuns;
+    uint32_t wallRunCount;
+    const LevelSpawn* spawns;
+    uint32_t spawnCount;
+    const LevelRun* zoneRuns;
+    uint32_t zoneRunCount;
+
+    // 每个格子一位的墙位图，用于O(1)查询（绘制背景时使用）
+    std::vector<uint64_t> wallBits;
+
+    // 各食物区段结束时累计的格子数，用于按序号查找食物区格子
+    std::vector<uint32_t> zoneEnds;
+
+    // 检查映射的内容是否合法，并建立位图和累计数
+    bool validate(const std::string& path);
+
+public:
+    Level();
+    ~Level();
+
+    // 映射并检查关卡文件
+    bool load(const std::string& path);
+
+    // 解除映射
+    void close();
+
+    // 是否已加载
+    bool isLoaded() const { return base != nullptr; }
+
+    // 地图尺寸
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // 墙
+    size_t getWallRunCount() const { return wallRunCount; }
+    const LevelRun& getWallRun(size_t i) const { return wallRuns[i]; }
+
+    // 格子是否是墙（坐标必须在地图内）
+    bool isWall(int x, int y) const {
+        size_t cell = static_cast<size_t>(y) * width + x;
+        return (wallBits[cell >> 6] >> (cell & 63)) & 1;
+    }
+
+    // 出生点
+    size_t getSpawnCount() const { return spawnCount; }
+    const LevelSpawn& getSpawn(size_t i) const { return spawns[i]; }
+
+    // 食物区的格子数（0表示没有食物区）
+    uint32_t getZoneCellCount() const { return zoneEnds.empty() ? 0 : zoneEnds.back(); }
+
+    // 按行优先顺序获取第index个食物区格子
+    void getZoneCell(uint32_t index, int& x, int& y) const;
+
+    // 把文本关卡编译为关卡文件：每行一行格子，'#'墙，'*'食物区，'^' 'v' '<' '>'出生点（蛇头及方向），
+    // 其他字符为空格子；以';'开头的行是注释
+    static bool compile(const std::string& textPath, const std::string& levelPath);
+};
+
+#endif // LEVEL_H
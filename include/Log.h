@@ -0,0 +1,126 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// 日志级别
+enum class LogLevel : int {
+    DEBUG = 0,
+    INFO = 1,
+    WARN = 2,
+    ERROR = 3
+};
+
+// 编译时的最低级别（make LOG_LEVEL=n），低于它的日志语句不产生代码
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 1
+#endif
+
+// 一条日志（格式化后的文本，超长时截断）
+struct LogRecord {
+    static const size_t TEXT_SIZE = 248;
+
+    LogLevel level;
+    uint32_t length;
+    char text[TEXT_SIZE];
+};
+
+// 一个日志语句的限速状态：每种文本各有一个一秒的窗口，同一语句输出相同的文本时每秒最多输出REPEATS_PER_SECOND条
+// （不同的文本交替出现也一样，例如每帧依次报告几个缺少的文件）；一秒内同一语句最多跟踪TEXTS_PER_SITE种文本，
+// 更多的新文本同样丢弃。丢弃的只计数，在这个语句下一条输出的日志后面注明
+class LogSite {
+public:
+    static const uint32_t REPEATS_PER_SECOND = 1;
+    static const size_t TEXTS_PER_SITE = 32;
+
+private:
+    // 一种文本的窗口（windowStart为0表示空闲）
+    struct Entry {
+        std::atomic<uint32_t> hash;
+        std::atomic<int64_t> windowStart;
+        std::atomic<uint32_t> windowCount;
+
+        Entry() : hash(0), windowStart(0), windowCount(0) {}
+    };
+
+    Entry entries[TEXTS_PER_SITE];
+    std::atomic<uint64_t> suppressed;
+
+public:
+    LogSite() : suppressed(0) {}
+
+    // 文本的哈希为hash的这一条是否输出（多个线程同时使用同一语句时计数可能略有偏差）
+    bool allow(uint32_t hash);
+
+    // 取出并清零被限速丢弃的条数
+    uint64_t takeSuppressed() { return suppressed.exchange(0, std::memory_order_relaxed); }
+};
+
+// 一行日志：直接格式化到当前线程环形缓冲区的空位中（不分配内存），析构时经过限速后提交给后台写线程
+class LogLine {
+private:
+    LogSite& site;
+    LogRecord* record;
+    bool reserved;
+
+    void append(const char* text, size_t length);
+
+public:
+    LogLine(LogLevel level, LogSite& site);
+    ~LogLine();
+
+    LogLine& operator<<(const char* text);
+    LogLine& operator<<(const std::string& text);
+    LogLine& operator<<(char value);
+    LogLine& operator<<(int value);
+    LogLine& operator<<(unsigned int value);
+    LogLine& operator<<(long value);
+    LogLine& operator<<(unsigned long value);
+    LogLine& operator<<(long long value);
+    LogLine& operator<<(unsigned long long value);
+    LogLine& operator<<(double value);
+};
+
+// 异步日志
+// 每个线程有自己的单写者环形缓冲区，日志语句只格式化并发布一条记录；后台写线程在有新记录时被eventfd唤醒，
+// 把记录成批写到标准输出（DEBUG、INFO）或标准错误（WARN、ERROR），游戏、渲染和输入线程不再做同步的、
+// 每行刷新的终端输出。缓冲区满时丢弃新记录并计数。未启动写线程时（启动前、停止后、无头测试）直接写出
+class Log {
+public:
+    // 每个线程缓冲区的记录数
+    static const size_t RECORDS_PER_THREAD = 256;
+
+    // 启动后台写线程
+    static void start();
+
+    // 写出所有剩余的记录并停止写线程，之后的日志直接写出
+    static void stop();
+
+    // 在当前线程的缓冲区中预留一条记录，缓冲区满时返回nullptr；未启动时返回线程自己的临时记录
+    static LogRecord* reserve(bool& reserved);
+
+    // 提交预留的记录（reserved为false时直接写出）
+    static void commit(LogRecord* record, bool reserved);
+};
+
+// 日志限速的自检（--log-check）：两种文本交替经过同一个LOG_WARN语句时除第一次外都应被丢弃，返回0表示通过
+int runLogCheck();
+
+#define LOG_AT(level, message)                                                          \
+    do {                                                                                \
+        if (static_cast<int>(level) >= LOG_MIN_LEVEL) {                                 \
+            static LogSite logSite;                                                     \
+            LogLine(level, logSite) << message;                                         \
+        }                                                                               \
+    } while (0)
+
+// 日志语句，message是用<<连接的表达式，例如LOG_INFO("Game over after " << ticks << " ticks")
+#define LOG_DEBUG(message) LOG_AT(LogLevel::DEBUG, message)
+#define LOG_INFO(message) LOG_AT(LogLevel::INFO, message)
+#define LOG_WARN(message) LOG_AT(LogLevel::WARN, message)
+#define LOG_ERROR(message) LOG_AT(LogLevel::ERROR, message)
+
+#endif // LOG_H
@@ -2,9 +2,11 @@
 #define MAP_H
 
 #include <vector>
+#include <cstdint>
+#include <cstddef>
 
-// 地图元素类型
-enum class MapElementType {
+// 地图元素类型（每个格子一个字节）
+enum class MapElementType : uint8_t {
     EMPTY,
     WALL,
     SNAKE_HEAD,
@@ -16,31 +18,96 @@ enum class MapElementType {
     FOOD_BOMB     // 炸弹
 };
 
+// 一个格子在一帧内的变化（用于增量更新小地图等派生视图）
+struct MapChange {
+    int x;
+    int y;
+    MapElementType before;
+    MapElementType after;
+};
+
 // 地图类
+// 网格按16x16的块稀疏存放：只有含有非空格子的块才分配，块中最后一个格子清空时回收，
+// 因此地图可以远大于屏幕（上百万个格子），内存只与蛇和食物占用的区域有关。
+// 已分配的块连续存放在一个池中，复制地图只需复制几个数组
 class Map {
 private:
+    static const int CHUNK_SHIFT = 4;
+    static const int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+    static const int CHUNK_MASK = CHUNK_SIZE - 1;
+    static const int CHUNK_CELLS = CHUNK_SIZE * CHUNK_SIZE;
+    static const uint32_t NO_CHUNK = 0xFFFFFFFF;
+    // 构造时为格子池预留的块数（16KB），不超过这个数的地图在游戏中不再为块申请内存
+    static const size_t RESERVED_CHUNKS = 64;
+
     int width;  // 地图宽度
     int height; // 地图高度
-    std::vector<std::vector<MapElementType>> grid; // 二维网格表示地图
+    int chunkColumns; // 每行的块数
+
+    // 每个块在池中的序号（NO_CHUNK表示未分配，其中的格子都是EMPTY）
+    std::vector<uint32_t> chunkIndex;
+    // 已分配块的格子，每块CHUNK_CELLS个，块内按行存放
+    std::vector<MapElementType> chunkPool;
+    // 池中每块的非空格子数，为0时回收
+    std::vector<uint16_t> chunkOccupied;
+    // 回收后可以重用的池序号
+    std::vector<uint32_t> freeChunks;
+    // 池中每块对应的块下标（清空地图时只需访问已分配的块）
+    std::vector<uint32_t> chunkSlots;
+
+    // 每行内部格子（不含地图边缘，即可以生成食物的格子）中的非空格子数及其总和
+    std::vector<int> rowOccupied;
+    int interiorOccupied;
+
+    // 格子所在块的下标
+    int chunkSlot(int x, int y) const { return (y >> CHUNK_SHIFT) * chunkColumns + (x >> CHUNK_SHIFT); }
+
+    // 格子在块内的偏移
+    static int chunkOffset(int x, int y) { return ((y & CHUNK_MASK) << CHUNK_SHIFT) | (x & CHUNK_MASK); }
+
+    // 为块下标slot分配一个全空的块，返回其池序号
+    uint32_t allocateChunk(int slot);
 
 public:
     // 构造函数
     Map(int width, int height);
-    
+
     // 获取地图宽度
     int getWidth() const;
-    
+
     // 获取地图高度
     int getHeight() const;
-    
+
     // 获取指定位置的元素类型
     MapElementType getElement(int x, int y) const;
-    
+
     // 设置指定位置的元素类型
     void setElement(int x, int y, MapElementType element);
-    
-    // 清空地图（将所有元素设为EMPTY）
+
+    // 清空地图（将所有元素设为EMPTY并回收所有块），耗时与已分配的块数成正比，与地图大小无关
     void clear();
+
+    // 不做边界检查的访问（调用者保证坐标有效），用于模拟和搜索的内层循环
+    MapElementType getCell(int x, int y) const {
+        uint32_t chunk = chunkIndex[chunkSlot(x, y)];
+        if (chunk == NO_CHUNK) {
+            return MapElementType::EMPTY;
+        }
+        return chunkPool[chunk * CHUNK_CELLS + chunkOffset(x, y)];
+    }
+    void setCell(int x, int y, MapElementType element);
+
+    // 坐标是否在地图内
+    bool contains(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+
+    // 内部格子（不含地图边缘）中空格子的数量
+    int countEmptyInterior() const;
+
+    // 按行优先顺序查找第index个空的内部格子，index超出范围时返回false
+    bool findEmptyInterior(int index, int& x, int& y) const;
+
+    // 已分配的块数（用于统计内存占用）
+    size_t getAllocatedChunks() const { return chunkOccupied.size() - freeChunks.size(); }
 };
 
-#endif // MAP_H
\ No newline at end of file
+#endif // MAP_H
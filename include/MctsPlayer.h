@@ -0,0 +1,103 @@
+#ifndef MCTS_PLAYER_H
+#define MCTS_PLAYER_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <random>
+#include <memory>
+#include <cstdint>
+#include "Simulation.h"
+
+// MCTS玩家的参数
+struct MctsSettings {
+    // 搜索线程数（0表示使用全部CPU核心）
+    int threads;
+    // 每次决策的时间预算（毫秒）
+    int budgetMs;
+
+    MctsSettings() : threads(0), budgetMs(50) {}
+};
+
+// 蒙特卡洛树搜索玩家
+// 每次决策时在时间预算内反复进行"沿树选择 - 扩展 - 推演 - 回传"：把当前状态复制到草稿Simulation中
+// （地图和蛇都是连续存放的数组，复制不需要分配内存），并重新设置草稿的随机种子，
+// 因此搜索看不到真实的未来食物，树中的节点按动作序列区分（开环搜索）。
+// 推演时随机选择不会立即撞上的方向，并偏向最近的食物。
+// 每个线程有自己的树（根并行），结束后合并根节点各动作的访问次数，选择访问最多的动作。
+// 工作线程常驻，调用者线程作为第0个工作线程
+class MctsPlayer {
+private:
+    // 树节点，按动作序列区分
+    struct Node {
+        int32_t children[4];  // 各方向的子节点下标，-1表示未扩展
+        uint32_t visits;
+        double value;         // 回报之和
+    };
+
+    // 每个线程的搜索状态（只在开始搜索前分配）
+    struct Worker {
+        Simulation scratch;
+        std::vector<Node> nodes;
+        std::vector<int32_t> path;
+        std::mt19937 rng;
+        uint64_t rollouts;
+
+        Worker(const Simulation& sim, uint32_t seed);
+    };
+
+    MctsSettings settings;
+    int threadCount;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    // 向后台线程分发搜索任务
+    std::mutex mutex;
+    std::condition_variable startCondition;
+    std::condition_variable doneCondition;
+    uint64_t generation;
+    int pending;       // 本次决策中尚未完成的后台线程数
+    bool stopping;
+    const Simulation* root;
+    int64_t deadline;  // 本次决策的截止时间（单调时钟纳秒）
+
+    // 统计
+    uint64_t decisionCount;
+    int64_t searchNanos;
+
+    // 第一次决策时创建工作状态和后台线程
+    void start(const Simulation& sim);
+
+    // 后台线程主循环
+    void workerLoop(int index);
+
+    // 在截止时间之前搜索，结果留在worker的树中
+    void search(Worker& worker);
+
+    // 分配一个新节点，返回其下标
+    static int32_t newNode(Worker& worker);
+
+    // 推演中选择方向：不会立即撞上的方向中随机选择，偏向最近的食物
+    static Direction rolloutDirection(Worker& worker);
+
+public:
+    // 构造函数（不创建线程，第一次决策时才创建）
+    explicit MctsPlayer(const MctsSettings& settings = MctsSettings());
+
+    // 析构函数，结束后台线程
+    ~MctsPlayer();
+
+    // 为下一帧选择方向
+    Direction chooseDirection(const Simulation& sim);
+
+    // 决策次数、推演次数和每秒推演次数（按搜索的墙钟时间计算）
+    uint64_t getDecisionCount() const { return decisionCount; }
+    uint64_t getRolloutCount() const;
+    double getRolloutsPerSecond() const;
+
+    // 搜索线程数（第一次决策之前为0）
+    int getThreadCount() const { return threadCount; }
+};
+
+#endif // MCTS_PLAYER_H
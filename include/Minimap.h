@@ -0,0 +1,92 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include <vector>
+#include <cstdint>
+#include "Map.h"
+#include "Level.h"
+
+// 小地图：整个地图的缩略图，缓存在自己的像素缓冲区中（0x00RRGGBB）
+// 地图能放下时每个格子画成pixelsPerCell见方的像素块，否则每cellsPerPixel见方的格子合成一个像素。
+// 每个像素记录其中蛇和食物的格子数，只按每帧改变的格子增减计数并重画对应的像素，
+// 从不遍历整个地图，因此每帧的开销与地图大小无关。关卡的墙不会改变，只在setWalls时计数一次
+class Minimap {
+private:
+    int worldWidth;
+    int worldHeight;
+    // 每个格子的像素数和每个像素的格子数（至少一个为1）
+    int pixelsPerCell;
+    int cellsPerPixel;
+    // 像素块的列数和行数
+    int blockColumns;
+    int blockRows;
+
+    // 每个像素块中蛇和食物的格子数
+    std::vector<uint16_t> snakeCells;
+    std::vector<uint16_t> foodCells;
+
+    // 每个像素块中墙的格子数，以及含有墙的像素块（清空后只需重画这些块）
+    std::vector<uint16_t> wallCells;
+    std::vector<int> wallBlocks;
+
+    // 缩略图像素，按行存放
+    std::vector<uint32_t> pixels;
+
+    // 元素计入的类别
+    static bool isSnake(MapElementType element) {
+        return element == MapElementType::SNAKE_HEAD || element == MapElementType::SNAKE_BODY;
+    }
+    static bool isFood(MapElementType element) {
+        return element >= MapElementType::FOOD;
+    }
+
+    // 按计数重画一个像素块
+    void paintBlock(int block);
+
+    // 调整格子所在像素块的计数，delta为1或-1
+    void countCell(int x, int y, MapElementType element, int delta);
+
+public:
+    // 背景、蛇和食物的颜色
+    static const uint32_t BACKGROUND_COLOR = 0x00204020;
+    static const uint32_t SNAKE_COLOR = 0x0080E080;
+    static const uint32_t FOOD_COLOR = 0x00E04040;
+    static const uint32_t WALL_COLOR = 0x00806040;
+
+    // 构造函数（未配置时为空）
+    Minimap();
+
+    // 按地图尺寸和最大像素尺寸选择缩放比例，并清空
+    void configure(int worldWidth, int worldHeight, int maxWidth, int maxHeight);
+
+    // 是否已配置
+    bool isConfigured() const { return !pixels.empty(); }
+
+    // 设置关卡的墙（在configure之后调用，之后clear时保留）
+    void setWalls(const Level& level);
+
+    // 清空蛇和食物的计数和像素（墙保留）
+    void clear();
+
+    // 加入一个格子（清空后从蛇和食物重新生成时使用）
+    void addCell(int x, int y, MapElementType element);
+
+    // 应用一个格子的变化
+    void applyChange(const MapChange& change);
+
+    // 缩略图尺寸（像素）
+    int getWidth() const { return blockColumns * pixelsPerCell; }
+    int getHeight() const { return blockRows * pixelsPerCell; }
+
+    // 格子左上角在缩略图中的像素坐标
+    int cellToPixelX(int x) const { return x / cellsPerPixel * pixelsPerCell; }
+    int cellToPixelY(int y) const { return y / cellsPerPixel * pixelsPerCell; }
+
+    // 每个格子的像素数（缩小时为1）
+    int getPixelsPerCell() const { return pixelsPerCell; }
+
+    // 第row行像素
+    const uint32_t* getLine(int row) const { return &pixels[static_cast<size_t>(row) * getWidth()]; }
+};
+
+#endif // MINIMAP_H
@@ -0,0 +1,26 @@
+#ifndef PLAYER_BENCH_H
+#define PLAYER_BENCH_H
+
+#include <string>
+#include <cstdint>
+#include "Game.h"
+
+// 无头自动玩家测试：不创建线程，直接在Simulation上连续进行多局游戏，
+// 统计每帧的选择方向耗时和游戏帧（蛇、地图、食物生成）耗时、每局帧数和蛇的最终长度。
+// 蛇占满地图时该局结束。给出资源路径时还在内存帧缓冲区上抽样测量drawSnake的耗时
+// 和地图大于屏幕时摄像机滚动背景的耗时，
+// 并单独统计蛇长超过地图90%之后的耗时，用于测量最坏情况。MCTS玩家还报告每秒推演次数
+// 返回进程退出码（0表示成功）
+int runPlayerBench(PlayerKind player, int games, uint32_t seed, int mapWidth, int mapHeight,
+                   const std::string& resourcePath = "", const MctsSettings& mcts = MctsSettings());
+
+// 对手蛇数量测试：对手蛇数量从0开始逐次加倍到maxRivals，每种数量执行ticks帧（玩家与对手蛇使用相同的策略，
+// 撞死后换下一个种子重新开始），报告游戏帧耗时和平均存活的对手蛇数量，用于观察每帧开销随蛇的数量的增长
+int runRivalBench(int ticks, size_t maxRivals, uint32_t seed, int mapWidth, int mapHeight);
+
+// 重新开局测试：用哈密顿回路玩家把蛇养到16、32、64……格（最多到地图的一半），每种长度测量一次
+// Simulation::reset加上捕获渲染快照（Game::reset在gameMutex内做的工作，不含检查点）的耗时，
+// 同时报告上一局占用的地图块数，用于观察重置耗时随上一局长度的增长
+int runResetBench(uint32_t seed, int mapWidth, int mapHeight);
+
+#endif // PLAYER_BENCH_H
@@ -0,0 +1,83 @@
+#ifndef PROFILED_MUTEX_H
+#define PROFILED_MUTEX_H
+
+#include <mutex>
+#include <ostream>
+#include <cstdint>
+#include "Latency.h"
+
+// 加锁位置的字符串（文件:行号）
+#define LOCK_SITE_STRINGIFY(line) #line
+#define LOCK_SITE_LINE(line) LOCK_SITE_STRINGIFY(line)
+
+#ifdef PROFILE_LOCKS
+
+// 一个加锁位置的统计：加锁次数、等待时间和持有时间的直方图
+// 每个位置是一个静态对象，构造时加入全局链表，程序结束前不销毁
+class LockSite {
+private:
+    const char* function;
+    const char* location;
+    const char* mutexName;
+    LatencyHistogram waitTime;
+    LatencyHistogram holdTime;
+    LockSite* next;
+
+    friend class ProfiledMutex;
+    friend void reportLockProfile(std::ostream& out);
+
+public:
+    LockSite(const char* function, const char* location, const char* mutexName);
+};
+
+// 带竞争统计的互斥锁
+// 记录每个加锁位置的等待时间和持有时间，以及所有互斥锁中持有时间最长的几次（位置和持有的线程）。
+// 互斥锁的名字取自加锁位置，因此可以直接替换std::mutex成员而不改构造函数。
+// 持有者的信息在锁内记录，释放时仍持有锁，不需要额外同步
+class ProfiledMutex {
+private:
+    std::mutex mutex;
+    // 当前持有者的加锁位置和获得锁的时间（只由持有者访问）
+    LockSite* holderSite;
+    int64_t acquiredAt;
+
+public:
+    ProfiledMutex();
+
+    // 在指定位置加锁（由PROFILED_LOCK使用）
+    void lock(LockSite& site);
+
+    // 满足BasicLockable，可以用于std::lock_guard（统计到未标记的位置）
+    void lock();
+    bool try_lock();
+    void unlock();
+};
+
+// 按位置加锁并在作用域结束时释放
+class ProfiledLockGuard {
+private:
+    ProfiledMutex& mutex;
+
+public:
+    ProfiledLockGuard(ProfiledMutex& mutex, LockSite& site) : mutex(mutex) { mutex.lock(site); }
+    ~ProfiledLockGuard() { mutex.unlock(); }
+};
+
+// 在当前位置加锁，guard为守卫变量名
+#define PROFILED_LOCK(guard, lockable)                                                                   \
+    static LockSite guard##Site(__func__, __FILE__ ":" LOCK_SITE_LINE(__LINE__), #lockable);             \
+    ProfiledLockGuard guard(lockable, guard##Site)
+
+#else
+
+// 未启用时就是std::mutex，没有任何额外开销
+typedef std::mutex ProfiledMutex;
+
+#define PROFILED_LOCK(guard, lockable) std::lock_guard<std::mutex> guard(lockable)
+
+#endif // PROFILE_LOCKS
+
+// 输出各加锁位置的统计和最长的几次持有（未启用时不输出）
+void reportLockProfile(std::ostream& out);
+
+#endif // PROFILED_MUTEX_H
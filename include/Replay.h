@@ -0,0 +1,87 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include "Snake.h"
+
+// 录像文件格式（除魔数外全部为LEB128变长整数）：
+//   "SNKR" 版本 地图宽 地图高 随机种子
+//   每个转向一条记录：(与上一条记录的帧号差 << 2) | 方向，帧号从1开始，因此差值至少为1
+//   结束标记：0 最终帧号 最终蛇长
+// 只记录真正改变了方向的转向，回放时在对应帧执行之前应用
+
+// 录像中的一个转向
+struct ReplayTurn {
+    uint64_t tick;        // 在执行该帧之前应用
+    Direction direction;
+};
+
+// 录像写入
+class ReplayWriter {
+private:
+    FILE* file;
+    uint64_t lastTick;
+
+    // 写入一个变长整数
+    void writeVarint(uint64_t value);
+
+public:
+    ReplayWriter();
+    ~ReplayWriter();
+
+    // 创建录像文件并写入文件头
+    bool open(const std::string& path, int width, int height, uint32_t seed);
+
+    // 记录一个转向
+    void recordTurn(uint64_t tick, Direction direction);
+
+    // 写入结束标记并关闭文件
+    void finish(uint64_t finalTick, size_t finalLength);
+
+    // 是否正在录制
+    bool isOpen() const { return file != nullptr; }
+};
+
+// 录像读取
+class ReplayReader {
+private:
+    int width;
+    int height;
+    uint32_t seed;
+    std::vector<ReplayTurn> turns;
+    size_t nextTurn;
+    uint64_t finalTick;
+    size_t finalLength;
+    bool complete;
+
+public:
+    ReplayReader();
+
+    // 读取整个录像文件，文件头不合法或地图尺寸超出3x3到4096x4096时返回false
+    bool load(const std::string& path);
+
+    // 取出应在指定帧之前应用的转向，没有时返回false
+    bool takeTurn(uint64_t tick, Direction& direction);
+
+    // 回到录像开头
+    void rewind() { nextTurn = 0; }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    uint32_t getSeed() const { return seed; }
+    size_t getTurnCount() const { return turns.size(); }
+
+    // 录像是否有结束标记（没有说明录制时进程异常退出）
+    bool isComplete() const { return complete; }
+    uint64_t getFinalTick() const { return finalTick; }
+    size_t getFinalLength() const { return finalLength; }
+};
+
+// 无头快进回放：不创建线程和显示，以最快速度执行录像并校验结果是否一致
+// 返回进程退出码（0表示复现成功）
+int runReplayFastForward(const std::string& path);
+
+#endif // REPLAY_H
@@ -0,0 +1,249 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include "Map.h"
+#include "Snake.h"
+#include "Food.h"
+#include "Checkpoint.h"
+#include "Level.h"
+
+// 带有生存时间的食物结构体
+struct FoodWithLifetime {
+    Food food;
+    // 过期时间（模拟时间，毫秒）
+    int64_t expirationTime;
+    bool isExpired(int64_t now) const {
+        return now >= expirationTime;
+    }
+};
+
+// 可调整的游戏规则（默认值即游戏中使用的规则）
+struct SimulationRules {
+    // 开局时的游戏速度（毫秒/帧）
+    int initialSpeed;
+    // 速度曲线：max(minSpeed, speedBase - (蛇长 - 3) * speedStep)
+    int speedBase;
+    int speedStep;
+    int minSpeed;
+    // 辣椒效果持续时间（毫秒）
+    int pepperDurationMs;
+    // 最大同时存在的食物数量（不超过CHECKPOINT_MAX_FOODS时才能保存检查点）
+    size_t maxFoods;
+    // 食物生存时间（秒）
+    unsigned int foodLifetime;
+    // 苹果、辣椒、肉、炸弹的生成权重
+    int foodWeights[4];
+    // 由模拟内置策略控制的对手蛇数量（撞死后在随机空位重新出现）
+    size_t rivalSnakes;
+
+    SimulationRules()
+        : initialSpeed(300), speedBase(400), speedStep(10), minSpeed(150), pepperDurationMs(10000),
+          maxFoods(5), foodLifetime(15), rivalSnakes(0) {
+        foodWeights[0] = 60;
+        foodWeights[1] = 20;
+        foodWeights[2] = 15;
+        foodWeights[3] = 5;
+    }
+};
+
+// 游戏逻辑模拟
+// 只包含规则和状态，不涉及线程、显示和输入；所有随机数来自自带的RNG，
+// 时间以模拟毫秒计（每个游戏帧前进gameSpeed毫秒），因此相同的种子和转向序列总能得到相同的结果。
+// 关卡的墙在开局时写入地图（WALL），之后与蛇身一样是占用的格子：撞墙只需查一次地图，
+// 地图维护的空格子计数也不含墙，生成食物不需要再检查墙。
+// 玩家的蛇和对手蛇共用一张地图作为占用表：所有蛇先移动并空出蛇尾，再逐条查地图判断是否撞上蛇身，
+// 蛇头相撞用本帧新蛇头的小哈希表判断，不需要两两比较蛇身，每帧开销只与蛇的数量有关
+class Simulation {
+private:
+    // 游戏地图
+    Map map;
+
+    // 蛇
+    Snake snake;
+
+    // 对手蛇（死亡的蛇isAlive()为false，不在地图上），以及本帧移动了的和蛇头停在食物上的对手蛇序号
+    std::vector<Snake> rivals;
+    std::vector<size_t> movedRivals;
+    std::vector<size_t> feedingRivals;
+
+    // 本帧新蛇头的开放寻址哈希表：格子序号加1（0表示空槽）和所属的蛇（-1为玩家）
+    std::vector<uint32_t> headCells;
+    std::vector<int> headOwners;
+
+    // 食物列表
+    std::vector<FoodWithLifetime> foods;
+
+    // 本帧空出、在帧结束时才从地图上清除的格子（过期食物和缩短的蛇尾）
+    std::vector<std::pair<int, int>> vacatedCells;
+
+    // 最近一帧地图上真正改变的格子，以及地图整体重建的次数（开局和恢复检查点时加一）
+    std::vector<MapChange> changes;
+    uint32_t mapGeneration;
+
+    // 游戏规则
+    SimulationRules rules;
+
+    // 关卡（墙、出生点和食物区），nullptr表示没有墙的空地图
+    const Level* level;
+
+    // 随机数生成器及其种子
+    std::mt19937 rng;
+    uint32_t seed;
+
+    // 已执行的游戏帧数
+    uint64_t tickCount;
+
+    // 模拟时间（毫秒）
+    int64_t timeMs;
+
+    // 游戏速度（毫秒/帧）
+    int gameSpeed;
+
+    // 原始游戏速度（用于辣椒效果结束后恢复）
+    int originalGameSpeed;
+
+    // 辣椒效果结束时间（模拟时间，毫秒）
+    int64_t pepperEffectEndTime;
+
+    // 辣椒效果是否激活
+    bool pepperEffectActive;
+
+    // 游戏是否结束
+    bool gameOver;
+
+    // 得分（吃到的苹果、辣椒各1分，肉2分）
+    uint32_t score;
+
+    // 移动蛇并处理定时效果
+    void update();
+
+    // 处理碰撞
+    void handleCollisions();
+
+    // 检查辣椒效果是否结束
+    void checkPepperEffect();
+
+    // 补充食物到最大数量
+    void fillFoods();
+
+    // 检查和移除过期食物
+    void checkAndRemoveExpiredFoods();
+
+    // 本帧结束时把食物的变化和缩短的蛇尾同步到地图
+    void syncFoodCells();
+
+    // 根据蛇和食物重建地图
+    void updateMap();
+
+    // 帧内增量修改地图的唯一入口，记录真正改变的格子
+    void setMapCell(int x, int y, MapElementType element);
+    
+    // 预先为蛇分配的长度
+    size_t snakeCapacity() const;
+
+    // 移动所有存活的对手蛇并空出蛇尾
+    void moveRivals();
+
+    // 把新蛇头加入哈希表，与已有的蛇头相撞时返回其所属的蛇（-2表示没有相撞）
+    int insertHead(int x, int y, int owner);
+
+    // 检查对手蛇的碰撞，返回玩家的蛇是否与对手蛇头对头相撞
+    bool resolveRivalCollisions(std::pair<int, int> playerHead);
+
+    // 写入存活对手蛇的蛇头，从地图上移除本帧撞死的对手蛇
+    void settleRivals();
+
+    // 重新放置死亡的对手蛇（每条每帧尝试一次）：优先用关卡的出生点，否则在随机空位
+    void spawnRivals();
+
+    // 蛇头和其后两节都是空格子，且前方一格在地图内且为空时返回true
+    bool canSpawn(int x, int y, Direction direction) const;
+
+    // 把墙写入地图
+    void stampWalls();
+
+    // 处理对手蛇吃到的食物
+    void feedRivals();
+
+    // 对手蛇吃到炸弹后太短而死亡，其所有格子在帧结束时清除
+    void killRival(Snake& rival);
+
+public:
+    // 构造函数
+    Simulation(int width, int height, const SimulationRules& rules = SimulationRules());
+
+    // 设置关卡（调用者保证关卡尺寸与地图相同且在模拟之后销毁），下一次reset时生效
+    void setLevel(const Level* newLevel) { level = newLevel; }
+
+    // 获取关卡（没有时为nullptr）
+    const Level* getLevel() const { return level; }
+
+    // 以指定种子开始新的一局
+    void reset(uint32_t seed);
+
+    // 改变蛇的方向，返回方向是否真的改变了
+    bool turn(Direction direction);
+
+    // 推进一个游戏帧
+    void step();
+    
+    // 重新设置随机数生成器（搜索时在状态副本上使用，使之后生成的食物与真实游戏不同）
+    void reseedRandom(uint32_t newSeed) { rng.seed(newSeed); }
+
+    // 游戏是否结束
+    bool isGameOver() const { return gameOver; }
+
+    // 获取地图
+    const Map& getMap() const { return map; }
+
+    // 获取最近一帧地图上改变的格子（地图重建后为空）
+    const std::vector<MapChange>& getChanges() const { return changes; }
+
+    // 获取地图重建的次数，变化时派生视图需要从蛇和食物重新生成
+    uint32_t getMapGeneration() const { return mapGeneration; }
+
+    // 获取蛇
+    const Snake& getSnake() const { return snake; }
+
+    // 获取对手蛇（包括死亡等待重新出现的）
+    const std::vector<Snake>& getRivals() const { return rivals; }
+
+    // 对手蛇的策略：走向最近的食物，避开蛇身、炸弹和墙，多个方向同样好时用random选择
+    // （也用于测试中代替玩家，不消耗模拟自带的RNG）
+    Direction greedyDirection(const Snake& target, std::mt19937& random) const;
+
+    // 获取食物列表
+    const std::vector<FoodWithLifetime>& getFoods() const { return foods; }
+
+    // 获取当前游戏速度（毫秒/帧）
+    int getGameSpeed() const { return gameSpeed; }
+
+    // 辣椒效果是否激活
+    bool isPepperActive() const { return pepperEffectActive; }
+
+    // 获取已执行的游戏帧数
+    uint64_t getTick() const { return tickCount; }
+
+    // 获取模拟时间（毫秒）
+    int64_t getTimeMs() const { return timeMs; }
+
+    // 获取本局的随机种子
+    uint32_t getSeed() const { return seed; }
+
+    // 获取得分
+    uint32_t getScore() const { return score; }
+
+    // 获取游戏规则
+    const SimulationRules& getRules() const { return rules; }
+    
+    // 将完整状态写入检查点，蛇身超过maxCells、有对手蛇或关卡时返回false
+    bool saveCheckpoint(CheckpointState& state, CheckpointCell* cells, size_t maxCells) const;
+    
+    // 从检查点恢复完整状态，状态不合法时返回false且不修改当前状态
+    bool restoreCheckpoint(const CheckpointState& state, const CheckpointCell* cells);
+};
+
+#endif // SIMULATION_H
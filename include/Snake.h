@@ -2,6 +2,7 @@
 #define SNAKE_H
 
 #include <vector>
+#include <cstddef>
 #include <utility>
 
 // 方向枚举
@@ -15,8 +16,13 @@ enum class Direction {
 // 蛇类
 class Snake {
 private:
-    // 蛇身体，每个部分用坐标表示
-    std::vector<std::pair<int, int>> body;
+    // 蛇身体，每个部分用坐标表示，存放在环形缓冲区中：
+    // ring[headIndex]是蛇头，之后依次是蛇身，移动时只改写一个位置，不移动其余各节
+    std::vector<std::pair<int, int>> ring;
+    // 蛇头在环形缓冲区中的位置（容量总是2的幂，用掩码回绕）
+    size_t headIndex;
+    // 蛇的长度
+    size_t length;
     // 蛇移动方向
     Direction direction;
     // 上一次尝试改变的方向
@@ -26,10 +32,16 @@ private:
     // 标记蛇是否正在生长
     bool growing;
 
+    // 扩大环形缓冲区，保持各节顺序
+    void growCapacity(size_t minCapacity);
+
 public:
     // 构造函数
     Snake(int startX, int startY);
     
+    // 预留容量（例如地图格子数），之后移动和生长不再分配内存
+    void reserve(size_t capacity);
+    
     // 移动蛇
     void move();
     
@@ -54,8 +66,17 @@ public:
     // 获取蛇头位置
     std::pair<int, int> getHead() const;
     
-    // 获取蛇身体
-    const std::vector<std::pair<int, int>>& getBody() const;
+    // 获取蛇尾位置
+    std::pair<int, int> getTail() const { return getSegment(length - 1); }
+    
+    // 获取蛇的长度
+    size_t getLength() const { return length; }
+    
+    // 获取第i节的位置（0是蛇头）
+    std::pair<int, int> getSegment(size_t i) const { return ring[(headIndex + i) & (ring.size() - 1)]; }
+    
+    // 按从蛇头到蛇尾的顺序复制蛇身体（out的容量扩充到与环形缓冲区相同，之后只在蛇的容量增长时分配内存）
+    void copyBody(std::vector<std::pair<int, int>>& out) const;
     
     // 检查蛇是否存活
     bool isAlive() const;
@@ -65,6 +86,15 @@ public:
     
     // 获取蛇的当前移动方向
     Direction getDirection() const;
+    
+    // 蛇是否会在下一次移动时增长
+    bool isGrowing() const;
+    
+    // 在指定位置重新开始（长度3，默认向右，蛇身在蛇头后方），保留已分配的容量
+    void reset(int startX, int startY, Direction startDirection = Direction::RIGHT);
+    
+    // 从保存的状态恢复蛇
+    void restore(const std::vector<std::pair<int, int>>& savedBody, Direction savedDirection, bool savedGrowing);
 };
 
 #endif // SNAKE_H 
\ No newline at end of file
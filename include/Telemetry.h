@@ -0,0 +1,80 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// 遥测计数器（累计值）和仪表（当前值）
+enum class TelemetryCounter {
+    TICKS,              // 执行的游戏帧
+    FRAMES_RENDERED,    // 绘制的画面
+    FRAMES_SKIPPED,     // 渲染落后而没有画出的游戏帧
+    MISSED_DEADLINES,   // 错过截止时间的游戏帧
+    INPUT_EVENTS,       // 输入事件
+    MUTEX_WAIT_NANOS,   // 等待gameMutex的总时间（纳秒）
+    BYTES_BLITTED,      // 整块复制到帧缓冲区和背景缓冲区的字节数
+    SPRITE_CACHE_HITS,  // 从缓存的格子像素绘制背景的次数
+    SPRITE_LOADS,       // 从BMP文件读取绘制的次数
+    SNAKE_LENGTH,       // 当前蛇长（仪表）
+    SCORE,              // 当前得分（仪表）
+    COUNT
+};
+
+// 共享内存中的遥测块（固定布局，64位计数器，外部工具只读映射）
+struct TelemetryBlock {
+    char magic[4];
+    uint32_t version;
+    uint32_t counterCount;
+    int32_t pid;
+    std::atomic<uint64_t> values[static_cast<size_t>(TelemetryCounter::COUNT)];
+};
+
+// 遥测：游戏中的计数只是对共享内存的relaxed原子加法，不加锁、不输出日志。
+// 没有发布到共享内存时写入进程内的块，调用处不需要判断是否启用
+class Telemetry {
+private:
+    static TelemetryBlock localBlock;
+    static TelemetryBlock* block;
+    static std::string publishedName;
+
+public:
+    static const uint32_t VERSION = 1;
+
+    // 在POSIX共享内存中创建遥测块（name形如"/greedy-snake"），之后的计数写入其中
+    // 必须在其他线程开始计数之前调用
+    static bool publish(const std::string& name);
+
+    // 删除共享内存，之后的计数写回进程内的块（在其他线程结束后调用）
+    static void unpublish();
+
+    // 计数器加n
+    static void add(TelemetryCounter counter, uint64_t n = 1) {
+        block->values[static_cast<size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    // 设置仪表的当前值
+    static void set(TelemetryCounter counter, uint64_t value) {
+        block->values[static_cast<size_t>(counter)].store(value, std::memory_order_relaxed);
+    }
+
+    // 读取当前值
+    static uint64_t get(TelemetryCounter counter) {
+        return block->values[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+    }
+
+    // 计数器的名称（用于snake-top）
+    static const char* counterName(TelemetryCounter counter);
+
+    // 是否是仪表（当前值，不计算速率）
+    static bool isGauge(TelemetryCounter counter) {
+        return counter == TelemetryCounter::SNAKE_LENGTH || counter == TelemetryCounter::SCORE;
+    }
+
+    // 只读映射其他进程发布的遥测块，失败时返回nullptr；用detach解除映射
+    static const TelemetryBlock* attach(const std::string& name);
+    static void detach(const TelemetryBlock* attached);
+};
+
+#endif // TELEMETRY_H
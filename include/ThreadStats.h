@@ -0,0 +1,27 @@
+#ifndef THREAD_STATS_H
+#define THREAD_STATS_H
+
+#include <cstdint>
+#include <ostream>
+
+// 每个线程的CPU时间和上下文切换统计
+// 线程用nameThread设置名称（pthread_setname_np，在top -H和/proc中可见，同时用于跟踪文件）；
+// sample从/proc/self/task/*/stat和status读取所有线程的用户态/内核态时间和主动/被动上下文切换次数。
+// 线程结束后/proc中不再有它的记录，因此被统计的线程在退出前调用sampleCurrentThread留下最后的值。
+// 主动上下文切换就是线程阻塞后被唤醒的次数，轮询等待的循环会表现为每秒唤醒次数高
+class ThreadStats {
+public:
+    // 设置当前线程的名称（最多15个字符，不要在主线程中调用，否则进程名也会改变）
+    static void nameThread(const char* name);
+
+    // 采样所有线程（主线程定期调用，采样之间出现的线程在下一次采样时加入）
+    static void sample();
+
+    // 采样当前线程（线程退出前调用）
+    static void sampleCurrentThread();
+
+    // 输出每个线程从第一次到最后一次采样之间的CPU时间、上下文切换和每秒唤醒次数
+    static void report(std::ostream& out);
+};
+
+#endif // THREAD_STATS_H
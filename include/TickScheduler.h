@@ -0,0 +1,68 @@
+#ifndef TICK_SCHEDULER_H
+#define TICK_SCHEDULER_H
+
+#include <cstdint>
+#include "Latency.h"
+
+// 错过截止时间后的处理方式
+enum class TickPolicy {
+    SKIP,      // 跳过错过的帧，下一帧对齐到原来的节拍上（游戏时间比真实时间慢，但不会连续快进）
+    CATCH_UP   // 立即连续执行错过的帧追上进度（最多maxCatchUp帧，落后更多时跳过其余的帧）
+};
+
+// 固定节拍的游戏帧调度器
+// 每一帧的截止时间是上一帧的截止时间加上周期，而不是上一帧结束的时间加上周期，
+// 因此帧内的工作量和等待锁的时间不会累积成漂移。等待使用clock_nanosleep的绝对时间（TIMER_ABSTIME），
+// 被信号打断后重新等待到同一时刻。周期可以随时改变（辣椒、速度曲线），新周期从上一帧的截止时间算起，保持相位
+class TickScheduler {
+private:
+    TickPolicy policy;
+    int maxCatchUp;
+
+    // 当前周期和下一帧的截止时间（CLOCK_MONOTONIC纳秒）
+    int64_t period;
+    int64_t deadline;
+
+    // 连续追赶的帧数
+    int catchUpRun;
+
+    // 统计：执行的帧数、错过的截止时间和跳过的帧数，以及每帧开始时相对截止时间的延迟
+    uint64_t tickCount;
+    uint64_t missedDeadlines;
+    uint64_t skippedTicks;
+    LatencyHistogram lateness;
+
+public:
+    // 构造函数
+    explicit TickScheduler(TickPolicy policy = TickPolicy::SKIP, int maxCatchUp = 4);
+
+    // 从now开始按指定周期调度，第一帧在一个周期之后（开局和暂停后继续时调用，不追赶暂停的时间）
+    void start(int64_t now, int64_t periodNanos);
+
+    // 改变周期（在beginTick和advance之间调用），下一帧的截止时间为本帧的截止时间加上新周期
+    void setPeriod(int64_t periodNanos);
+
+    // 当前周期（两帧截止时间的间隔）
+    int64_t getPeriod() const { return period; }
+
+    // 下一帧的截止时间
+    int64_t getDeadline() const { return deadline; }
+
+    // 等待到下一帧的截止时间（已经过了时立即返回）
+    void sleepUntilDeadline() const;
+
+    // 一帧开始执行时调用，记录相对截止时间的延迟
+    void beginTick(int64_t now);
+
+    // 一帧执行完后调用，计算下一帧的截止时间并按策略处理错过的截止时间
+    void advance(int64_t now);
+
+    // 统计
+    TickPolicy getPolicy() const { return policy; }
+    uint64_t getTickCount() const { return tickCount; }
+    uint64_t getMissedDeadlines() const { return missedDeadlines; }
+    uint64_t getSkippedTicks() const { return skippedTicks; }
+    const LatencyHistogram& getLateness() const { return lateness; }
+};
+
+#endif // TICK_SCHEDULER_H
@@ -0,0 +1,81 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "Latency.h"
+
+// 一个已结束的区间（名称必须是字符串常量）
+struct TraceEvent {
+    const char* name;
+    int64_t start;     // 开始时间（CLOCK_MONOTONIC纳秒）
+    int64_t duration;  // 持续时间（纳秒）
+};
+
+// 线程活动跟踪：每个线程把区间写入自己的环形缓冲区（单写者，无锁），
+// 需要时把所有线程最近的区间写成Chrome/Perfetto的trace-event JSON文件，在chrome://tracing或ui.perfetto.dev中查看。
+// 未开始跟踪时区间只检查一个原子标志；编译时定义NO_TRACE（make TRACE=0）则完全不产生代码
+class Trace {
+private:
+    static std::atomic<bool> enabled;
+    static std::atomic<bool> flushRequested;
+
+public:
+    // 每个线程保留的区间数（环形缓冲区满后覆盖最早的区间）
+    static const size_t EVENTS_PER_THREAD = 8192;
+
+    // 开始记录区间
+    static void start();
+
+    // 是否正在记录
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // 设置当前线程在跟踪中显示的名称（字符串常量，由ThreadStats::nameThread调用）
+    static void setThreadName(const char* name);
+
+    // 记录当前线程的一个区间（未开始跟踪时忽略）
+    static void record(const char* name, int64_t start, int64_t end);
+
+    // 把各线程缓冲区中的区间写成trace-event JSON文件（可以在记录的同时调用），
+    // since不为0时只写出在该时间之后结束的区间
+    static bool writeFile(const std::string& path, int64_t since = 0);
+
+    // 请求写出跟踪文件（可以在信号处理函数中调用），由主线程取走请求后写文件
+    static void requestFlush() { flushRequested.store(true, std::memory_order_relaxed); }
+    static bool takeFlushRequest() { return flushRequested.exchange(false, std::memory_order_relaxed); }
+};
+
+// 作用域区间：构造时记下开始时间，析构时记录
+class TraceSpan {
+private:
+    const char* name;
+    int64_t start;
+
+public:
+    explicit TraceSpan(const char* name) : name(name), start(Trace::isEnabled() ? monotonicNanos() : 0) {}
+    ~TraceSpan() {
+        if (start != 0) {
+            Trace::record(name, start, monotonicNanos());
+        }
+    }
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef NO_TRACE
+
+#define TRACE_SPAN(name)
+#define TRACE_COMPLETE(name, start, end)
+
+#else
+
+// 记录从这里到作用域结束的区间
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+// 记录已经测量好的区间（例如等锁的时间）
+#define TRACE_COMPLETE(name, start, end) Trace::record(name, start, end)
+
+#endif // NO_TRACE
+
+#endif // TRACE_H
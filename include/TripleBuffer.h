@@ -0,0 +1,49 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// 无锁三缓冲：一个生产者写、一个消费者读，双方都不会等待对方
+// 生产者总是写自己独占的缓冲区，发布时与中间缓冲区交换；
+// 消费者取数据时再与中间缓冲区交换，因此总能拿到最近一次发布的完整数据
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1), writeIndex(0), readIndex(2) {}
+
+    // 生产者：获取可写的缓冲区
+    T& getWriteBuffer() { return buffers[writeIndex]; }
+
+    // 生产者：发布写好的缓冲区
+    void publish() {
+        unsigned previous = middle.exchange(writeIndex | FRESH_BIT, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // 消费者：切换到最近一次发布的缓冲区，返回是否有新数据
+    bool fetch() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH_BIT)) {
+            return false;
+        }
+        unsigned previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    // 消费者：获取当前读取的缓冲区
+    const T& getReadBuffer() const { return buffers[readIndex]; }
+
+private:
+    static const unsigned INDEX_MASK = 3;
+    static const unsigned FRESH_BIT = 4;
+
+    T buffers[3];
+    // 中间缓冲区的下标，FRESH_BIT表示生产者发布后消费者尚未取走
+    std::atomic<unsigned> middle;
+    // 只由生产者访问
+    unsigned writeIndex;
+    // 只由消费者访问
+    unsigned readIndex;
+};
+
+#endif // TRIPLE_BUFFER_H
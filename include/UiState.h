@@ -0,0 +1,78 @@
+#ifndef UI_STATE_H
+#define UI_STATE_H
+
+#include <atomic>
+#include <cstdint>
+
+// 界面状态
+enum class UiState {
+    RUNNING,        // 游戏进行中
+    PAUSED,         // 暂停
+    GAME_OVER,      // 显示游戏结束画面
+    RESTART_PROMPT  // 游戏结束画面上叠加了重新开始的提示，等待玩家操作
+};
+
+// 游戏结束之后的处理方式
+enum class GameOverPolicy {
+    PROMPT,        // 结束画面显示一段时间后提示玩家，玩家触摸屏幕或按键开始新的一局
+    AUTO_RESTART,  // 结束画面显示一段时间后自动开始下一局（自动驾驶、哈密顿回路和MCTS玩家）
+    EXIT           // 结束画面显示一段时间后退出（回放结束）
+};
+
+// 状态机要求调用者执行的动作
+enum class UiAction {
+    NONE,
+    SHOW_RESTART_PROMPT,  // 显示重新开始的提示
+    RESTART,              // 开始新的一局
+    EXIT                  // 退出游戏
+};
+
+// 界面状态机
+// 状态的转换和超时都是事件：游戏结束时设置截止时间，由调用者在截止时间（timerfd或条件变量的超时）
+// 调用onTimeout，玩家的操作调用onTap。状态机本身不等待、不休眠，也不持有游戏锁；
+// 除getState外的方法由调用者串行调用（Game中持有uiMutex），getState可在渲染线程中无锁读取
+class UiStateMachine {
+private:
+    std::atomic<UiState> state;
+    GameOverPolicy policy;
+
+    // 最近一次游戏结束的时间和下一次超时的截止时间（CLOCK_MONOTONIC纳秒，0表示没有）
+    int64_t gameOverTime;
+    int64_t deadline;
+
+public:
+    // 游戏结束画面在提示、自动开始下一局或退出之前显示的时间（毫秒）
+    static const int GAME_OVER_SCREEN_MS = 3000;
+
+    // 游戏结束至少这么久之后玩家的操作才会开始新的一局，避免结束前最后一次滑动的剩余事件立即重新开始
+    static const int RESTART_GUARD_MS = 500;
+
+    // 构造函数
+    explicit UiStateMachine(GameOverPolicy policy = GameOverPolicy::PROMPT);
+
+    // 当前状态
+    UiState getState() const { return state.load(std::memory_order_acquire); }
+
+    // 游戏结束之后的处理方式
+    GameOverPolicy getPolicy() const { return policy; }
+
+    // 下一次超时的截止时间，0表示没有等待中的超时
+    int64_t getDeadline() const { return deadline; }
+
+    // 游戏开始、继续或开始新的一局
+    void onRunning();
+
+    // 游戏暂停（重置时也先暂停）
+    void onPaused();
+
+    // 游戏在now结束，设置结束画面的超时
+    void onGameOver(int64_t now);
+
+    // 玩家在now触摸屏幕或按键
+    UiAction onTap(int64_t now);
+
+    // 截止时间到达（now早于截止时间时不做任何事）
+    UiAction onTimeout(int64_t now);
+};
+
+#endif // UI_STATE_H
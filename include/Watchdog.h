@@ -0,0 +1,88 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <string>
+#include <ostream>
+#include "Latency.h"
+
+// 受监视的周期性活动
+enum class WatchdogChannel {
+    TICK,   // 游戏帧（目标间隔为游戏速度）
+    FRAME,  // 渲染帧（目标间隔为帧率）
+    COUNT
+};
+
+// 节拍抖动和卡顿监视
+// 被监视的线程每个周期调用beat，记录实际间隔与目标间隔之差（抖动）和超过阈值的卡顿；
+// 监视线程定期检查距离上一次beat的时间，发现正在卡顿的线程时输出日志，并把最近几秒的线程活动
+// 写成跟踪文件（见Trace），从而能在卡顿仍在持续时看到其他线程在做什么
+class Watchdog {
+private:
+    struct Channel {
+        // 上一次beat的时间（0表示未启用，例如暂停时）和到下一次beat的目标间隔
+        std::atomic<int64_t> lastBeat;
+        std::atomic<int64_t> target;
+        // 抖动：实际间隔与目标间隔之差的绝对值
+        LatencyHistogram jitter;
+        // 超过目标间隔加阈值的间隔数和最长的间隔
+        std::atomic<uint64_t> stalls;
+        std::atomic<int64_t> worstInterval;
+        // 监视线程已经报告过卡顿的那一次beat（只由监视线程访问）
+        int64_t reportedBeat;
+
+        Channel() : lastBeat(0), target(0), stalls(0), worstInterval(0), reportedBeat(0) {}
+    };
+
+    Channel channels[static_cast<int>(WatchdogChannel::COUNT)];
+    int64_t threshold;
+    std::string dumpPath;
+    int64_t lastDump;
+    uint64_t dumpCount;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable stopCondition;
+    bool stopping;
+
+    // 监视线程主循环
+    void monitorLoop();
+
+    // 报告卡顿并写出跟踪文件
+    void reportStall(WatchdogChannel channel, int64_t silentNanos, int64_t target);
+
+public:
+    // 跟踪文件中保留卡顿前多长时间的活动（纳秒）
+    static const int64_t CONTEXT_NANOS = 5000000000LL;
+
+    Watchdog();
+    ~Watchdog();
+
+    // 启动监视线程：间隔超过目标加上thresholdNanos视为卡顿，卡顿时写出dumpPath（同时开始记录跟踪区间）
+    void start(int64_t thresholdNanos, const std::string& dumpPath);
+
+    // 停止监视线程
+    void stop();
+
+    // 是否已启动
+    bool isRunning() const { return thread.joinable(); }
+
+    // 从now开始监视，下一次beat应在一个目标间隔之后（开始或暂停后继续时调用）
+    void arm(WatchdogChannel channel, int64_t now, int64_t targetNanos);
+
+    // 停止监视（暂停、游戏结束），不再把之后的间隔算作卡顿
+    void disarm(WatchdogChannel channel);
+
+    // 一个周期开始：按arm或上一次beat给出的目标检查距离上一次beat的间隔，nextTargetNanos为到下一次beat的目标间隔
+    // 未arm时只开始监视
+    void beat(WatchdogChannel channel, int64_t now, int64_t nextTargetNanos);
+
+    // 输出抖动和卡顿统计
+    void report(std::ostream& out) const;
+};
+
+#endif // WATCHDOG_H
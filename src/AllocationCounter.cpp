@@ -0,0 +1,97 @@
+#include "../include/AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+#ifdef COUNT_ALLOCATIONS
+
+namespace {
+    // 静态初始化为0的线程局部变量，在operator new中访问不会再分配内存
+    thread_local uint64_t threadAllocations = 0;
+}
+
+// 替换全局的分配函数，只增加计数，实际分配交给malloc
+void* operator new(std::size_t size) {
+    threadAllocations++;
+    void* memory = std::malloc(size != 0 ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    threadAllocations++;
+    return std::malloc(size != 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+bool AllocationCounter::isEnabled() {
+    return true;
+}
+
+uint64_t AllocationCounter::getThreadCount() {
+    return threadAllocations;
+}
+
+#else
+
+bool AllocationCounter::isEnabled() {
+    return false;
+}
+
+uint64_t AllocationCounter::getThreadCount() {
+    return 0;
+}
+
+#endif // COUNT_ALLOCATIONS
+
+// 构造函数
+AllocationCheck::AllocationCheck(const char* name, uint64_t warmup)
+    : name(name), warmup(warmup), runs(0), start(0), failedRuns(0), allocations(0), worst(0) {
+}
+
+// 一次执行结束
+void AllocationCheck::end() {
+    uint64_t count = AllocationCounter::getThreadCount() - start;
+    if (++runs <= warmup || count == 0) {
+        return;
+    }
+    failedRuns++;
+    allocations += count;
+    if (count > worst) {
+        worst = count;
+    }
+}
+
+// 输出检查结果
+void AllocationCheck::report(std::ostream& out) const {
+    if (!AllocationCounter::isEnabled() || runs <= warmup) {
+        return;
+    }
+    out << "Allocations: " << name << " " << (failedRuns == 0 ? "OK" : "FAILED") << ", " << failedRuns << " of "
+        << runs - warmup << " after the first " << warmup << " allocated (" << allocations << " allocations, at most "
+        << worst << " in one)" << std::endl;
+}
@@ -0,0 +1,415 @@
+#include "../include/Autopilot.h"
+#include <algorithm>
+
+namespace {
+    const Direction DIRECTIONS[4] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+
+    // 获取相反方向
+    Direction opposite(Direction direction) {
+        switch (direction) {
+            case Direction::UP: return Direction::DOWN;
+            case Direction::DOWN: return Direction::UP;
+            case Direction::LEFT: return Direction::RIGHT;
+            default: return Direction::LEFT;
+        }
+    }
+
+    // 食物的价值（增长的长度）
+    int foodValue(FoodType type) {
+        return type == FoodType::MEAT ? 2 : 1;
+    }
+}
+
+// 类内初始化的静态常量在按引用传递时需要定义
+const uint32_t Autopilot::NO_CHUNK;
+const size_t Autopilot::RESERVED_CHUNKS;
+const int Autopilot::SEARCH_LIMIT;
+const int Autopilot::FALLBACK_AREA;
+
+// 构造函数
+Autopilot::Autopilot()
+    : width(0), height(0), columnShift(0), chunkIndexData(nullptr), cellData(nullptr), wallMap(nullptr),
+      visitStamp(0), targetCell(-1), planCount(0), reuseCount(0) {
+}
+
+// 开始新的一局时清除规划的路径
+void Autopilot::reset() {
+    path.clear();
+    targetCell = -1;
+}
+
+// 获取相邻格子，越界时返回-1
+int Autopilot::neighbor(int cell, Direction direction) const {
+    int x = cellX(cell);
+    int y = cellY(cell);
+    switch (direction) {
+        case Direction::UP: y--; break;
+        case Direction::DOWN: y++; break;
+        case Direction::LEFT: x--; break;
+        case Direction::RIGHT: x++; break;
+    }
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        return -1;
+    }
+    return cellId(x, y);
+}
+
+// 按DIRECTIONS的顺序获取四个相邻格子，越界时为-1（BFS的内层循环只解码一次格子编号）
+void Autopilot::neighbors(int cell, int* result) const {
+    int x = cellX(cell);
+    int y = cellY(cell);
+    result[0] = y > 0 ? cellId(x, y - 1) : -1;
+    result[1] = y < height - 1 ? cellId(x, y + 1) : -1;
+    result[2] = x > 0 ? cellId(x - 1, y) : -1;
+    result[3] = x < width - 1 ? cellId(x + 1, y) : -1;
+}
+
+// 获取格子的状态，所在的块本帧还没有用到时先分配
+Autopilot::ScratchCell& Autopilot::at(int cell) {
+    int slot = cell >> (2 * CHUNK_SHIFT);
+    uint32_t chunk = chunkIndexData[slot];
+    if (chunk == NO_CHUNK) {
+        chunk = allocateChunk(slot, cellX(cell) & ~CHUNK_MASK, cellY(cell) & ~CHUNK_MASK);
+    }
+    return cellData[chunk * CHUNK_CELLS + (cell & (CHUNK_CELLS - 1))];
+}
+
+// 为块下标slot分配一个块
+uint32_t Autopilot::allocateChunk(int slot, int firstX, int firstY) {
+    uint32_t chunk = static_cast<uint32_t>(usedSlots.size());
+    size_t first = static_cast<size_t>(chunk) * CHUNK_CELLS;
+    if (chunkPool.size() < first + CHUNK_CELLS) {
+        chunkPool.resize(first + CHUNK_CELLS);
+        cellData = chunkPool.data();
+    }
+    ScratchCell empty = {0, 0, -1, 0};
+    std::fill(chunkPool.begin() + first, chunkPool.begin() + first + CHUNK_CELLS, empty);
+
+    // 关卡的墙永远不会空出（块在本帧第一次用到时才读取，不必每帧写入所有的墙）
+    if (wallMap) {
+        int lastX = std::min(firstX + CHUNK_SIZE, width);
+        int lastY = std::min(firstY + CHUNK_SIZE, height);
+        for (int y = firstY; y < lastY; y++) {
+            for (int x = firstX; x < lastX; x++) {
+                if (wallMap->getCell(x, y) == MapElementType::WALL) {
+                    chunkPool[first + (cellId(x, y) & (CHUNK_CELLS - 1))].freeAfter = BLOCKED;
+                }
+            }
+        }
+    }
+
+    chunkIndex[slot] = chunk;
+    usedSlots.push_back(slot);
+    return chunk;
+}
+
+// 确保BFS队列能容纳limit个格子（BFS在达到limit之前的最后一个格子还会加入最多4个相邻格子）
+void Autopilot::reserveQueue(int limit) {
+    size_t needed = static_cast<size_t>(std::min(static_cast<int64_t>(limit) + 4,
+                                                 static_cast<int64_t>(width) * height));
+    if (queue.size() < needed) {
+        queue.resize(needed);
+    }
+}
+
+// 回收上一帧的块，根据蛇、墙和炸弹重建占用表
+void Autopilot::buildOccupancy(const Simulation& sim) {
+    const Map& map = sim.getMap();
+    if (map.getWidth() != width || map.getHeight() != height) {
+        width = map.getWidth();
+        height = map.getHeight();
+        columnShift = 0;
+        while ((1 << columnShift) < ((width + CHUNK_MASK) >> CHUNK_SHIFT)) {
+            columnShift++;
+        }
+        int chunkRows = (height + CHUNK_MASK) >> CHUNK_SHIFT;
+        size_t chunks = static_cast<size_t>(chunkRows) << columnShift;
+        chunkIndex.assign(chunks, NO_CHUNK);
+        chunkIndexData = chunkIndex.data();
+        usedSlots.clear();
+        usedSlots.reserve(chunks);
+        chunkPool.reserve(std::min(chunks, RESERVED_CHUNKS) * CHUNK_CELLS);
+        cellData = chunkPool.data();
+        queue.clear();
+        reserveQueue(SEARCH_LIMIT);
+        visitStamp = 0;
+        path.clear();
+        path.reserve(std::min(static_cast<size_t>(width) * height, static_cast<size_t>(SEARCH_LIMIT)));
+        targetCell = -1;
+    } else {
+        // 只回收上一帧用到的块，其中的格子在下次分配时清空
+        for (uint32_t slot : usedSlots) {
+            chunkIndex[slot] = NO_CHUNK;
+        }
+        usedSlots.clear();
+    }
+    wallMap = sim.getLevel() ? &map : nullptr;
+
+    // 蛇身第i节在蛇尾再移动len-i次后空出，正在生长时多等一帧
+    const Snake& snake = sim.getSnake();
+    int length = static_cast<int>(snake.getLength());
+    int extra = snake.isGrowing() ? 1 : 0;
+    for (int i = 0; i < length; i++) {
+        std::pair<int, int> segment = snake.getSegment(i);
+        int x = segment.first;
+        int y = segment.second;
+        if (x < 0 || x >= width || y < 0 || y >= height) {
+            continue;
+        }
+        uint16_t ticks = static_cast<uint16_t>(std::min(length - i + extra, static_cast<int>(BLOCKED) - 1));
+        uint16_t& cell = at(cellId(x, y)).freeAfter;
+        cell = std::max(cell, ticks);
+    }
+
+    // 对手蛇的蛇身同样按空出的时间计算；对手蛇头旁边的格子下一帧可能被占用，第一步不进入
+    for (const auto& rival : sim.getRivals()) {
+        if (!rival.isAlive()) {
+            continue;
+        }
+        int rivalLength = static_cast<int>(rival.getLength());
+        int rivalExtra = rival.isGrowing() ? 1 : 0;
+        for (int i = 0; i < rivalLength; i++) {
+            std::pair<int, int> segment = rival.getSegment(i);
+            uint16_t ticks = static_cast<uint16_t>(std::min(rivalLength - i + rivalExtra, static_cast<int>(BLOCKED) - 1));
+            uint16_t& cell = at(cellId(segment.first, segment.second)).freeAfter;
+            cell = std::max(cell, ticks);
+        }
+        std::pair<int, int> rivalHead = rival.getHead();
+        for (Direction direction : DIRECTIONS) {
+            int next = neighbor(cellId(rivalHead.first, rivalHead.second), direction);
+            if (next >= 0) {
+                uint16_t& cell = at(next).freeAfter;
+                cell = std::max<uint16_t>(cell, 2);
+            }
+        }
+    }
+
+    // 炸弹会使蛇缩短，始终绕开
+    for (const auto& foodWithLifetime : sim.getFoods()) {
+        const Food& food = foodWithLifetime.food;
+        if (food.getType() == FoodType::BOMB) {
+            at(cellId(food.getX(), food.getY())).freeAfter = BLOCKED;
+        }
+    }
+}
+
+// 开始新一轮搜索（使visited全部失效）
+void Autopilot::nextStamp() {
+    visitStamp++;
+    if (visitStamp == 0) {
+        // 计数回绕时清空本帧的块，避免与很久以前的标记混淆（其他块在分配时清空）
+        for (size_t i = 0; i < usedSlots.size() * CHUNK_CELLS; i++) {
+            chunkPool[i].visited = 0;
+        }
+        visitStamp = 1;
+    }
+}
+
+// 从起点开始按到达时间做BFS
+void Autopilot::search(int start, int excluded, int maxArrival) {
+    nextStamp();
+    int head = 0;
+    int tail = 0;
+    ScratchCell& first = at(start);
+    first.visited = visitStamp;
+    first.dist = 0;
+    first.parent = -1;
+    queue[tail++] = start;
+
+    while (head < tail && tail < SEARCH_LIMIT) {
+        int cell = queue[head++];
+        int arrival = at(cell).dist + 1;
+        if (arrival > maxArrival) {
+            break;
+        }
+        int adjacent[4];
+        neighbors(cell, adjacent);
+        for (int next : adjacent) {
+            // 第一步不能掉头
+            if (next < 0 || (cell == start && next == excluded)) {
+                continue;
+            }
+            // 到达时该格子必须已经空出
+            ScratchCell& state = at(next);
+            if (state.visited == visitStamp || state.freeAfter > arrival) {
+                continue;
+            }
+            state.visited = visitStamp;
+            state.dist = arrival;
+            state.parent = cell;
+            queue[tail++] = next;
+        }
+    }
+}
+
+// 从起点可以到达的格子数（起点在第1帧进入），达到limit时提前返回
+int Autopilot::reachableArea(int start, int limit) {
+    reserveQueue(limit);
+    nextStamp();
+    int head = 0;
+    int tail = 0;
+    ScratchCell& first = at(start);
+    first.visited = visitStamp;
+    first.dist = 1;
+    queue[tail++] = start;
+
+    while (head < tail && tail < limit) {
+        int cell = queue[head++];
+        int arrival = at(cell).dist + 1;
+        int adjacent[4];
+        neighbors(cell, adjacent);
+        for (int next : adjacent) {
+            if (next < 0) {
+                continue;
+            }
+            ScratchCell& state = at(next);
+            if (state.visited == visitStamp || state.freeAfter > arrival) {
+                continue;
+            }
+            state.visited = visitStamp;
+            state.dist = arrival;
+            queue[tail++] = next;
+        }
+    }
+    return tail;
+}
+
+// 进入指定格子后是否还能活动
+bool Autopilot::isSafe(int cell, int length) {
+    return reachableArea(cell, length) >= length;
+}
+
+// 重新选择目标并规划路径
+bool Autopilot::plan(const Simulation& sim, int head, int excluded) {
+    planCount++;
+    path.clear();
+    targetCell = -1;
+
+    // 所有食物都过期之后才能到达的格子不必搜索（满足arrivalMs < expirationTime的最大到达时间）
+    int maxArrival = 0;
+    for (const auto& foodWithLifetime : sim.getFoods()) {
+        int64_t remainingMs = foodWithLifetime.expirationTime - sim.getTimeMs();
+        if (foodWithLifetime.food.getType() != FoodType::BOMB && remainingMs > 0) {
+            int64_t ticks = (remainingMs - 1) / sim.getGameSpeed();
+            maxArrival = std::max(maxArrival, static_cast<int>(std::min<int64_t>(ticks, SEARCH_LIMIT)));
+        }
+    }
+    search(head, excluded, maxArrival);
+
+    // 选择价值/距离最高的食物，跳过到达前就会过期的食物
+    int bestCell = -1;
+    int bestValue = 0;
+    int bestDist = 1;
+    for (const auto& foodWithLifetime : sim.getFoods()) {
+        const Food& food = foodWithLifetime.food;
+        if (food.getType() == FoodType::BOMB) {
+            continue;
+        }
+        int cell = cellId(food.getX(), food.getY());
+        const ScratchCell& state = at(cell);
+        if (state.visited != visitStamp || cell == head) {
+            continue;
+        }
+        int64_t arrivalMs = sim.getTimeMs() + static_cast<int64_t>(state.dist) * sim.getGameSpeed();
+        if (arrivalMs >= foodWithLifetime.expirationTime) {
+            continue;
+        }
+        int value = foodValue(food.getType());
+        if (bestCell < 0 || value * bestDist > bestValue * state.dist) {
+            bestCell = cell;
+            bestValue = value;
+            bestDist = state.dist;
+        }
+    }
+
+    if (bestCell < 0) {
+        return false;
+    }
+
+    for (int cell = bestCell; cell != head; cell = at(cell).parent) {
+        path.push_back(cell);
+    }
+    targetCell = bestCell;
+    return true;
+}
+
+// 为下一帧选择方向
+Direction Autopilot::chooseDirection(const Simulation& sim) {
+    const Snake& snake = sim.getSnake();
+    Direction current = snake.getDirection();
+
+    buildOccupancy(sim);
+
+    std::pair<int, int> headPos = snake.getHead();
+    if (headPos.first < 0 || headPos.first >= width || headPos.second < 0 || headPos.second >= height) {
+        return current;
+    }
+    int head = cellId(headPos.first, headPos.second);
+    int excluded = neighbor(head, opposite(current));
+    int length = static_cast<int>(snake.getLength());
+
+    // 目标仍然存在且下一步仍然可走时沿用上一帧的路径
+    bool reuse = false;
+    if (!path.empty() && targetCell >= 0) {
+        int next = path.back();
+        bool adjacent = false;
+        for (Direction direction : DIRECTIONS) {
+            if (neighbor(head, direction) == next) {
+                adjacent = true;
+                break;
+            }
+        }
+        bool targetPresent = false;
+        for (const auto& foodWithLifetime : sim.getFoods()) {
+            const Food& food = foodWithLifetime.food;
+            if (cellId(food.getX(), food.getY()) == targetCell && food.getType() != FoodType::BOMB) {
+                targetPresent = true;
+                break;
+            }
+        }
+        reuse = adjacent && targetPresent && next != excluded && at(next).freeAfter <= 1;
+    }
+
+    if (reuse) {
+        reuseCount++;
+    } else {
+        plan(sim, head, excluded);
+    }
+
+    // 沿路径前进，但不能走进进去就出不来的区域
+    if (!path.empty()) {
+        int next = path.back();
+        if (isSafe(next, length)) {
+            path.pop_back();
+            for (Direction direction : DIRECTIONS) {
+                if (neighbor(head, direction) == next) {
+                    return direction;
+                }
+            }
+        }
+        path.clear();
+        targetCell = -1;
+    }
+
+    // 没有安全的路径时选择活动空间最大的方向，相同时保持当前方向
+    // （活动空间最多数到蛇长的两倍，不少于FALLBACK_AREA个格子；超过它的方向都足够宽敞，不再比较）
+    int areaLimit = std::max(2 * length, FALLBACK_AREA);
+    Direction best = current;
+    int bestArea = -1;
+    for (int i = -1; i < 4; i++) {
+        Direction direction = i < 0 ? current : DIRECTIONS[i];
+        if (i >= 0 && direction == current) {
+            continue;
+        }
+        int next = neighbor(head, direction);
+        if (next < 0 || next == excluded || at(next).freeAfter > 1) {
+            continue;
+        }
+        int area = reachableArea(next, areaLimit);
+        if (area > bestArea) {
+            best = direction;
+            bestArea = area;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,311 @@
+#include "../include/BatchRunner.h"
+#include "../include/Autopilot.h"
+#include "../include/HamiltonianPlayer.h"
+#include "../include/Latency.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+    // 一局的结果
+    struct GameResult {
+        uint32_t seed;
+        uint32_t score;
+        uint32_t length;
+        uint64_t ticks;
+        int64_t timeMs;
+        bool survived;  // 达到帧数上限时仍然存活
+    };
+
+    // 每个工作线程的任务区间[begin, end)，打包在一个原子变量中：
+    // 所有者从前端逐个取，其他线程从后端窃取一半
+    struct WorkQueue {
+        std::atomic<uint64_t> range;
+        char padding[64 - sizeof(std::atomic<uint64_t>)];  // 避免与相邻线程的队列共享缓存行
+
+        WorkQueue() : range(0) {}
+    };
+
+    uint64_t packRange(uint32_t begin, uint32_t end) {
+        return (static_cast<uint64_t>(end) << 32) | begin;
+    }
+
+    // 从自己的队列前端取一局
+    bool popLocal(WorkQueue& queue, uint32_t& index) {
+        uint64_t range = queue.range.load(std::memory_order_acquire);
+        while (true) {
+            uint32_t begin = static_cast<uint32_t>(range);
+            uint32_t end = static_cast<uint32_t>(range >> 32);
+            if (begin >= end) {
+                return false;
+            }
+            if (queue.range.compare_exchange_weak(range, packRange(begin + 1, end), std::memory_order_acq_rel)) {
+                index = begin;
+                return true;
+            }
+        }
+    }
+
+    // 从其他线程的队列后端窃取一半，返回其中第一局，其余放入自己的队列
+    bool steal(WorkQueue& victim, WorkQueue& own, uint32_t& index) {
+        uint64_t range = victim.range.load(std::memory_order_acquire);
+        while (true) {
+            uint32_t begin = static_cast<uint32_t>(range);
+            uint32_t end = static_cast<uint32_t>(range >> 32);
+            if (begin >= end) {
+                return false;
+            }
+            uint32_t middle = begin + (end - begin) / 2;
+            if (victim.range.compare_exchange_weak(range, packRange(begin, middle), std::memory_order_acq_rel)) {
+                index = middle;
+                own.range.store(packRange(middle + 1, end), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    // 由基础种子和局号导出该局的种子（splitmix64），相邻局号得到不相关的随机数流
+    uint32_t gameSeed(uint64_t baseSeed, uint64_t index) {
+        uint64_t z = baseSeed + (index + 1) * 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        return static_cast<uint32_t>(z >> 32);
+    }
+
+    // 每个工作线程的统计
+    struct WorkerStats {
+        uint64_t games;
+        uint64_t steals;
+
+        WorkerStats() : games(0), steals(0) {}
+    };
+
+    // 输出一项统计：平均值、标准差和分位数
+    void reportStat(const char* name, std::vector<double>& values) {
+        if (values.empty()) {
+            return;
+        }
+        double sum = 0;
+        for (double value : values) {
+            sum += value;
+        }
+        double mean = sum / values.size();
+        double variance = 0;
+        for (double value : values) {
+            variance += (value - mean) * (value - mean);
+        }
+        double stddev = std::sqrt(variance / values.size());
+
+        std::sort(values.begin(), values.end());
+        size_t n = values.size();
+        std::cout << "  " << name << ": mean " << mean << ", stddev " << stddev << ", min " << values[0]
+                  << ", p10 " << values[n / 10] << ", p50 " << values[n / 2] << ", p90 " << values[n * 9 / 10]
+                  << ", max " << values[n - 1] << std::endl;
+    }
+
+    // 输出规则，便于记录每次调整的参数
+    void reportRules(const SimulationRules& rules) {
+        std::cout << "Rules: initial-speed=" << rules.initialSpeed << " speed-base=" << rules.speedBase
+                  << " speed-step=" << rules.speedStep << " speed-min=" << rules.minSpeed
+                  << " pepper-ms=" << rules.pepperDurationMs << " max-foods=" << rules.maxFoods
+                  << " food-lifetime=" << rules.foodLifetime << " food-weights=" << rules.foodWeights[0] << ","
+                  << rules.foodWeights[1] << "," << rules.foodWeights[2] << "," << rules.foodWeights[3]
+                  << " rivals=" << rules.rivalSnakes << std::endl;
+    }
+}
+
+// 解析一条规则设置
+bool parseSimulationRule(const std::string& setting, SimulationRules& rules) {
+    size_t equals = setting.find('=');
+    if (equals == std::string::npos) {
+        return false;
+    }
+    std::string name = setting.substr(0, equals);
+    std::string value = setting.substr(equals + 1);
+
+    if (name == "food-weights") {
+        int weights[4];
+        char separator;
+        std::istringstream in(value);
+        if (!(in >> weights[0] >> separator >> weights[1] >> separator >> weights[2] >> separator >> weights[3])) {
+            return false;
+        }
+        for (int i = 0; i < 4; i++) {
+            if (weights[i] < 0) {
+                return false;
+            }
+            rules.foodWeights[i] = weights[i];
+        }
+        return weights[0] + weights[1] + weights[2] + weights[3] > 0;
+    }
+
+    char* end = nullptr;
+    long number = std::strtol(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || number <= 0) {
+        return false;
+    }
+
+    if (name == "initial-speed") {
+        rules.initialSpeed = static_cast<int>(number);
+    } else if (name == "speed-base") {
+        rules.speedBase = static_cast<int>(number);
+    } else if (name == "speed-step") {
+        rules.speedStep = static_cast<int>(number);
+    } else if (name == "speed-min") {
+        rules.minSpeed = static_cast<int>(number);
+    } else if (name == "pepper-ms") {
+        rules.pepperDurationMs = static_cast<int>(number);
+    } else if (name == "max-foods") {
+        rules.maxFoods = static_cast<size_t>(number);
+    } else if (name == "food-lifetime") {
+        rules.foodLifetime = static_cast<unsigned int>(number);
+    } else if (name == "rivals") {
+        rules.rivalSnakes = static_cast<size_t>(number);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 批量无头模拟
+int runBatch(const BatchOptions& options) {
+    if (options.games <= 0) {
+        std::cerr << "Batch needs at least one game" << std::endl;
+        return 1;
+    }
+    if (options.player == PlayerKind::SOLVER &&
+        !HamiltonianPlayer::cycleExists(options.mapWidth, options.mapHeight)) {
+        std::cerr << "No Hamiltonian cycle exists for a " << options.mapWidth << "x" << options.mapHeight
+                  << " board" << std::endl;
+        return 1;
+    }
+
+    int threadCount = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+    threadCount = std::max(1, std::min(threadCount, options.games));
+
+    std::cout << "Batch: " << options.games << " games on " << options.mapWidth << "x" << options.mapHeight
+              << " with " << (options.player == PlayerKind::SOLVER ? "Hamiltonian solver" : "autopilot")
+              << ", " << threadCount << " threads, seed " << options.seed << std::endl;
+    reportRules(options.rules);
+
+    // 结果按局号存放，每局只由一个线程写入，汇总结果与线程数和调度顺序无关
+    std::vector<GameResult> results(options.games);
+    std::vector<WorkQueue> queues(threadCount);
+    std::vector<WorkerStats> stats(threadCount);
+
+    // 开始时平均分配，之后空闲的线程从其他线程窃取
+    for (int i = 0; i < threadCount; i++) {
+        uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(options.games) * i / threadCount);
+        uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(options.games) * (i + 1) / threadCount);
+        queues[i].range.store(packRange(begin, end));
+    }
+
+    auto worker = [&](int self) {
+        // 每个线程有自己的模拟和玩家，只在开始时分配内存
+        Simulation sim(options.mapWidth, options.mapHeight, options.rules);
+        sim.setLevel(options.level);
+        Autopilot autopilot;
+        HamiltonianPlayer solver;
+        WorkerStats& mine = stats[self];
+
+        uint32_t index;
+        while (true) {
+            if (!popLocal(queues[self], index)) {
+                bool stolen = false;
+                for (int k = 1; k < threadCount && !stolen; k++) {
+                    stolen = steal(queues[(self + k) % threadCount], queues[self], index);
+                }
+                if (!stolen) {
+                    break;
+                }
+                mine.steals++;
+            }
+
+            GameResult& result = results[index];
+            result.seed = gameSeed(options.seed, index);
+            sim.reset(result.seed);
+            autopilot.reset();
+            while (!sim.isGameOver() && sim.getTick() < options.maxTicks) {
+                Direction direction = (options.player == PlayerKind::SOLVER) ? solver.chooseDirection(sim)
+                                                                             : autopilot.chooseDirection(sim);
+                sim.turn(direction);
+                sim.step();
+            }
+            result.score = sim.getScore();
+            result.length = static_cast<uint32_t>(sim.getSnake().getLength());
+            result.ticks = sim.getTick();
+            result.timeMs = sim.getTimeMs();
+            result.survived = !sim.isGameOver();
+            mine.games++;
+        }
+    };
+
+    int64_t startTime = monotonicNanos();
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadCount; i++) {
+        threads.push_back(std::thread(worker, i));
+    }
+    worker(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double seconds = (monotonicNanos() - startTime) / 1e9;
+
+    // 汇总
+    std::vector<double> scores, lengths, ticks, survivalSeconds;
+    uint64_t totalTicks = 0;
+    int survived = 0;
+    for (const auto& result : results) {
+        scores.push_back(result.score);
+        lengths.push_back(result.length);
+        ticks.push_back(static_cast<double>(result.ticks));
+        survivalSeconds.push_back(result.timeMs / 1000.0);
+        totalTicks += result.ticks;
+        if (result.survived) {
+            survived++;
+        }
+    }
+
+    std::cout << "Played " << options.games << " games (" << totalTicks << " ticks) in " << seconds << " s";
+    if (seconds > 0) {
+        std::cout << ": " << static_cast<uint64_t>(options.games / seconds) << " games/s, "
+                  << static_cast<uint64_t>(totalTicks / seconds) << " ticks/s";
+    }
+    std::cout << std::endl;
+    std::cout << "Per thread games/steals:";
+    for (const auto& s : stats) {
+        std::cout << " " << s.games << "/" << s.steals;
+    }
+    std::cout << std::endl;
+
+    std::cout << "Results:" << std::endl;
+    reportStat("score", scores);
+    reportStat("length", lengths);
+    reportStat("survival ticks", ticks);
+    reportStat("survival game seconds", survivalSeconds);
+    std::cout << "  reached tick limit " << survived << " of " << options.games << " ("
+              << survived * 100.0 / options.games << "%)" << std::endl;
+
+    if (!options.outputPath.empty()) {
+        std::ofstream out(options.outputPath.c_str());
+        if (!out) {
+            std::cerr << "Failed to write batch results: " << options.outputPath << std::endl;
+            return 1;
+        }
+        out << "game,seed,score,length,ticks,time_ms,survived\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const GameResult& r = results[i];
+            out << i << "," << r.seed << "," << r.score << "," << r.length << "," << r.ticks << ","
+                << r.timeMs << "," << (r.survived ? 1 : 0) << "\n";
+        }
+        std::cout << "Per-game results written to " << options.outputPath << std::endl;
+    }
+    return 0;
+}
@@ -5,6 +5,19 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <cmath>
+#include <vector>
+
+namespace {
+    // 读取像素数据的缓冲区，每个线程一个，只增不减，绘制精灵时不再每次申请内存
+    thread_local std::vector<unsigned char> pixelScratch;
+
+    unsigned char* pixel_buffer(int size) {
+        if (pixelScratch.size() < static_cast<size_t>(size)) {
+            pixelScratch.resize(size);
+        }
+        return pixelScratch.data();
+    }
+}
 
 // 在指定位置绘制点
 void lcd_draw_point(const char *fbp, struct fb_var_screeninfo *scrinfo, int x, int y, unsigned int color) {
@@ -65,19 +78,19 @@ void lcd_draw_bmp(const char *fbp, struct fb_var_screeninfo *scrinfo, int x0, in
     int full_bytes = (4 - (w * depth / 8) % 4) % 4; // (4-多出字节数)%4
     int color_buf_size = (w * depth / 8 + full_bytes) * abs(h); // 所有像素点颜色值大小+所有填充字节数
     
-    // 分配内存
-    unsigned char *color_buf = (unsigned char*)malloc(color_buf_size);
-    if (!color_buf) {
+    if (color_buf_size <= 0) {
         close(fd_pic);
         return;
     }
     
+    // 使用线程的读取缓冲区
+    unsigned char *color_buf = pixel_buffer(color_buf_size);
+    
     // 读取像素数据
     lseek(fd_pic, offset, SEEK_SET);
     ssize_t bytes_read = read(fd_pic, color_buf, color_buf_size);
     if (bytes_read != color_buf_size) {
         printf("Failed to read complete BMP data\n");
-        free(color_buf);
         close(fd_pic);
         return;
     }
@@ -123,8 +136,7 @@ void lcd_draw_bmp(const char *fbp, struct fb_var_screeninfo *scrinfo, int x0, in
         p += full_bytes;
     }
     
-    // 释放内存并关闭文件
-    free(color_buf);
+    // 关闭文件
     close(fd_pic);
 }
 
@@ -167,19 +179,19 @@ void lcd_draw_bmp_transparent(const char *fbp, struct fb_var_screeninfo *scrinfo
     int full_bytes = (4 - (w * depth / 8) % 4) % 4; // (4-多出字节数)%4
     int color_buf_size = (w * depth / 8 + full_bytes) * abs(h); // 所有像素点颜色值大小+所有填充字节数
     
-    // 分配内存
-    unsigned char *color_buf = (unsigned char*)malloc(color_buf_size);
-    if (!color_buf) {
+    if (color_buf_size <= 0) {
         close(fd_pic);
         return;
     }
     
+    // 使用线程的读取缓冲区
+    unsigned char *color_buf = pixel_buffer(color_buf_size);
+    
     // 读取像素数据
     lseek(fd_pic, offset, SEEK_SET);
     ssize_t bytes_read = read(fd_pic, color_buf, color_buf_size);
     if (bytes_read != color_buf_size) {
         printf("Failed to read complete BMP data\n");
-        free(color_buf);
         close(fd_pic);
         return;
     }
@@ -230,11 +242,64 @@ void lcd_draw_bmp_transparent(const char *fbp, struct fb_var_screeninfo *scrinfo
         p += full_bytes;
     }
     
-    // 释放内存并关闭文件
-    free(color_buf);
+    // 关闭文件
     close(fd_pic);
 }
 
+// 把BMP图片解码为ARGB像素
+bool bmp_decode(const char *path_name, int *width, int *height, std::vector<unsigned int>& pixels) {
+    if (!path_name || !width || !height) return false;
+    
+    FILE *fp = fopen(path_name, "rb");
+    if (!fp) {
+        return false;
+    }
+    
+    // 读取文件头和信息头
+    BITMAPFILEHEADER fileHeader;
+    BITMAPINFOHEADER infoHeader;
+    if (fread(&fileHeader, sizeof(fileHeader), 1, fp) != 1 || fread(&infoHeader, sizeof(infoHeader), 1, fp) != 1 ||
+        fileHeader.bfType != 0x4D42 || (infoHeader.biBitCount != 24 && infoHeader.biBitCount != 32)) {
+        fclose(fp);
+        return false;
+    }
+    
+    int w = infoHeader.biWidth;
+    int h = abs(infoHeader.biHeight);
+    int bytes_per_pixel = infoHeader.biBitCount / 8;
+    int row_bytes = (w * bytes_per_pixel + 3) & ~3; // 每行按4字节对齐
+    if (w <= 0 || h <= 0) {
+        fclose(fp);
+        return false;
+    }
+    
+    std::vector<unsigned char> row(row_bytes);
+    pixels.resize(static_cast<size_t>(w) * h);
+    fseek(fp, fileHeader.bfOffBits, SEEK_SET);
+    for (int y = 0; y < h; y++) {
+        if (fread(row.data(), 1, row_bytes, fp) != static_cast<size_t>(row_bytes)) {
+            fclose(fp);
+            return false;
+        }
+        // 高度为正数时文件中的行从下到上存放
+        int target_row = infoHeader.biHeight > 0 ? h - 1 - y : y;
+        unsigned int *out = &pixels[static_cast<size_t>(target_row) * w];
+        const unsigned char *p = row.data();
+        for (int x = 0; x < w; x++) {
+            unsigned char b = *p++;
+            unsigned char g = *p++;
+            unsigned char r = *p++;
+            unsigned char a = bytes_per_pixel == 4 ? *p++ : 0xFF;
+            out[x] = (a << 24) | (r << 16) | (g << 8) | b;
+        }
+    }
+    
+    fclose(fp);
+    *width = w;
+    *height = h;
+    return true;
+}
+
 // 为保持兼容性，保留bmp_display函数接口，但内部实现改为调用lcd_draw_bmp
 int bmp_display(const char *fbp, struct fb_var_screeninfo *scrinfo, const char *bmp_path, int x, int y) {
     // 调用lcd_draw_bmp实现功能
@@ -0,0 +1,67 @@
+#include "../include/Camera.h"
+#include <algorithm>
+
+namespace {
+    // 边距占视口的比例（蛇头离边缘至少保留视口的1/4）
+    const int MARGIN_DIVISOR = 4;
+}
+
+// 构造函数
+Camera::Camera(int viewColumns, int viewRows)
+    : viewColumns(viewColumns), viewRows(viewRows), worldWidth(viewColumns), worldHeight(viewRows), x(0), y(0) {
+}
+
+// 设置视口尺寸
+void Camera::setView(int columns, int rows) {
+    bool worldMatchesView = worldWidth == viewColumns && worldHeight == viewRows;
+    viewColumns = columns;
+    viewRows = rows;
+    if (worldMatchesView) {
+        worldWidth = columns;
+        worldHeight = rows;
+    }
+    x = clampAxis(x, viewColumns, worldWidth);
+    y = clampAxis(y, viewRows, worldHeight);
+}
+
+// 设置地图尺寸
+void Camera::setWorld(int width, int height) {
+    worldWidth = width;
+    worldHeight = height;
+    x = 0;
+    y = 0;
+}
+
+// 把一个轴上的位置限制在地图范围内
+int Camera::clampAxis(int position, int view, int world) {
+    if (world <= view) {
+        return 0;
+    }
+    return std::max(0, std::min(position, world - view));
+}
+
+// 沿一个轴跟随
+int Camera::followAxis(int position, int head, int view, int world) {
+    if (head < position || head >= position + view) {
+        // 蛇头不在屏幕上，以蛇头为中心
+        return clampAxis(head - view / 2, view, world);
+    }
+    int margin = view / MARGIN_DIVISOR;
+    if (head < position + margin) {
+        position = head - margin;
+    } else if (head >= position + view - margin) {
+        position = head - view + margin + 1;
+    }
+    return clampAxis(position, view, world);
+}
+
+// 跟随蛇头
+bool Camera::follow(int headX, int headY, int& dx, int& dy) {
+    int newX = followAxis(x, headX, viewColumns, worldWidth);
+    int newY = followAxis(y, headY, viewRows, worldHeight);
+    dx = newX - x;
+    dy = newY - y;
+    x = newX;
+    y = newY;
+    return dx != 0 || dy != 0;
+}
@@ -0,0 +1,313 @@
+#include "../include/Checkpoint.h"
+#include "../include/Simulation.h"
+#include "../include/Log.h"
+#include <iostream>
+#include <atomic>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+    const char CHECKPOINT_MAGIC[4] = {'S', 'N', 'K', 'C'};
+    const uint32_t CHECKPOINT_VERSION = 2;
+
+    // 文件头，占用文件开头的一个对齐块
+    struct CheckpointFileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t mapWidth;
+        uint32_t mapHeight;
+        uint32_t slotSize;
+        uint32_t stateSize;
+        uint32_t rngSize;
+    };
+
+    // 每个槽的头部，后面依次是CheckpointState和蛇身坐标
+    struct CheckpointSlotHeader {
+        uint64_t seq;
+        uint32_t crc;
+        uint32_t reserved;
+    };
+
+    const size_t HEADER_BLOCK = 64;
+
+    size_t alignUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // CRC32查找表
+    struct CrcTable {
+        uint32_t entries[256];
+        CrcTable() {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) {
+                    c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                }
+                entries[i] = c;
+            }
+        }
+    };
+    const CrcTable crcTable;
+
+    // 计算槽的CRC（覆盖序号、状态和有效的蛇身坐标）
+    uint32_t slotCrc(const uint8_t* slot, uint32_t bodyLength) {
+        const CheckpointSlotHeader* header = reinterpret_cast<const CheckpointSlotHeader*>(slot);
+        const uint8_t* payload = slot + sizeof(CheckpointSlotHeader);
+        uint32_t crc = crc32Update(0, &header->seq, sizeof(header->seq));
+        return crc32Update(crc, payload, sizeof(CheckpointState) + bodyLength * sizeof(CheckpointCell));
+    }
+}
+
+// 计算CRC32
+uint32_t crc32Update(uint32_t crc, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = crcTable.entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// 构造函数
+Checkpoint::Checkpoint() : fd(-1), base(nullptr), fileSize(0), slotSize(0), maxCells(0), lastSeq(0) {
+}
+
+// 析构函数
+Checkpoint::~Checkpoint() {
+    close();
+}
+
+// 打开（必要时创建）与地图尺寸对应的检查点文件
+bool Checkpoint::open(const std::string& path, int mapWidth, int mapHeight) {
+    close();
+
+    maxCells = static_cast<size_t>(mapWidth) * mapHeight;
+    slotSize = alignUp(sizeof(CheckpointSlotHeader) + sizeof(CheckpointState) + maxCells * sizeof(CheckpointCell),
+                       HEADER_BLOCK);
+    fileSize = HEADER_BLOCK + 2 * slotSize;
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to open checkpoint file: " << path << " (" << strerror(errno) << ")" << std::endl;
+        return false;
+    }
+
+    // 文件大小不符时重新分配（内容在下面的文件头检查中被清空）
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) != fileSize) {
+        if (ftruncate(fd, fileSize) != 0) {
+            std::cerr << "Failed to resize checkpoint file: " << path << " (" << strerror(errno) << ")" << std::endl;
+            close();
+            return false;
+        }
+    }
+
+    void* mapped = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to map checkpoint file: " << path << " (" << strerror(errno) << ")" << std::endl;
+        close();
+        return false;
+    }
+    base = static_cast<uint8_t*>(mapped);
+
+    // 检查文件头，版本或布局不符时清空文件
+    CheckpointFileHeader* header = reinterpret_cast<CheckpointFileHeader*>(base);
+    bool valid = memcmp(header->magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) == 0 &&
+                 header->version == CHECKPOINT_VERSION &&
+                 header->mapWidth == static_cast<uint32_t>(mapWidth) &&
+                 header->mapHeight == static_cast<uint32_t>(mapHeight) &&
+                 header->slotSize == slotSize &&
+                 header->stateSize == sizeof(CheckpointState) &&
+                 header->rngSize == sizeof(std::mt19937);
+    if (!valid) {
+        memset(base, 0, fileSize);
+        memcpy(header->magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        header->version = CHECKPOINT_VERSION;
+        header->mapWidth = mapWidth;
+        header->mapHeight = mapHeight;
+        header->slotSize = slotSize;
+        header->stateSize = sizeof(CheckpointState);
+        header->rngSize = sizeof(std::mt19937);
+    }
+
+    lastSeq = std::max(validateSlot(0), validateSlot(1));
+    return true;
+}
+
+// 关闭并解除映射
+void Checkpoint::close() {
+    if (base) {
+        // 请求内核开始回写，但不等待完成
+        msync(base, fileSize, MS_ASYNC);
+        munmap(base, fileSize);
+        base = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+// 获取指定槽的起始地址
+uint8_t* Checkpoint::slot(int index) const {
+    return base + HEADER_BLOCK + index * slotSize;
+}
+
+// 检查槽是否完整，返回其序号（不完整返回0）
+uint64_t Checkpoint::validateSlot(int index) const {
+    const uint8_t* data = slot(index);
+    const CheckpointSlotHeader* header = reinterpret_cast<const CheckpointSlotHeader*>(data);
+    const CheckpointState* state = reinterpret_cast<const CheckpointState*>(data + sizeof(CheckpointSlotHeader));
+
+    if (header->seq == 0 || state->bodyLength > maxCells) {
+        return 0;
+    }
+    if (slotCrc(data, state->bodyLength) != header->crc) {
+        return 0;
+    }
+    return header->seq;
+}
+
+// 保存模拟状态
+bool Checkpoint::save(const Simulation& sim) {
+    if (!base) {
+        return false;
+    }
+
+    // 写入较旧的槽，最新的完整检查点在写入期间保持不变
+    uint64_t seq = lastSeq + 1;
+    uint8_t* data = slot(seq & 1);
+    CheckpointSlotHeader* header = reinterpret_cast<CheckpointSlotHeader*>(data);
+    CheckpointState* state = reinterpret_cast<CheckpointState*>(data + sizeof(CheckpointSlotHeader));
+    CheckpointCell* cells = reinterpret_cast<CheckpointCell*>(data + sizeof(CheckpointSlotHeader) + sizeof(CheckpointState));
+
+    // 先使槽失效，写入中途失败时读取方不会选择它
+    header->seq = 0;
+    if (!sim.saveCheckpoint(*state, cells, maxCells)) {
+        return false;
+    }
+    header->seq = seq;
+
+    // 最后写CRC，保证读到正确的CRC时状态已经完整
+    std::atomic_thread_fence(std::memory_order_release);
+    header->crc = slotCrc(data, state->bodyLength);
+    lastSeq = seq;
+    return true;
+}
+
+// 从最新的完整检查点恢复模拟状态
+bool Checkpoint::load(Simulation& sim) {
+    if (!base) {
+        return false;
+    }
+
+    // 先尝试最新的槽；CRC正确但内容不合理（例如其他版本写入）时退回到另一个CRC正确的槽
+    uint64_t seqs[2] = {validateSlot(0), validateSlot(1)};
+    int newest = seqs[1] > seqs[0] ? 1 : 0;
+    int order[2] = {newest, 1 - newest};
+    for (int index : order) {
+        if (seqs[index] == 0) {
+            continue;
+        }
+        const uint8_t* data = slot(index);
+        const CheckpointState* state = reinterpret_cast<const CheckpointState*>(data + sizeof(CheckpointSlotHeader));
+        const CheckpointCell* cells =
+            reinterpret_cast<const CheckpointCell*>(data + sizeof(CheckpointSlotHeader) + sizeof(CheckpointState));
+        if (!sim.restoreCheckpoint(*state, cells)) {
+            LOG_WARN("Checkpoint slot " << index << " (seq " << seqs[index] << ") failed to restore");
+            continue;
+        }
+        LOG_INFO("Restored checkpoint slot " << index << " (seq " << seqs[index] << ")");
+
+        // 从较旧的槽恢复时，下一次保存覆盖无法恢复的槽，保留刚恢复的这一个
+        lastSeq = seqs[index];
+        return true;
+    }
+    return false;
+}
+
+// 检查点的自检
+int runCheckpointCheck() {
+    const int width = 20;
+    const int height = 12;
+    char path[] = "/tmp/snake-checkpoint-check-XXXXXX";
+    int tmp = mkstemp(path);
+    if (tmp < 0) {
+        fprintf(stderr, "Checkpoint check FAILED: cannot create a temporary file (%s)\n", strerror(errno));
+        return 1;
+    }
+    ::close(tmp);
+
+    // 写入两个检查点：较旧的在槽1（序号1），最新的在槽0（序号2）
+    Simulation sim(width, height);
+    sim.reset(1);
+    Checkpoint writer;
+    if (!writer.open(path, width, height)) {
+        unlink(path);
+        return 1;
+    }
+    for (int i = 0; i < 5; i++) {
+        sim.step();
+    }
+    writer.save(sim);
+    uint64_t olderTick = sim.getTick();
+    for (int i = 0; i < 5; i++) {
+        sim.step();
+    }
+    writer.save(sim);
+
+    uint8_t* data = writer.slot(0);
+    CheckpointState* state = reinterpret_cast<CheckpointState*>(data + sizeof(CheckpointSlotHeader));
+    CheckpointCell* cells = reinterpret_cast<CheckpointCell*>(data + sizeof(CheckpointSlotHeader) + sizeof(CheckpointState));
+    uint32_t length = state->bodyLength;
+    std::vector<uint8_t> saved(data, data + writer.slotSize);
+
+    // 依次破坏最新槽的蛇身并重新计算CRC，每次都应从较旧的槽恢复
+    const char* cases[] = {"out-of-range body", "non-adjacent body", "repeated body cell"};
+    const int caseCount = sizeof(cases) / sizeof(cases[0]);
+    int failures = 0;
+    for (int c = 0; c < caseCount; c++) {
+        memcpy(data, saved.data(), saved.size());
+        if (c == 0) {
+            cells[length - 1].x = width;
+        } else if (c == 1) {
+            cells[1].x = static_cast<int16_t>(cells[0].x + (cells[0].x + 2 < width ? 2 : -2));
+            cells[1].y = cells[0].y;
+        } else {
+            cells[2] = cells[0];
+        }
+        reinterpret_cast<CheckpointSlotHeader*>(data)->crc = slotCrc(data, length);
+
+        Simulation restored(width, height);
+        Checkpoint reader;
+        bool loaded = reader.open(path, width, height) && reader.validateSlot(0) == 2 && reader.load(restored);
+        if (!loaded || restored.getTick() != olderTick) {
+            fprintf(stderr, "Checkpoint check FAILED: %s was not rejected in favour of the older slot\n", cases[c]);
+            failures++;
+        }
+    }
+
+    // 两个槽都无法恢复时不应恢复任何状态
+    writer.slot(1)[sizeof(CheckpointSlotHeader) + sizeof(CheckpointState)] ^= 0xFF;
+    Simulation restored(width, height);
+    Checkpoint reader;
+    if (!reader.open(path, width, height) || reader.load(restored)) {
+        fprintf(stderr, "Checkpoint check FAILED: a file with no usable slot was loaded\n");
+        failures++;
+    }
+
+    reader.close();
+    writer.close();
+    unlink(path);
+    if (failures > 0) {
+        return 1;
+    }
+    printf("Checkpoint check OK: %d corrupted body layouts fell back to the older slot\n", caseCount);
+    return 0;
+}
@@ -1,11 +1,19 @@
 #include "../include/Display.h"
 #include "../include/Game.h"
+#include "../include/Telemetry.h"
+#include "../include/Trace.h"
+#include "../include/Log.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <cstring>
 #include <vector>
 #include <chrono>
+#include <cstdlib>
+#include <algorithm>
+
+// 类内初始化的静态常量在按引用传递时需要定义
+const unsigned int Display::PANEL_COLOR;
 
 // 构造函数
 Display::Display(int width, int height, int cellSize)
@@ -17,7 +25,13 @@ Display::Display(int width, int height, int cellSize)
       screenSize(0),
       resourcePath(""),
       resourcesLoaded(false),
-      backgroundDrawn(false) {
+      bgBuffer(nullptr),
+      backgroundDrawn(false),
+      headless(false),
+      camera(width / cellSize, height / cellSize),
+      grassTilesCached(false),
+      level(nullptr),
+      referenceMode(false) {
 }
 
 // 析构函数
@@ -30,20 +44,20 @@ bool Display::initialize() {
     // 打开帧缓冲设备
     fbFd = open("/dev/fb0", O_RDWR);
     if (fbFd == -1) {
-        std::cerr << "Error opening framebuffer device" << std::endl;
+        LOG_ERROR("Error opening framebuffer device");
         return false;
     }
     
     // 获取屏幕固定信息
     if (ioctl(fbFd, FBIOGET_FSCREENINFO, &finfo) == -1) {
-        std::cerr << "Error reading fixed screen info" << std::endl;
+        LOG_ERROR("Error reading fixed screen info");
         close();
         return false;
     }
     
     // 获取屏幕可变信息
     if (ioctl(fbFd, FBIOGET_VSCREENINFO, &vinfo) == -1) {
-        std::cerr << "Error reading variable screen info" << std::endl;
+        LOG_ERROR("Error reading variable screen info");
         close();
         return false;
     }
@@ -54,7 +68,7 @@ bool Display::initialize() {
     // 映射帧缓冲区
     fbp = (char*)mmap(0, screenSize, PROT_READ | PROT_WRITE, MAP_SHARED, fbFd, 0);
     if ((long)fbp == -1) {
-        std::cerr << "Error mapping framebuffer device to memory" << std::endl;
+        LOG_ERROR("Error mapping framebuffer device to memory");
         close();
         return false;
     }
@@ -62,26 +76,53 @@ bool Display::initialize() {
     // 设置屏幕尺寸
     screenWidth = vinfo.xres;
     screenHeight = vinfo.yres;
+    camera.setView(screenWidth / cellSize, screenHeight / cellSize);
     
     // 创建背景缓冲区（减少频闪）
     try {
         bgBuffer = new char[screenSize];
         if (!bgBuffer) {
-            std::cerr << "Failed to allocate background buffer" << std::endl;
+            LOG_ERROR("Failed to allocate background buffer");
         } else {
-            std::cout << "Background buffer created" << std::endl;
+            LOG_INFO("Background buffer created");
         }
     } catch (const std::exception& e) {
-        std::cerr << "Failed to create background buffer: " << e.what() << std::endl;
+        LOG_ERROR("Failed to create background buffer: " << e.what());
         bgBuffer = nullptr;
     }
     
-    std::cout << "Framebuffer initialized: " << screenWidth << "x" << screenHeight 
-              << ", " << vinfo.bits_per_pixel << " bpp" << std::endl;
+    LOG_INFO("Framebuffer initialized: " << screenWidth << "x" << screenHeight 
+             << ", " << vinfo.bits_per_pixel << " bpp");
     
     return true;
 }
 
+// 以无头模式初始化
+bool Display::initializeHeadless() {
+    headless = true;
+    
+    // 模拟一块32位色深的屏幕
+    std::memset(&vinfo, 0, sizeof(vinfo));
+    std::memset(&finfo, 0, sizeof(finfo));
+    vinfo.xres = vinfo.xres_virtual = screenWidth;
+    vinfo.yres = vinfo.yres_virtual = screenHeight;
+    vinfo.bits_per_pixel = 32;
+    screenSize = screenWidth * screenHeight * 4;
+    
+    try {
+        fbp = new char[screenSize]();
+        bgBuffer = new char[screenSize];
+    } catch (const std::exception& e) {
+        LOG_ERROR("Failed to allocate headless framebuffer: " << e.what());
+        close();
+        return false;
+    }
+    
+    camera.setView(screenWidth / cellSize, screenHeight / cellSize);
+    LOG_INFO("Headless framebuffer initialized: " << screenWidth << "x" << screenHeight);
+    return true;
+}
+
 // 清空屏幕
 void Display::clear() {
     if (fbp) {
@@ -95,18 +136,18 @@ bool Display::loadResources(const std::string& path) {
     try {
         // 检查路径是否为空
         if (path.empty()) {
-            std::cerr << "Error: Resource path is empty" << std::endl;
+            LOG_ERROR("Error: Resource path is empty");
             return false;
         }
         
         // 检查路径是否存在
         if (access(path.c_str(), F_OK) == -1) {
-            std::cerr << "Error: Resource path does not exist: " << path << std::endl;
+            LOG_ERROR("Error: Resource path does not exist: " << path);
             return false;
         }
         
         resourcePath = path;
-        std::cout << "Loading resources from: " << resourcePath << std::endl;
+        LOG_INFO("Loading resources from: " << resourcePath);
         
         // 构建各种游戏元素的BMP路径
         // 蛇头图片（四个方向）
@@ -149,8 +190,8 @@ bool Display::loadResources(const std::string& path) {
         game_overBmp = resourcePath + "/game_over.bmp";
         
         // 输出调试信息
-        std::cout << "Checking resources..." << std::endl;
-        std::cout << "Resource path: " << resourcePath << std::endl;
+        LOG_INFO("Checking resources...");
+        LOG_INFO("Resource path: " << resourcePath);
         
         // 检查必要文件是否存在
         std::vector<std::pair<std::string, std::string>> requiredFiles = {
@@ -167,12 +208,12 @@ bool Display::loadResources(const std::string& path) {
         
         // 检查每个必要文件
         for (const auto& file : requiredFiles) {
-            std::cout << "Checking file: " << file.first << std::endl;
+            LOG_INFO("Checking file: " << file.first);
             if (access(file.first.c_str(), F_OK) == -1) {
-                std::cerr << "Error: Required file not found: " << file.first << " (" << file.second << ")" << std::endl;
+                LOG_ERROR("Error: Required file not found: " << file.first << " (" << file.second << ")");
                 return false;
             } else {
-                std::cout << "Found: " << file.second << " at " << file.first << std::endl;
+                LOG_INFO("Found: " << file.second << " at " << file.first);
             }
         }
         
@@ -194,57 +235,265 @@ bool Display::loadResources(const std::string& path) {
         // 检查每个可选文件
         for (const auto& file : optionalFiles) {
             if (access(file.first.c_str(), F_OK) == -1) {
-                std::cout << "Warning: Optional file not found: " << file.first << " (" << file.second << ")" << std::endl;
+                LOG_WARN("Warning: Optional file not found: " << file.first << " (" << file.second << ")");
             } else {
-                std::cout << "Found: " << file.second << " at " << file.first << std::endl;
+                LOG_INFO("Found: " << file.second << " at " << file.first);
             }
         }
         
+        // 预先解码游戏结束画面（可选文件，缺少时使用生成的面板），并生成重新开始的提示
+        int panelSize = std::min(screenWidth, screenHeight) / 3;
+        if (bmp_decode(game_overBmp.c_str(), &gameOverOverlay.width, &gameOverOverlay.height, gameOverOverlay.pixels)) {
+            LOG_INFO("Found: Game over at " << game_overBmp);
+        } else {
+            LOG_WARN("Warning: Optional file not found: " << game_overBmp << " (Game over), using a generated panel");
+            buildPanelOverlay(gameOverOverlay, panelSize, false);
+        }
+        buildPanelOverlay(restartOverlay, panelSize / 2, true);
+        
         resourcesLoaded = true;
-        std::cout << "All required resources loaded successfully!" << std::endl;
+        LOG_INFO("All required resources loaded successfully!");
         return true;
     } catch (const std::exception& e) {
-        std::cerr << "Error loading resources: " << e.what() << std::endl;
+        LOG_ERROR("Error loading resources: " << e.what());
+        return false;
+    }
+}
+
+// 设置地图尺寸
+void Display::setWorldSize(int width, int height) {
+    camera.setWorld(width, height);
+    backgroundDrawn = false;
+}
+
+// 设置关卡
+void Display::setLevel(const Level* newLevel) {
+    level = newLevel;
+    backgroundDrawn = false;
+}
+
+// 让摄像机跟随蛇头
+void Display::followHead(int headX, int headY) {
+    int dx = 0;
+    int dy = 0;
+    if (camera.follow(headX, headY, dx, dy) && !referenceMode) {
+        scrollBackground(dx, dy);
+    }
+}
+
+// 地图坐标转换为屏幕坐标
+bool Display::cellToScreen(int cellX, int cellY, int* screenX, int* screenY) const {
+    if (!camera.isVisible(cellX, cellY)) {
         return false;
     }
+    *screenX = (cellX - camera.getX()) * cellSize;
+    *screenY = (cellY - camera.getY()) * cellSize;
+    return true;
+}
+
+// 从背景缓冲区中保存两种草地格子
+void Display::cacheGrassTiles() {
+    if (!bgBuffer || camera.getViewColumns() < 2 || camera.getViewRows() < 1) {
+        return;
+    }
+    int bytesPerPixel = vinfo.bits_per_pixel / 8;
+    size_t lineBytes = static_cast<size_t>(vinfo.xres_virtual) * bytesPerPixel;
+    size_t tileLineBytes = static_cast<size_t>(cellSize) * bytesPerPixel;
+    grassTiles.resize(2 * tileLineBytes * cellSize);
+    
+    // 视口第一行的前两个格子正好是两种草地，按地图坐标的奇偶保存
+    for (int column = 0; column < 2; column++) {
+        int parity = (camera.getX() + column + camera.getY()) % 2;
+        char* tile = &grassTiles[parity * tileLineBytes * cellSize];
+        for (int line = 0; line < cellSize; line++) {
+            std::memcpy(tile + line * tileLineBytes, bgBuffer + line * lineBytes + column * tileLineBytes, tileLineBytes);
+        }
+    }
+    grassTilesCached = true;
+}
+
+// 视口中的格子是否是墙
+bool Display::isWallCell(int column, int row) const {
+    if (!level) {
+        return false;
+    }
+    int x = camera.getX() + column;
+    int y = camera.getY() + row;
+    return x < level->getWidth() && y < level->getHeight() && level->isWall(x, y);
+}
+
+// 绘制一个墙格子
+void Display::drawWallTile(char* buffer, int screenX, int screenY) {
+    int bytesPerPixel = vinfo.bits_per_pixel / 8;
+    size_t lineBytes = static_cast<size_t>(vinfo.xres_virtual) * bytesPerPixel;
+    size_t tileLineBytes = static_cast<size_t>(cellSize) * bytesPerPixel;
+    if (wallTile.size() != tileLineBytes * cellSize) {
+        // 实心砖块加深色边框，按帧缓冲格式生成一次
+        wallTile.resize(tileLineBytes * cellSize);
+        int edge = std::max(1, cellSize / 10);
+        for (int y = 0; y < cellSize; y++) {
+            for (int x = 0; x < cellSize; x++) {
+                bool border = x < edge || y < edge || x >= cellSize - edge || y >= cellSize - edge;
+                unsigned int color = border ? WALL_EDGE_COLOR : WALL_COLOR;
+                std::memcpy(&wallTile[y * tileLineBytes + x * bytesPerPixel], &color, bytesPerPixel);
+            }
+        }
+    }
+    char* target = buffer + screenY * lineBytes + screenX * bytesPerPixel;
+    for (int line = 0; line < cellSize; line++) {
+        std::memcpy(target + line * lineBytes, &wallTile[line * tileLineBytes], tileLineBytes);
+    }
+    Telemetry::add(TelemetryCounter::SPRITE_CACHE_HITS);
+    Telemetry::add(TelemetryCounter::BYTES_BLITTED, tileLineBytes * cellSize);
+}
+
+// 在背景缓冲区中绘制一个草地格子或墙
+void Display::drawBackgroundCell(int column, int row) {
+    int screenX = column * cellSize;
+    int screenY = row * cellSize;
+    if (isWallCell(column, row)) {
+        drawWallTile(bgBuffer, screenX, screenY);
+        return;
+    }
+    // 棋盘式交替绘制grass1和grass2（按地图坐标，滚动时图案随地图移动）
+    int parity = (camera.getX() + column + camera.getY() + row) % 2;
+    
+    if (!grassTilesCached) {
+        lcd_draw_bmp(bgBuffer, &vinfo, screenX, screenY, (parity == 0 ? grass1Bmp : grass2Bmp).c_str());
+        Telemetry::add(TelemetryCounter::SPRITE_LOADS);
+        return;
+    }
+    int bytesPerPixel = vinfo.bits_per_pixel / 8;
+    size_t lineBytes = static_cast<size_t>(vinfo.xres_virtual) * bytesPerPixel;
+    size_t tileLineBytes = static_cast<size_t>(cellSize) * bytesPerPixel;
+    const char* tile = &grassTiles[parity * tileLineBytes * cellSize];
+    char* target = bgBuffer + screenY * lineBytes + screenX * bytesPerPixel;
+    for (int line = 0; line < cellSize; line++) {
+        std::memcpy(target + line * lineBytes, tile + line * tileLineBytes, tileLineBytes);
+    }
+    Telemetry::add(TelemetryCounter::SPRITE_CACHE_HITS);
+    Telemetry::add(TelemetryCounter::BYTES_BLITTED, tileLineBytes * cellSize);
+}
+
+// 摄像机移动后滚动背景缓冲区
+void Display::scrollBackground(int dx, int dy) {
+    TRACE_SPAN("scroll background");
+    // 背景还没有缓存时，下一次drawMap会完整绘制
+    if (!backgroundDrawn || !bgBuffer) {
+        return;
+    }
+    int columns = camera.getViewColumns();
+    int rows = camera.getViewRows();
+    if (std::abs(dx) >= columns || std::abs(dy) >= rows) {
+        // 移动超过一屏，没有可以重用的部分
+        backgroundDrawn = false;
+        return;
+    }
+    
+    // 已绘制的区域整块移动：新的第y行来自原来的第y+shiftY行
+    int bytesPerPixel = vinfo.bits_per_pixel / 8;
+    size_t lineBytes = static_cast<size_t>(vinfo.xres_virtual) * bytesPerPixel;
+    int shiftX = dx * cellSize;
+    int shiftY = dy * cellSize;
+    size_t moveBytes = static_cast<size_t>(columns * cellSize - std::abs(shiftX)) * bytesPerPixel;
+    size_t targetX = static_cast<size_t>(std::max(0, -shiftX)) * bytesPerPixel;
+    size_t sourceX = static_cast<size_t>(std::max(0, shiftX)) * bytesPerPixel;
+    int lines = rows * cellSize - std::abs(shiftY);
+    int firstTarget = std::max(0, -shiftY);
+    for (int i = 0; i < lines; i++) {
+        // 向上移动时从上往下复制，向下移动时从下往上复制，避免覆盖还没有移动的行
+        int targetLine = firstTarget + (shiftY >= 0 ? i : lines - 1 - i);
+        int sourceLine = targetLine + shiftY;
+        std::memmove(bgBuffer + targetLine * lineBytes + targetX, bgBuffer + sourceLine * lineBytes + sourceX, moveBytes);
+    }
+    Telemetry::add(TelemetryCounter::BYTES_BLITTED, moveBytes * lines);
+    
+    // 只绘制新露出的列和行
+    int firstColumn = dx > 0 ? columns - dx : 0;
+    for (int column = firstColumn; column < firstColumn + std::abs(dx); column++) {
+        for (int row = 0; row < rows; row++) {
+            drawBackgroundCell(column, row);
+        }
+    }
+    int firstRow = dy > 0 ? rows - dy : 0;
+    for (int row = firstRow; row < firstRow + std::abs(dy); row++) {
+        for (int column = 0; column < columns; column++) {
+            drawBackgroundCell(column, row);
+        }
+    }
 }
 
 // 绘制地图
 void Display::drawMap(const Map* map) {
     if (!fbp || !resourcesLoaded) return;
+    TRACE_SPAN("blit background");
+    
+    if (referenceMode) {
+        drawReferenceBackground();
+        return;
+    }
     
     // 如果背景已经绘制过，并且有背景缓冲区，则直接复制背景
     if (backgroundDrawn && bgBuffer) {
         // 复制预渲染的背景到帧缓冲区
         std::memcpy(fbp, bgBuffer, screenSize);
+        Telemetry::add(TelemetryCounter::BYTES_BLITTED, screenSize);
         return;
     }
     
-    // 首次绘制背景
-    // 绘制背景（棋盘形式的草地）
-    int mapWidth = screenWidth / cellSize;
-    int mapHeight = screenHeight / cellSize;
+    // 绘制背景（棋盘形式的草地，摄像机跳到新的位置后需要重新绘制）
+    int mapWidth = camera.getViewColumns();
+    int mapHeight = camera.getViewRows();
     
-    for (int y = 0; y < mapHeight; y++) {
-        for (int x = 0; x < mapWidth; x++) {
-            // 计算屏幕坐标
-            int screenX = x * cellSize;
-            int screenY = y * cellSize;
-            
-            // 棋盘式交替绘制grass1和grass2
-            if ((x + y) % 2 == 0) {
-                drawBmp(screenX, screenY, grass1Bmp);
-            } else {
-                drawBmp(screenX, screenY, grass2Bmp);
+    if (bgBuffer && grassTilesCached) {
+        // 已经保存了草地格子，直接在背景缓冲区中拼出整个屏幕
+        for (int y = 0; y < mapHeight; y++) {
+            for (int x = 0; x < mapWidth; x++) {
+                drawBackgroundCell(x, y);
             }
         }
-    }
-    
-    // 保存背景到缓冲区（如果有）
-    if (bgBuffer) {
-        std::memcpy(bgBuffer, fbp, screenSize);
+        std::memcpy(fbp, bgBuffer, screenSize);
+        Telemetry::add(TelemetryCounter::BYTES_BLITTED, screenSize);
         backgroundDrawn = true;
-        std::cout << "Background cached to reduce flicker" << std::endl;
+    } else {
+        // 首次绘制背景
+        for (int y = 0; y < mapHeight; y++) {
+            for (int x = 0; x < mapWidth; x++) {
+                // 计算屏幕坐标
+                int screenX = x * cellSize;
+                int screenY = y * cellSize;
+                
+                // 棋盘式交替绘制grass1和grass2
+                if ((camera.getX() + x + camera.getY() + y) % 2 == 0) {
+                    drawBmp(screenX, screenY, grass1Bmp);
+                } else {
+                    drawBmp(screenX, screenY, grass2Bmp);
+                }
+            }
+        }
+        
+        // 保存背景到缓冲区（如果有）
+        if (bgBuffer) {
+            std::memcpy(bgBuffer, fbp, screenSize);
+            backgroundDrawn = true;
+            cacheGrassTiles();
+            LOG_INFO("Background cached to reduce flicker");
+        }
+        
+        // 墙在保存草地格子之后才叠加到背景上，保存的草地格子不会是墙
+        if (level) {
+            char* target = bgBuffer ? bgBuffer : fbp;
+            for (int y = 0; y < mapHeight; y++) {
+                for (int x = 0; x < mapWidth; x++) {
+                    if (isWallCell(x, y)) {
+                        drawWallTile(target, x * cellSize, y * cellSize);
+                    }
+                }
+            }
+            if (bgBuffer) {
+                std::memcpy(fbp, bgBuffer, screenSize);
+            }
+        }
     }
     
     // 如果有地图对象，绘制地图元素
@@ -262,7 +511,7 @@ void Display::drawMap(const Map* map) {
                 // 根据元素类型绘制不同的图像
                 switch (element) {
                     case MapElementType::WALL:
-                        // 墙壁暂时不绘制
+                        // 墙已经画在背景中
                         break;
                     case MapElementType::FOOD:
                         // 食物在drawFood中绘制
@@ -282,60 +531,120 @@ void Display::drawMap(const Map* map) {
     }
 }
 
+// 参考绘制：逐个格子从BMP文件绘制草地，逐个像素绘制墙
+void Display::drawReferenceBackground() {
+    int edge = std::max(1, cellSize / 10);
+    for (int row = 0; row < camera.getViewRows(); row++) {
+        for (int column = 0; column < camera.getViewColumns(); column++) {
+            int screenX = column * cellSize;
+            int screenY = row * cellSize;
+            if (!isWallCell(column, row)) {
+                int parity = (camera.getX() + column + camera.getY() + row) % 2;
+                lcd_draw_bmp(fbp, &vinfo, screenX, screenY, (parity == 0 ? grass1Bmp : grass2Bmp).c_str());
+                continue;
+            }
+            for (int y = 0; y < cellSize; y++) {
+                for (int x = 0; x < cellSize; x++) {
+                    bool border = x < edge || y < edge || x >= cellSize - edge || y >= cellSize - edge;
+                    lcd_draw_point(fbp, &vinfo, screenX + x, screenY + y, border ? WALL_EDGE_COLOR : WALL_COLOR);
+                }
+            }
+        }
+    }
+}
+
+// 按快照绘制一帧
+void Display::drawFrame(const GameSnapshot& snapshot) {
+    // 摄像机跟随蛇头，移动时滚动背景
+    if (!snapshot.body.empty()) {
+        followHead(snapshot.body[0].first, snapshot.body[0].second);
+    }
+    
+    // 绘制地图背景（地图元素由快照中的食物和蛇绘制）
+    drawMap(nullptr);
+    
+    // 绘制所有食物
+    {
+        TRACE_SPAN("draw foods");
+        for (const auto& food : snapshot.foods) {
+            drawFood(&food);
+        }
+    }
+    
+    // 绘制对手蛇和蛇（最后绘制蛇，确保蛇覆盖在其他元素上方）
+    {
+        TRACE_SPAN("draw snakes");
+        for (size_t i = 0; i < snapshot.rivalBodies.size(); i++) {
+            if (!snapshot.rivalBodies[i].empty()) {
+                drawSnakeBody(snapshot.rivalBodies[i], snapshot.rivalDirections[i]);
+            }
+        }
+        drawSnakeBody(snapshot.body, snapshot.direction);
+    }
+}
+
 // 绘制蛇
 void Display::drawSnake(const Snake* snake) {
-    if (!fbp || !snake || !resourcesLoaded) return;
+    if (!snake) return;
     
-    // 获取蛇身体
-    const auto& body = snake->getBody();
+    snake->copyBody(snakeBody);
+    drawSnakeBody(snakeBody, snake->getDirection());
+}
+
+// 根据身体坐标和移动方向绘制蛇
+void Display::drawSnakeBody(const std::vector<std::pair<int, int>>& body, Direction snakeDirection) {
+    if (!fbp || !resourcesLoaded) return;
     
     if (body.empty()) return;
     
     try {
-        // 绘制蛇头，根据方向选择正确的图片
-        int headX = body[0].first * cellSize;
-        int headY = body[0].second * cellSize;
-        
-        Direction snakeDirection = snake->getDirection();
-        switch (snakeDirection) {
-            case Direction::UP:
-                if (access(snakeHeadBmpUp.c_str(), F_OK) != -1) {
-                    drawTransparentBmp(headX, headY, snakeHeadBmpUp);
-                } else {
-                    // 如果特定方向的图片不存在，使用默认图片
-                    drawTransparentBmp(headX, headY, snakeHeadBmpRight);
-                }
-                break;
-            case Direction::DOWN:
-                if (access(snakeHeadBmpDown.c_str(), F_OK) != -1) {
-                    drawTransparentBmp(headX, headY, snakeHeadBmpDown);
-                } else {
-                    drawTransparentBmp(headX, headY, snakeHeadBmpRight);
-                }
-                break;
-            case Direction::LEFT:
-                if (access(snakeHeadBmpRight.c_str(), F_OK) != -1) {
-                    drawTransparentBmp(headX, headY, snakeHeadBmpRight);
-                } else {
-                    drawTransparentBmp(headX, headY, snakeHeadBmpRight);
-                }
-                break;
-            case Direction::RIGHT:
-            default:
-                if (access(snakeHeadBmpLeft.c_str(), F_OK) != -1) {
-                    drawTransparentBmp(headX, headY, snakeHeadBmpLeft);
-                } else {
-                    drawTransparentBmp(headX, headY, snakeHeadBmpRight);
-                }
-                break;
+        // 绘制蛇头，根据方向选择正确的图片（只绘制屏幕上的部分）
+        int headX = 0;
+        int headY = 0;
+        if (cellToScreen(body[0].first, body[0].second, &headX, &headY)) {
+            switch (snakeDirection) {
+                case Direction::UP:
+                    if (access(snakeHeadBmpUp.c_str(), F_OK) != -1) {
+                        drawTransparentBmp(headX, headY, snakeHeadBmpUp);
+                    } else {
+                        // 如果特定方向的图片不存在，使用默认图片
+                        drawTransparentBmp(headX, headY, snakeHeadBmpRight);
+                    }
+                    break;
+                case Direction::DOWN:
+                    if (access(snakeHeadBmpDown.c_str(), F_OK) != -1) {
+                        drawTransparentBmp(headX, headY, snakeHeadBmpDown);
+                    } else {
+                        drawTransparentBmp(headX, headY, snakeHeadBmpRight);
+                    }
+                    break;
+                case Direction::LEFT:
+                    if (access(snakeHeadBmpRight.c_str(), F_OK) != -1) {
+                        drawTransparentBmp(headX, headY, snakeHeadBmpRight);
+                    } else {
+                        drawTransparentBmp(headX, headY, snakeHeadBmpRight);
+                    }
+                    break;
+                case Direction::RIGHT:
+                default:
+                    if (access(snakeHeadBmpLeft.c_str(), F_OK) != -1) {
+                        drawTransparentBmp(headX, headY, snakeHeadBmpLeft);
+                    } else {
+                        drawTransparentBmp(headX, headY, snakeHeadBmpRight);
+                    }
+                    break;
+            }
         }
         
         // 如果蛇身长度大于1，绘制蛇身
         if (body.size() > 1) {
             // 绘制蛇身，根据相邻节点位置确定方向
             for (std::size_t i = 1; i < body.size() - 1 && i < body.size(); i++) {
-                int bodyX = body[i].first * cellSize;
-                int bodyY = body[i].second * cellSize;
+                int bodyX = 0;
+                int bodyY = 0;
+                if (!cellToScreen(body[i].first, body[i].second, &bodyX, &bodyY)) {
+                    continue;
+                }
                 
                 // 获取前一个和后一个节点的位置
                 std::pair<int, int> prev = body[i-1];
@@ -351,28 +660,29 @@ void Display::drawSnake(const Snake* snake) {
                     drawTransparentBmp(bodyX, bodyY, snakeBodyBmpHorizontal);
                 } else {
                     // 拐角，根据前后节点位置确定拐角类型
-                    std::string cornerBmp;
+                    // 指向成员中的路径，不复制字符串（渲染帧不分配内存）
+                    const std::string* cornerBmp;
                     
                     // 修正拐角判断逻辑，确保方向正确
                     if ((prev.first < curr.first && next.second < curr.second) || 
                         (prev.second < curr.second && next.first < curr.first)) {
                         // 左上拐角
-                        cornerBmp = snakeBodyBmpUL;
+                        cornerBmp = &snakeBodyBmpUL;
                     } else if ((prev.first > curr.first && next.second < curr.second) || 
                               (prev.second < curr.second && next.first > curr.first)) {
                         // 右上拐角
-                        cornerBmp = snakeBodyBmpUR;
+                        cornerBmp = &snakeBodyBmpUR;
                     } else if ((prev.first < curr.first && next.second > curr.second) || 
                               (prev.second > curr.second && next.first < curr.first)) {
                         // 左下拐角
-                        cornerBmp = snakeBodyBmpDL;
+                        cornerBmp = &snakeBodyBmpDL;
                     } else {
                         // 右下拐角
-                        cornerBmp = snakeBodyBmpDR;
+                        cornerBmp = &snakeBodyBmpDR;
                     }
                     
                     // 检查拐角图片是否存在
-                    if (access(cornerBmp.c_str(), F_OK) == -1) {
+                    if (access(cornerBmp->c_str(), F_OK) == -1) {
                         // 如果拐角图片不存在，使用默认的身体图片
                         if (prev.first == curr.first || next.first == curr.first) {
                             drawTransparentBmp(bodyX, bodyY, snakeBodyBmpVertical);
@@ -380,43 +690,43 @@ void Display::drawSnake(const Snake* snake) {
                             drawTransparentBmp(bodyX, bodyY, snakeBodyBmpHorizontal);
                         }
                     } else {
-                        drawTransparentBmp(bodyX, bodyY, cornerBmp);
+                        drawTransparentBmp(bodyX, bodyY, *cornerBmp);
                     }
                 }
             }
             
-            // 绘制蛇尾，根据倒数第二个节点的位置确定方向
-            if (body.size() >= 2) {
-                int tailX = body.back().first * cellSize;
-                int tailY = body.back().second * cellSize;
+            // 绘制蛇尾，根据倒数第二个节点的位置确定方向（只绘制屏幕上的部分）
+            int tailX = 0;
+            int tailY = 0;
+            if (body.size() >= 2 && cellToScreen(body.back().first, body.back().second, &tailX, &tailY)) {
                 
                 std::pair<int, int> tailPart = body.back();
                 std::pair<int, int> beforeTail = body[body.size() - 2];
                 
-                std::string tailBmp;
+                const std::string* tailBmp;
                 // 修正尾部方向判断逻辑
                 if (beforeTail.first == tailPart.first) {
                     // 垂直方向
                     if (beforeTail.second < tailPart.second) {
                         // 尾部在下，头部在上方向
-                        tailBmp = snakeTailBmpUp;
+                        tailBmp = &snakeTailBmpUp;
                     } else {
                         // 尾部在上，头部在下方向
-                        tailBmp = snakeTailBmpDown;
+                        tailBmp = &snakeTailBmpDown;
                     }
                 } else {
                     // 水平方向
                     if (beforeTail.first < tailPart.first) {
                         // 尾部在右，头部在左方向
-                        tailBmp = snakeTailBmpLeft;
+                        tailBmp = &snakeTailBmpLeft;
                     } else {
                         // 尾部在左，头部在右方向
-                        tailBmp = snakeTailBmpRight;
+                        tailBmp = &snakeTailBmpRight;
                     }
                 }
                 
                 // 检查尾部图片是否存在
-                if (access(tailBmp.c_str(), F_OK) == -1) {
+                if (access(tailBmp->c_str(), F_OK) == -1) {
                     // 如果尾部图片不存在，使用默认的身体图片
                     if (beforeTail.first == tailPart.first) {
                         drawTransparentBmp(tailX, tailY, snakeBodyBmpVertical);
@@ -424,12 +734,12 @@ void Display::drawSnake(const Snake* snake) {
                         drawTransparentBmp(tailX, tailY, snakeBodyBmpHorizontal);
                     }
                 } else {
-                    drawTransparentBmp(tailX, tailY, tailBmp);
+                    drawTransparentBmp(tailX, tailY, *tailBmp);
                 }
             }
         }
     } catch (const std::exception& e) {
-        std::cerr << "Error drawing snake: " << e.what() << std::endl;
+        LOG_ERROR("Error drawing snake: " << e.what());
     }
 }
 
@@ -437,47 +747,113 @@ void Display::drawSnake(const Snake* snake) {
 void Display::drawFood(const Food* food) {
     if (!fbp || !food || !resourcesLoaded) return;
     
-    // 获取食物位置
-    int foodX = food->getX() * cellSize;
-    int foodY = food->getY() * cellSize;
+    // 获取食物位置，不在屏幕上时不绘制
+    int foodX = 0;
+    int foodY = 0;
+    if (!cellToScreen(food->getX(), food->getY(), &foodX, &foodY)) {
+        return;
+    }
     
     // 根据食物类型选择不同的图片
-    std::string foodImage;
+    // 指向成员中的路径，不复制字符串
+    const std::string* foodImage;
     switch (food->getType()) {
         case FoodType::APPLE:
-            foodImage = appleBmp;
+            foodImage = &appleBmp;
             break;
         case FoodType::PEPPER:
             // 如果辣椒图片不存在，使用苹果图片
             if (access(pepperBmp.c_str(), F_OK) != -1) {
-                foodImage = pepperBmp;
+                foodImage = &pepperBmp;
             } else {
-                foodImage = appleBmp;
+                foodImage = &appleBmp;
             }
             break;
         case FoodType::MEAT:
             // 如果肉图片不存在，使用苹果图片
             if (access(meatBmp.c_str(), F_OK) != -1) {
-                foodImage = meatBmp;
+                foodImage = &meatBmp;
             } else {
-                foodImage = appleBmp;
+                foodImage = &appleBmp;
             }
             break;
         case FoodType::BOMB:
             // 如果炸弹图片不存在，使用苹果图片
             if (access(bombBmp.c_str(), F_OK) != -1) {
-                foodImage = bombBmp;
+                foodImage = &bombBmp;
             } else {
-                foodImage = appleBmp;
+                foodImage = &appleBmp;
             }
             break;
         default:
-            foodImage = appleBmp;
+            foodImage = &appleBmp;
             break;
     }
     
     // 绘制食物图像，使用透明背景
-    drawTransparentBmp(foodX, foodY, foodImage);
+    drawTransparentBmp(foodX, foodY, *foodImage);
+}
+
+// 绘制小地图
+void Display::drawMinimap(const Minimap& minimap, int headX, int headY) {
+    if (!fbp || !minimap.isConfigured()) return;
+    TRACE_SPAN("blit minimap");
+    
+    int width = minimap.getWidth();
+    int height = minimap.getHeight();
+    int left = screenWidth - MINIMAP_MARGIN - width;
+    int top = screenHeight - MINIMAP_MARGIN - height;
+    if (left < 0 || top < 0) {
+        return;
+    }
+    
+    // 逐行复制缓存的像素（32位帧缓冲区可以整行复制）
+    int bytesPerPixel = vinfo.bits_per_pixel / 8;
+    size_t lineBytes = static_cast<size_t>(vinfo.xres_virtual) * bytesPerPixel;
+    for (int row = 0; row < height; row++) {
+        const uint32_t* source = minimap.getLine(row);
+        char* target = fbp + (top + row) * lineBytes + static_cast<size_t>(left) * bytesPerPixel;
+        if (bytesPerPixel == 4) {
+            std::memcpy(target, source, static_cast<size_t>(width) * 4);
+        } else {
+            for (int column = 0; column < width; column++) {
+                std::memcpy(target + column * bytesPerPixel, &source[column], bytesPerPixel);
+            }
+        }
+    }
+    Telemetry::add(TelemetryCounter::BYTES_BLITTED, static_cast<uint64_t>(width) * height * bytesPerPixel);
+    
+    // 摄像机范围（地图不大于屏幕时就是整个小地图，不画）
+    int viewLeft = minimap.cellToPixelX(camera.getX());
+    int viewTop = minimap.cellToPixelY(camera.getY());
+    int viewRight = minimap.cellToPixelX(camera.getX() + camera.getViewColumns() - 1) + minimap.getPixelsPerCell() - 1;
+    int viewBottom = minimap.cellToPixelY(camera.getY() + camera.getViewRows() - 1) + minimap.getPixelsPerCell() - 1;
+    viewRight = std::min(viewRight, width - 1);
+    viewBottom = std::min(viewBottom, height - 1);
+    if (viewLeft > 0 || viewTop > 0 || viewRight < width - 1 || viewBottom < height - 1) {
+        for (int x = viewLeft; x <= viewRight; x++) {
+            drawPoint(left + x, top + viewTop, MINIMAP_VIEW_COLOR);
+            drawPoint(left + x, top + viewBottom, MINIMAP_VIEW_COLOR);
+        }
+        for (int y = viewTop; y <= viewBottom; y++) {
+            drawPoint(left + viewLeft, top + y, MINIMAP_VIEW_COLOR);
+            drawPoint(left + viewRight, top + y, MINIMAP_VIEW_COLOR);
+        }
+    }
+    
+    // 蛇头（撞墙后可能在地图之外）
+    if (headX < 0 || headY < 0) {
+        return;
+    }
+    int headLeft = minimap.cellToPixelX(headX);
+    int headTop = minimap.cellToPixelY(headY);
+    for (int y = 0; y < minimap.getPixelsPerCell(); y++) {
+        for (int x = 0; x < minimap.getPixelsPerCell(); x++) {
+            if (headLeft + x < width && headTop + y < height) {
+                drawPoint(left + headLeft + x, top + headTop + y, MINIMAP_HEAD_COLOR);
+            }
+        }
+    }
 }
 
 
@@ -510,8 +886,8 @@ void Display::drawGameState(GameState state) {
     drawBmp(12, 20, stateBmp);
     
     // 这里应该使用字体渲染库绘制文字
-    // 由于没有字体渲染库，这里只是简单地在控制台输出状态
-    std::cout << "Game State: " << stateStr << std::endl;
+    // 由于没有字体渲染库，这里只是简单地输出状态（调试级别，默认编译时去掉）
+    LOG_DEBUG("Game State: " << stateStr);
 }
 
 
@@ -523,7 +899,11 @@ void Display::update() {
 // 关闭显示
 void Display::close() {
     if (fbp) {
-        munmap(fbp, screenSize);
+        if (headless) {
+            delete[] fbp;
+        } else {
+            munmap(fbp, screenSize);
+        }
         fbp = nullptr;
     }
     
@@ -546,7 +926,7 @@ void Display::drawBmp(int x, int y, const std::string& bmpPath) {
     try {
         // 检查文件是否存在
         if (access(bmpPath.c_str(), F_OK) == -1) {
-            std::cerr << "Warning: BMP file not found: " << bmpPath << std::endl;
+            LOG_WARN("Warning: BMP file not found: " << bmpPath);
             return;
         }
         
@@ -555,8 +935,9 @@ void Display::drawBmp(int x, int y, const std::string& bmpPath) {
         
         // 使用lcd_draw_bmp绘制BMP图像
         lcd_draw_bmp(fbp, &vinfo, x, y, bmpPath.c_str());
+        Telemetry::add(TelemetryCounter::SPRITE_LOADS);
     } catch (const std::exception& e) {
-        std::cerr << "Error drawing BMP: " << e.what() << " (file: " << bmpPath << ")" << std::endl;
+        LOG_ERROR("Error drawing BMP: " << e.what() << " (file: " << bmpPath << ")");
     }
 }
 
@@ -567,7 +948,7 @@ void Display::drawTransparentBmp(int x, int y, const std::string& bmpPath, unsig
     try {
         // 检查文件是否存在
         if (access(bmpPath.c_str(), F_OK) == -1) {
-            std::cerr << "Warning: BMP file not found: " << bmpPath << std::endl;
+            LOG_WARN("Warning: BMP file not found: " << bmpPath);
             return;
         }
         
@@ -576,8 +957,9 @@ void Display::drawTransparentBmp(int x, int y, const std::string& bmpPath, unsig
         
         // 使用lcd_draw_bmp_transparent绘制带透明背景的BMP图像
         lcd_draw_bmp_transparent(fbp, &vinfo, x, y, bmpPath.c_str(), transparentColor);
+        Telemetry::add(TelemetryCounter::SPRITE_LOADS);
     } catch (const std::exception& e) {
-        std::cerr << "Error drawing transparent BMP: " << e.what() << " (file: " << bmpPath << ")" << std::endl;
+        LOG_ERROR("Error drawing transparent BMP: " << e.what() << " (file: " << bmpPath << ")");
     }
 }
 
@@ -589,39 +971,77 @@ void Display::drawPoint(int x, int y, unsigned int color) {
     lcd_draw_point(fbp, &vinfo, x, y, color);
 }
 
-bool Display::getBmpSize(const std::string& filePath, int* width, int* height) {
-    FILE* fp = fopen(filePath.c_str(), "rb");
-    if (!fp) return false;
-
-    unsigned char header[54];
-    if (fread(header, 1, 54, fp) != 54) {
-        fclose(fp);
-        return false;
+// 生成面板覆盖层
+void Display::buildPanelOverlay(Overlay& overlay, int size, bool playSymbol) {
+    const int edge = 2;
+    overlay.width = size;
+    overlay.height = size;
+    overlay.pixels.assign(static_cast<size_t>(size) * size, PANEL_COLOR);
+    
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            unsigned int& pixel = overlay.pixels[static_cast<size_t>(y) * size + x];
+            if (x < edge || y < edge || x >= size - edge || y >= size - edge) {
+                pixel = PANEL_EDGE_COLOR;
+            } else if (playSymbol) {
+                // 指向右方的三角形，左边在35%处，高度占面板的一半，顶点在70%处
+                int left = size * 35 / 100;
+                int halfHeight = size / 4;
+                int distance = std::abs(y - size / 2);
+                if (x >= left && distance <= halfHeight &&
+                    x - left <= (size * 35 / 100) * (halfHeight - distance) / std::max(1, halfHeight)) {
+                    pixel = RESTART_SYMBOL_COLOR;
+                }
+            } else {
+                // 两条对角线组成的叉，留出四分之一的边距
+                int margin = size / 4;
+                int thickness = std::max(1, size / 20);
+                if (x >= margin && x < size - margin && y >= margin && y < size - margin &&
+                    (std::abs(x - y) <= thickness || std::abs(x + y - (size - 1)) <= thickness)) {
+                    pixel = GAME_OVER_SYMBOL_COLOR;
+                }
+            }
+        }
     }
-
-    *width = *(int*)&header[18];
-    *height = *(int*)&header[22];
-
-    fclose(fp);
-    return true;
 }
 
-void Display::drawGameOver() {
-    if (!fbp) return;
-
-    int bmpWidth = 0, bmpHeight = 0;
-    if (!getBmpSize(game_overBmp, &bmpWidth, &bmpHeight)) {
-        std::cerr << "[Display] Failed to read BMP dimensions." << std::endl;
-        return;
-    }
-
-    int x = (screenWidth - bmpWidth) / 2;
-    int y = (screenHeight - bmpHeight) / 2;
-
+// 合成覆盖层
+void Display::drawOverlay(const Overlay& overlay, int x0, int y0) {
+    if (!fbp || overlay.pixels.empty()) return;
     
-    unsigned int transparentColor = 0xFFFFFFFF; 
+    int bytesPerPixel = getBytesPerPixel();
+    size_t lineBytes = getLineBytes();
+    int columns = static_cast<int>(vinfo.xres_virtual);
+    int rows = static_cast<int>(vinfo.yres_virtual);
+    for (int y = 0; y < overlay.height; y++) {
+        int screenY = y0 + y;
+        if (screenY < 0 || screenY >= rows) {
+            continue;
+        }
+        const unsigned int* source = &overlay.pixels[static_cast<size_t>(y) * overlay.width];
+        char* line = fbp + screenY * lineBytes;
+        for (int x = 0; x < overlay.width; x++) {
+            int screenX = x0 + x;
+            if (screenX < 0 || screenX >= columns || source[x] == TRANSPARENT_COLOR) {
+                continue;
+            }
+            memcpy(line + screenX * bytesPerPixel, &source[x], bytesPerPixel);
+        }
+    }
+}
 
-    drawTransparentBmp(x, y, game_overBmp, transparentColor);
+// 在屏幕中央合成游戏结束画面
+void Display::drawGameOver() {
+    int x = (screenWidth - gameOverOverlay.width) / 2;
+    int y = (screenHeight - gameOverOverlay.height) / 2;
+    drawOverlay(gameOverOverlay, x, y);
+    update();
+}
 
+// 在游戏结束画面下方合成重新开始的提示（屏幕放不下时贴着屏幕底边）
+void Display::drawRestartPrompt() {
+    int x = (screenWidth - restartOverlay.width) / 2;
+    int y = std::min((screenHeight + gameOverOverlay.height) / 2 + cellSize / 2, screenHeight - restartOverlay.height);
+    drawOverlay(restartOverlay, x, y);
     update();
-}
\ No newline at end of file
+}
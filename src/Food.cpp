@@ -1,7 +1,9 @@
 #include "../include/Food.h"
+#include "../include/Level.h"
 #include <iostream>
 #include <random>
 #include <chrono>
+#include <algorithm>
 
 // 创建一个全局的随机数生成器
 namespace {
@@ -24,6 +26,10 @@ Food::Food(int x, int y) : x(x), y(y), type(FoodType::APPLE) {
     initializeRNG();
 }
 
+// 构造指定类型的食物
+Food::Food(int x, int y, FoodType type) : x(x), y(y), type(type) {
+}
+
 // 获取食物的X坐标
 int Food::getX() const {
     return x;
@@ -40,88 +46,85 @@ FoodType Food::getType() const {
 }
 
 // 在地图上随机生成食物
-void Food::generate(const Map& map, const Snake& snake) {
-    int mapWidth = map.getWidth();
-    int mapHeight = map.getHeight();
-    
-    // 获取蛇身体
-    const auto& snakeBody = snake.getBody();
-    
-    // 创建一个可用位置的列表
-    std::vector<std::pair<int, int>> availablePositions;
-    
-    // 遍历地图，找出所有可用位置
-    for (int y = 1; y < mapHeight - 1; y++) {
-        for (int x = 1; x < mapWidth - 1; x++) {
-            // 检查位置是否为空
-            if (map.getElement(x, y) == MapElementType::EMPTY) {
-                // 检查位置是否不在蛇身上
-                bool onSnake = false;
-                for (const auto& segment : snakeBody) {
-                    if (segment.first == x && segment.second == y) {
-                        onSnake = true;
-                        break;
-                    }
-                }
-                
-                if (!onSnake) {
-                    availablePositions.push_back(std::make_pair(x, y));
-                }
-            }
-        }
-    }
+bool Food::generate(const Map& map) {
+    return generate(map, rng);
+}
+
+// 使用指定的随机数生成器生成食物
+bool Food::generate(const Map& map, std::mt19937& rng) {
+    // 默认权重：60%苹果，20%辣椒，15%肉，5%炸弹
+    static const int defaultWeights[4] = {60, 20, 15, 5};
+    return generate(map, rng, defaultWeights);
+}
+
+// 使用指定的随机数生成器和类型权重生成食物
+bool Food::generate(const Map& map, std::mt19937& rng, const int typeWeights[4]) {
+    // 可用位置的数量由地图按行维护（地图上已经标出了蛇和其他食物，不需要再逐节比较蛇身）
+    int available = map.countEmptyInterior();
     
     // 如果没有可用位置，返回
-    if (availablePositions.empty()) {
-        return;
+    if (available == 0) {
+        return false;
     }
     
-    // 随机选择一个可用位置
-    std::uniform_int_distribution<int> positionDist(0, availablePositions.size() - 1);
+    // 随机选择一个可用位置，按行优先顺序找到它（不分配内存，整行和空块直接跳过）
+    std::uniform_int_distribution<int> positionDist(0, available - 1);
     int randomIndex = positionDist(rng);
-    x = availablePositions[randomIndex].first;
-    y = availablePositions[randomIndex].second;
+    if (!map.findEmptyInterior(randomIndex, x, y)) {
+        return false;
+    }
     
-    // 随机生成食物类型
-    std::uniform_int_distribution<int> typeDist(0, 99);
+    chooseType(rng, typeWeights);
+    return true;
+}
+
+// 在关卡的食物区中生成食物
+bool Food::generateInZone(const Map& map, std::mt19937& rng, const int typeWeights[4], const Level& level) {
+    // 食物区的格子按序号直接定位，不需要扫描地图
+    std::uniform_int_distribution<uint32_t> positionDist(0, level.getZoneCellCount() - 1);
+    level.getZoneCell(positionDist(rng), x, y);
+    if (map.getCell(x, y) != MapElementType::EMPTY) {
+        return false;
+    }
+    chooseType(rng, typeWeights);
+    return true;
+}
+
+// 按权重随机选择食物类型
+void Food::chooseType(std::mt19937& rng, const int typeWeights[4]) {
+    // 默认权重之和为100，与原来的百分比相同
+    int totalWeight = typeWeights[0] + typeWeights[1] + typeWeights[2] + typeWeights[3];
+    std::uniform_int_distribution<int> typeDist(0, std::max(totalWeight, 1) - 1);
     int foodTypeRand = typeDist(rng);
-    if (foodTypeRand < 60) {
-        // 60%概率生成苹果
+    if (foodTypeRand < typeWeights[0]) {
         type = FoodType::APPLE;
-    } else if (foodTypeRand < 80) {
-        // 20%概率生成辣椒
+    } else if (foodTypeRand < typeWeights[0] + typeWeights[1]) {
         type = FoodType::PEPPER;
-    } else if (foodTypeRand < 95) {
-        // 15%概率生成肉
+    } else if (foodTypeRand < typeWeights[0] + typeWeights[1] + typeWeights[2]) {
         type = FoodType::MEAT;
     } else {
-        // 5%概率生成炸弹
         type = FoodType::BOMB;
     }
 }
 
-// 在地图上更新食物的位置
-void Food::updateMap(Map& map) const {
+// 食物在地图上对应的元素类型
+MapElementType Food::getMapElement() const {
     // 根据食物类型设置不同的地图元素类型
-    MapElementType elementType;
-    
     switch (type) {
         case FoodType::APPLE:
-            elementType = MapElementType::FOOD_APPLE;
-            break;
+            return MapElementType::FOOD_APPLE;
         case FoodType::PEPPER:
-            elementType = MapElementType::FOOD_PEPPER;
-            break;
+            return MapElementType::FOOD_PEPPER;
         case FoodType::MEAT:
-            elementType = MapElementType::FOOD_MEAT;
-            break;
+            return MapElementType::FOOD_MEAT;
         case FoodType::BOMB:
-            elementType = MapElementType::FOOD_BOMB;
-            break;
+            return MapElementType::FOOD_BOMB;
         default:
-            elementType = MapElementType::FOOD_APPLE;
-            break;
+            return MapElementType::FOOD_APPLE;
     }
-    
-    map.setElement(x, y, elementType);
+}
+
+// 在地图上更新食物的位置
+void Food::updateMap(Map& map) const {
+    map.setElement(x, y, getMapElement());
 }
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "../include/FrameCheck.h"
+#include "../include/Autopilot.h"
+#include "../include/HamiltonianPlayer.h"
+#include "../include/Latency.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // 绘制区域与游戏屏幕相同（800x480，每格40像素），地图更小时只绘制地图
+    const int VIEW_COLUMNS = 20;
+    const int VIEW_ROWS = 12;
+    const int CELL_PIXELS = 40;
+
+    // 一个格子的像素的哈希（每次取8字节，乘法和移位混合）
+    uint64_t hashTile(const char* pixels, size_t lineBytes, size_t tileLineBytes, int lines) {
+        uint64_t hash = 0x9E3779B97F4A7C15ULL;
+        for (int line = 0; line < lines; line++) {
+            const char* row = pixels + line * lineBytes;
+            size_t i = 0;
+            for (; i + sizeof(uint64_t) <= tileLineBytes; i += sizeof(uint64_t)) {
+                uint64_t word;
+                std::memcpy(&word, row + i, sizeof(word));
+                hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+                hash ^= hash >> 29;
+            }
+            for (; i < tileLineBytes; i++) {
+                hash = (hash ^ static_cast<unsigned char>(row[i])) * 0x100000001B3ULL;
+            }
+        }
+        return hash;
+    }
+
+    // 计算整个画面每个格子的哈希
+    void hashFrame(const Display& display, std::vector<uint64_t>& hashes) {
+        int columns = display.getScreenWidth() / display.getCellSize();
+        int rows = display.getScreenHeight() / display.getCellSize();
+        size_t lineBytes = display.getLineBytes();
+        size_t tileLineBytes = static_cast<size_t>(display.getCellSize()) * display.getBytesPerPixel();
+        hashes.resize(static_cast<size_t>(columns) * rows);
+        for (int row = 0; row < rows; row++) {
+            const char* line = display.getFrameBuffer() + row * display.getCellSize() * lineBytes;
+            for (int column = 0; column < columns; column++) {
+                hashes[row * columns + column] =
+                    hashTile(line + column * tileLineBytes, lineBytes, tileLineBytes, display.getCellSize());
+            }
+        }
+    }
+}
+
+// 画面校验
+int runFrameCheck(int frames, uint32_t seed, int mapWidth, int mapHeight, const std::string& resourcePath,
+                  const GameOptions& options) {
+    // 回放时地图尺寸和种子来自录像
+    ReplayReader replay;
+    bool replaying = !options.replayPath.empty();
+    if (replaying) {
+        if (!replay.load(options.replayPath)) {
+            return 1;
+        }
+        mapWidth = replay.getWidth();
+        mapHeight = replay.getHeight();
+        seed = replay.getSeed();
+    } else if (options.player == PlayerKind::SOLVER && !HamiltonianPlayer::cycleExists(mapWidth, mapHeight)) {
+        std::cerr << "No Hamiltonian cycle exists for a " << mapWidth << "x" << mapHeight << " board" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Frame check: " << (replaying ? "replay " + options.replayPath : "scripted game") << " on "
+              << mapWidth << "x" << mapHeight << ", seed " << seed << ", up to " << frames << " frames" << std::endl;
+
+    // 参考绘制和优化绘制各用一块内存帧缓冲区
+    int screenWidth = std::min(mapWidth, VIEW_COLUMNS) * CELL_PIXELS;
+    int screenHeight = std::min(mapHeight, VIEW_ROWS) * CELL_PIXELS;
+    Display reference(screenWidth, screenHeight, CELL_PIXELS);
+    Display optimised(screenWidth, screenHeight, CELL_PIXELS);
+    reference.setReferenceMode(true);
+    Display* displays[2] = {&reference, &optimised};
+    for (Display* display : displays) {
+        if (!display->initializeHeadless() || !display->loadResources(resourcePath)) {
+            std::cerr << "Failed to set up headless display" << std::endl;
+            return 1;
+        }
+        display->setWorldSize(mapWidth, mapHeight);
+        display->setLevel(options.level);
+    }
+
+    Simulation sim(mapWidth, mapHeight, options.rules);
+    sim.setLevel(options.level);
+    sim.reset(seed);
+    Autopilot autopilot;
+    HamiltonianPlayer solver;
+    GameSnapshot snapshot;
+    std::vector<uint64_t> referenceHashes;
+    std::vector<uint64_t> optimisedHashes;
+    int64_t referenceNanos = 0;
+    int64_t optimisedNanos = 0;
+    int columns = screenWidth / CELL_PIXELS;
+
+    // 第0帧是开局画面，之后每个游戏帧画一次
+    int frame = 0;
+    for (; frame < frames; frame++) {
+        if (frame > 0) {
+            if (sim.isGameOver() || (replaying && replay.isComplete() && sim.getTick() >= replay.getFinalTick())) {
+                break;
+            }
+            Direction direction;
+            if (replaying) {
+                if (replay.takeTurn(sim.getTick() + 1, direction)) {
+                    sim.turn(direction);
+                }
+            } else {
+                sim.turn(options.player == PlayerKind::SOLVER ? solver.chooseDirection(sim)
+                                                              : autopilot.chooseDirection(sim));
+            }
+            sim.step();
+        }
+        snapshot.capture(sim);
+
+        int64_t start = monotonicNanos();
+        reference.drawFrame(snapshot);
+        int64_t middle = monotonicNanos();
+        optimised.drawFrame(snapshot);
+        int64_t end = monotonicNanos();
+        referenceNanos += middle - start;
+        optimisedNanos += end - middle;
+
+        hashFrame(reference, referenceHashes);
+        hashFrame(optimised, optimisedHashes);
+        if (referenceHashes == optimisedHashes) {
+            continue;
+        }
+
+        // 报告第一个不同的格子（屏幕格子和对应的地图格子）以及这一帧不同的格子数
+        size_t differing = 0;
+        size_t first = 0;
+        for (size_t i = 0; i < referenceHashes.size(); i++) {
+            if (referenceHashes[i] != optimisedHashes[i]) {
+                if (differing++ == 0) {
+                    first = i;
+                }
+            }
+        }
+        int column = static_cast<int>(first % columns);
+        int row = static_cast<int>(first / columns);
+        const Camera& camera = optimised.getCamera();
+        std::cerr << "Frame " << frame << " (tick " << sim.getTick() << ") differs: first at screen cell (" << column
+                  << ", " << row << "), map cell (" << camera.getX() + column << ", " << camera.getY() + row
+                  << "), " << differing << " of " << referenceHashes.size() << " cells differ" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Verified " << frame << " frames, " << referenceHashes.size() << " cells per frame, all identical"
+              << std::endl;
+    if (frame > 0) {
+        std::cout << "Draw time per frame: reference " << referenceNanos / frame / 1000 << " us, optimised "
+                  << optimisedNanos / frame / 1000 << " us" << std::endl;
+    }
+    return 0;
+}
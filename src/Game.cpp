@@ -1,26 +1,103 @@
 #include "../include/Game.h"
+#include "../include/Telemetry.h"
+#include "../include/Trace.h"
+#include "../include/ThreadStats.h"
+#include "../include/Log.h"
 #include <iostream>
 #include <chrono>
 #include <thread>
-#include <fcntl.h>  // 添加fcntl.h头文件，因为inputLoop中使用了fcntl函数
-#include <unistd.h> // 添加unistd.h头文件，因为STDIN_FILENO在这个头文件中定义
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+
+namespace {
+    // 小地图最大占屏幕宽高的五分之一（800x480的屏幕上最大160x96像素）
+    const int MINIMAP_SCREEN_FRACTION = 5;
+    
+    // 设置定时器，periodic为true时按相同间隔重复触发
+    void armTimer(int fd, int intervalMs, bool periodic) {
+        struct itimerspec spec;
+        std::memset(&spec, 0, sizeof(spec));
+        spec.it_value.tv_sec = intervalMs / 1000;
+        spec.it_value.tv_nsec = (intervalMs % 1000) * 1000000L;
+        if (periodic) {
+            spec.it_interval = spec.it_value;
+        }
+        timerfd_settime(fd, 0, &spec, nullptr);
+    }
+    
+    // 设置单次触发的定时器在绝对时间（CLOCK_MONOTONIC纳秒）触发，时间已过时立即触发，为0时取消定时器
+    void armTimerAt(int fd, int64_t deadlineNanos) {
+        struct itimerspec spec;
+        std::memset(&spec, 0, sizeof(spec));
+        spec.it_value.tv_sec = static_cast<time_t>(deadlineNanos / 1000000000LL);
+        spec.it_value.tv_nsec = static_cast<long>(deadlineNanos % 1000000000LL);
+        timerfd_settime(fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+    }
+    
+    // 毫秒转换为纳秒
+    int64_t millisToNanos(int ms) {
+        return static_cast<int64_t>(ms) * 1000000LL;
+    }
+    
+    // 游戏结束之后的处理方式：回放结束时退出，自动玩家开始下一局，玩家自己玩时提示重新开始
+    GameOverPolicy gameOverPolicy(const GameOptions& options) {
+        if (!options.replayPath.empty()) {
+            return GameOverPolicy::EXIT;
+        }
+        if (options.player != PlayerKind::HUMAN) {
+            return GameOverPolicy::AUTO_RESTART;
+        }
+        return GameOverPolicy::PROMPT;
+    }
+    
+    // 将fd加入事件循环的epoll
+    bool addLoopFd(int epollFd, int fd) {
+        struct epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) == 0;
+    }
+}
 
 // 构造函数
-Game::Game(int width, int height, int cellSize, const std::string& resourcePath)
+Game::Game(int width, int height, int cellSize, const std::string& resourcePath, const GameOptions& options)
     : state(GameState::PAUSED),
-      map(width / cellSize, height / cellSize),
-      snake(width / (2 * cellSize), height / (2 * cellSize)),
+      sim(options.mapWidth > 0 ? options.mapWidth : width / cellSize,
+          options.mapHeight > 0 ? options.mapHeight : height / cellSize, options.rules),
       display(width, height, cellSize),
-      input(),
+      input(width, height),
+      pendingTurnHead(0),
+      pendingTurnCount(0),
+      turnSerial(0),
+      turnEventTime(0),
+      turnTickTime(0),
+      presentedTurnSerial(0),
+      minimapTick(0),
+      minimapGeneration(0),
+      minimapValid(false),
+      renderedTick(0),
+      replaying(false),
+      mctsPlayer(options.mcts),
+      autopilotActive(options.player != PlayerKind::HUMAN),
+      scheduler(options.tickPolicy),
+      tickAllocations("tick", ALLOCATION_WARMUP),
+      frameAllocations("frame", ALLOCATION_WARMUP),
+      options(options),
+      startTime(0),
       screenWidth(width),
       screenHeight(height),
       cellSize(cellSize),
-      gameSpeed(300),
-      originalGameSpeed(300),
-      pepperEffectActive(false),
       resourcePath(resourcePath),
-      isGameOverDrawn(false) {  // 显式初始化
-    std::srand(std::time(nullptr));
+      ui(gameOverPolicy(options)),
+      uiEventFd(-1),
+      overlayState(UiState::RUNNING) {
 }
 
 // 析构函数
@@ -28,43 +105,109 @@ Game::~Game() {
     // 确保所有线程已经结束
     exit();
     waitForThreads();
+    
+    if (uiEventFd != -1) {
+        ::close(uiEventFd);
+        uiEventFd = -1;
+    }
 }
 
 // 初始化游戏
 bool Game::initialize() {
+    sim.setLevel(options.level);
+    
+    if (options.player == PlayerKind::SOLVER &&
+        !HamiltonianPlayer::cycleExists(sim.getMap().getWidth(), sim.getMap().getHeight())) {
+        LOG_ERROR("No Hamiltonian cycle exists for a " << sim.getMap().getWidth() << "x"
+                  << sim.getMap().getHeight() << " board");
+        return false;
+    }
+    
     // 初始化显示
-    if (!display.initialize()) {
-        std::cerr << "Failed to initialize display" << std::endl;
+    bool displayReady = options.headless ? display.initializeHeadless() : display.initialize();
+    if (!displayReady) {
+        LOG_ERROR("Failed to initialize display");
         return false;
     }
     
     // 加载资源 - 使用构造函数中传入的resourcePath，而不是硬编码的"resources"
     if (!display.loadResources(resourcePath)) {
-        std::cerr << "Failed to load resources" << std::endl;
+        LOG_ERROR("Failed to load resources");
         return false;
     }
     
+    // 地图大于屏幕时由摄像机跟随蛇头滚动，并在右下角显示小地图
+    int worldWidth = sim.getMap().getWidth();
+    int worldHeight = sim.getMap().getHeight();
+    display.setWorldSize(worldWidth, worldHeight);
+    display.setLevel(options.level);
+    if (worldWidth * cellSize > screenWidth || worldHeight * cellSize > screenHeight) {
+        minimap.configure(worldWidth, worldHeight, screenWidth / MINIMAP_SCREEN_FRACTION,
+                          screenHeight / MINIMAP_SCREEN_FRACTION);
+        if (options.level) {
+            minimap.setWalls(*options.level);
+        }
+        minimapValid = false;
+    }
+    
     // 初始化输入
-    if (!input.initialize()) {
-        std::cerr << "Failed to initialize input" << std::endl;
+    if (!input.initialize(options.probeInputDevices)) {
+        LOG_ERROR("Failed to initialize input");
         return false;
     } else {
-        std::cout << "Input device: initialized" << std::endl;
+        LOG_INFO("Input device: initialized");
         
-        // 启动触屏输入线程
-        std::thread* inputThread = input.startInputThread();
-        if (inputThread) {
-            inputThread->detach();  // 分离线程，使其独立运行
+        // 输入线程收到事件后直接回调，不再经过轮询循环
+        input.setEventHandler([this](const InputEvent& event) { onInputEvent(event); });
+    }
+    
+    // 回放时使用录像中的种子，保证结果一致
+    uint32_t seed = chooseSeed();
+    if (!options.replayPath.empty()) {
+        if (!replayReader.load(options.replayPath)) {
+            return false;
+        }
+        if (replayReader.getWidth() != sim.getMap().getWidth() || replayReader.getHeight() != sim.getMap().getHeight()) {
+            LOG_ERROR("Replay map size " << replayReader.getWidth() << "x" << replayReader.getHeight()
+                      << " does not match the screen");
+            return false;
         }
+        seed = replayReader.getSeed();
+        replaying = true;
+        LOG_INFO("Replaying " << options.replayPath << " (" << replayReader.getTurnCount() << " turns)");
     }
     
-    // 生成初始食物
-    generateFood();
+    PROFILED_LOCK(lock, gameMutex);
+    
+    // 从检查点恢复上一次的游戏（回放和录制都需要从头开始的一局，不恢复）
+    bool resumed = false;
+    if (!options.checkpointPath.empty() && !replaying) {
+        int64_t loadStart = monotonicNanos();
+        if (checkpoint.open(options.checkpointPath, sim.getMap().getWidth(), sim.getMap().getHeight()) &&
+            options.recordPath.empty() && checkpoint.load(sim) && !sim.isGameOver()) {
+            resumed = true;
+            LOG_INFO("Resumed from checkpoint at tick " << sim.getTick() << ", length "
+                     << sim.getSnake().getLength() << " in "
+                     << (monotonicNanos() - loadStart) / 1000 << " us");
+        }
+    }
     
-    // 更新地图
-    updateMap();
+    // 生成初始的蛇和食物
+    if (!resumed) {
+        sim.reset(seed);
+        checkpoint.save(sim);
+    }
     
-    std::cout << "Game initialized successfully!" << std::endl;
+    if (!options.recordPath.empty()) {
+        if (!replayWriter.open(options.recordPath, sim.getMap().getWidth(), sim.getMap().getHeight(), seed)) {
+            return false;
+        }
+        LOG_INFO("Recording to " << options.recordPath << " (seed " << seed << ")");
+    }
+    
+    publishSnapshot();
+    
+    LOG_INFO("Game initialized successfully!");
     return true;
 }
 
@@ -75,56 +218,148 @@ void Game::start() {
         return;
     }
     
+    // 事件循环通过eventfd得知其他线程改变了游戏状态（继续、重新开始、退出）
+    if (options.runtime == RuntimeMode::EVENT_LOOP && uiEventFd == -1) {
+        uiEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (uiEventFd == -1) {
+            LOG_WARN("Failed to create UI eventfd: " << strerror(errno));
+        }
+    }
+    
     // 设置游戏状态为运行
-    state = GameState::RUNNING;
+    setState(GameState::RUNNING);
+    
+    startTime = monotonicNanos();
+    if (options.watchdogMs > 0) {
+        watchdog.start(millisToNanos(options.watchdogMs), options.watchdogDumpPath);
+    }
+    
+    if (options.runtime == RuntimeMode::EVENT_LOOP) {
+        // 单线程模式：游戏、渲染和输入都在同一个事件循环中处理
+        gameThread = std::thread(&Game::eventLoop, this);
+        ThreadStats::sample();
+        return;
+    }
     
     // 启动游戏线程
     gameThread = std::thread(&Game::gameLoop, this);
     renderThread = std::thread(&Game::renderLoop, this);
-    inputThread = std::thread(&Game::inputLoop, this);
+    input.startInputThread();
+    
+    // 第一次采样，之后的统计从各线程开始运行时算起
+    ThreadStats::sample();
 }
 
 // 暂停游戏
 void Game::pause() {
     if (state == GameState::RUNNING) {
-        state = GameState::PAUSED;
+        setState(GameState::PAUSED);
     }
 }
 
 // 继续游戏
 void Game::resume() {
     if (state == GameState::PAUSED) {
-        state = GameState::RUNNING;
+        setState(GameState::RUNNING);
     }
 }
 
 // 结束游戏
 void Game::exit() {
     state = GameState::EXIT;
+    notifyUi();
+}
+
+// 设置游戏状态并通知界面状态机
+void Game::setState(GameState next) {
+    state = next;
+    {
+        std::lock_guard<std::mutex> lock(uiMutex);
+        if (next == GameState::RUNNING) {
+            ui.onRunning();
+        } else if (next == GameState::PAUSED) {
+            ui.onPaused();
+        }
+    }
+    notifyUi();
+}
+
+// 唤醒等待状态改变或界面截止时间的线程
+void Game::notifyUi() {
+    // 经过uiMutex之后再通知：等待者在uiMutex内检查条件并开始等待，不会错过这次通知
+    {
+        std::lock_guard<std::mutex> lock(uiMutex);
+    }
+    uiChanged.notify_all();
+    if (uiEventFd != -1) {
+        uint64_t one = 1;
+        ssize_t written = write(uiEventFd, &one, sizeof(one));
+        (void)written;
+    }
 }
 
 // 重置游戏
 void Game::reset() {
-    // 确保游戏已经停止
-    if (state == GameState::RUNNING) {
-        pause();
+    // 确保游戏已经停止，结束的游戏重置后可以继续
+    GameState current = state;
+    if (current == GameState::RUNNING || current == GameState::GAME_OVER) {
+        setState(GameState::PAUSED);
     }
     
-    // 重置蛇
-    snake = Snake(map.getWidth() / 2, map.getHeight() / 2);
+    // 丢弃上一局残留的转向
+    {
+        PROFILED_LOCK(lock, turnMutex);
+        pendingTurnHead = 0;
+        pendingTurnCount = 0;
+    }
     
-    // 清空食物列表
-    foods.clear();
+    int64_t waitStart = monotonicNanos();
+    PROFILED_LOCK(lock, gameMutex);
+    int64_t lockedAt = monotonicNanos();
+    Telemetry::add(TelemetryCounter::MUTEX_WAIT_NANOS, lockedAt - waitStart);
+    TRACE_COMPLETE("wait gameMutex", waitStart, lockedAt);
     
-    // 重新生成食物
-    generateFood();
+    // 录像只包含一局，重置时结束录制
+    finishRecording();
     
-    // 更新地图
-    updateMap();
+    // 重新生成蛇和食物，回放时从头开始
+    if (replaying) {
+        replayReader.rewind();
+        sim.reset(replayReader.getSeed());
+    } else {
+        sim.reset(chooseSeed());
+    }
+    autopilot.reset();
+    checkpoint.save(sim);
+    publishSnapshot();
+}
+
+// 重置并开始新的一局
+void Game::restart() {
+    reset();
+    resume();
+}
+
+// 为新的一局选择随机种子
+uint32_t Game::chooseSeed() const {
+    if (options.seed != 0) {
+        return options.seed;
+    }
+    return static_cast<uint32_t>(std::chrono::system_clock::now().time_since_epoch().count());
+}
+
+// 写入录像结束标记
+void Game::finishRecording() {
+    if (replayWriter.isOpen()) {
+        replayWriter.finish(sim.getTick(), sim.getSnake().getLength());
+    }
 }
 
 // 等待所有线程结束
 void Game::waitForThreads() {
+    // 线程退出时不再有游戏帧和渲染帧，先停止监视
+    watchdog.stop();
+    
     if (gameThread.joinable()) {
         gameThread.join();
     }
@@ -133,9 +368,13 @@ void Game::waitForThreads() {
         renderThread.join();
     }
     
-    if (inputThread.joinable()) {
-        inputThread.join();
-    }
+    input.stopInputThread();
+    
+    // 最后一次采样仍在运行的线程（主线程、MCTS线程），已退出的线程在退出前采样了自己
+    ThreadStats::sample();
+    
+    // 所有线程已结束，可以安全地写入录像结束标记
+    finishRecording();
 }
 
 // 获取当前游戏状态
@@ -143,60 +382,292 @@ GameState Game::getState() const {
     return state;
 }
 
-// 游戏主循环
-void Game::gameLoop() {
-    // 记录上一次蛇头位置，用于调试
-    std::pair<int, int> lastHeadPos = snake.getHead();
-    int moveCount = 0;
+// 执行一个游戏帧：应用转向、推进模拟并发布快照
+int Game::tick() {
+    // 获取锁，确保在更新时不会有其他线程修改游戏状态
+    int64_t waitStart = monotonicNanos();
+    PROFILED_LOCK(lock, gameMutex);
+    int64_t lockedAt = monotonicNanos();
+    Telemetry::add(TelemetryCounter::MUTEX_WAIT_NANOS, lockedAt - waitStart);
+    TRACE_COMPLETE("wait gameMutex", waitStart, lockedAt);
+    
+    // 转向在执行该帧之前应用，录像中的帧号即为该帧
+    uint64_t nextTick = sim.getTick() + 1;
+    if (replaying) {
+        Direction direction;
+        if (replayReader.takeTurn(nextTick, direction)) {
+            sim.turn(direction);
+        }
+    } else if (autopilotActive) {
+        // 自动驾驶的转向同样写入录像，便于复现稳定性测试中的问题
+        TRACE_SPAN("plan");
+        int64_t planStart = monotonicNanos();
+        Direction direction;
+        if (options.player == PlayerKind::SOLVER) {
+            direction = solver.chooseDirection(sim);
+        } else if (options.player == PlayerKind::MCTS) {
+            direction = mctsPlayer.chooseDirection(sim);
+        } else {
+            direction = autopilot.chooseDirection(sim);
+        }
+        plannerTime.record(monotonicNanos() - planStart);
+        if (sim.turn(direction)) {
+            replayWriter.recordTurn(nextTick, direction);
+        }
+    } else {
+        applyPendingTurn(nextTick);
+    }
     
+    // 推进一个游戏帧（移动、碰撞检测和地图更新）
+    {
+        TRACE_SPAN("step");
+        sim.step();
+    }
+    Telemetry::add(TelemetryCounter::TICKS);
+    Telemetry::set(TelemetryCounter::SNAKE_LENGTH, sim.getSnake().getLength());
+    Telemetry::set(TelemetryCounter::SCORE, sim.getScore());
+    
+    // 录像中的会话在这一帧结束（例如录制时玩家主动退出）
+    bool replayEnded = replaying && replayReader.isComplete() && sim.getTick() >= replayReader.getFinalTick();
+    
+    if (sim.isGameOver() || replayEnded) {
+        LOG_INFO("Game over after " << sim.getTick() << " ticks, length "
+                 << sim.getSnake().getLength());
+        state = GameState::GAME_OVER;
+        {
+            // 结束画面的超时由游戏线程（或事件循环）在截止时间处理，这里不等待
+            std::lock_guard<std::mutex> uiLock(uiMutex);
+            ui.onGameOver(monotonicNanos());
+        }
+        finishRecording();
+    }
+    
+    // 在帧边界保存检查点（只写映射的内存，由内核在后台回写）
+    if (checkpoint.isOpen()) {
+        TRACE_SPAN("checkpoint");
+        checkpoint.save(sim);
+    }
+    
+    // 状态完整，发布给渲染线程
+    publishSnapshot();
+    
+    return sim.getGameSpeed();
+}
+
+// 游戏主循环（多线程模式）
+// 每帧等到调度器的绝对截止时间，帧的耗时不会累积到节拍中；游戏结束画面由渲染线程绘制，
+// 结束画面的超时（提示、自动开始下一局、退出）由这里在截止时间交给界面状态机
+void Game::gameLoop() {
+    ThreadStats::nameThread("game");
+    bool scheduled = false;
     while (state != GameState::EXIT) {
-        // 如果游戏暂停，等待
-        if (state == GameState::PAUSED) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        // 如果游戏暂停或已结束，等待状态改变或界面超时，不再轮询
+        if (state == GameState::PAUSED || state == GameState::GAME_OVER) {
+            scheduled = false;
+            watchdog.disarm(WatchdogChannel::TICK);
+            waitForUiEvent();
             continue;
         }
         
-        if (state == GameState::GAME_OVER) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        // 开局或继续时重新对齐节拍，不追赶暂停的时间
+        if (!scheduled) {
+            int speed;
+            {
+                PROFILED_LOCK(lock, gameMutex);
+                speed = sim.getGameSpeed();
+            }
+            int64_t now = monotonicNanos();
+            scheduler.start(now, millisToNanos(speed));
+            watchdog.arm(WatchdogChannel::TICK, now, scheduler.getPeriod());
+            scheduled = true;
+        }
+        {
+            TRACE_SPAN("sleep");
+            scheduler.sleepUntilDeadline();
+        }
+        if (state != GameState::RUNNING) {
             continue;
         }
         
-        // 更新游戏状态
-        update();
-        
-        // 检查蛇是否撞到墙
-        if (snake.checkCollisionWithWall(map.getWidth(), map.getHeight())) {
-            state = GameState::GAME_OVER;
-            display.drawGameOver();  // 直接调用绘制
-            display.update();
-        }
-        // 处理碰撞（包括蛇与自身的碰撞和食物碰撞）
-        handleCollisions();
-        
-        // 立即检查蛇是否碰撞，如果碰撞立即停止
-        if (state == GameState::GAME_OVER) {
-            // 直接绘制游戏结束画面
-            display.drawGameOver();
-            display.update();
-            
-            // 等待3秒让玩家看到游戏结束画面
-            std::this_thread::sleep_for(std::chrono::seconds(3));
+        scheduledTick();
+    }
+    ThreadStats::sampleCurrentThread();
+}
+
+// 等待状态改变或界面超时
+void Game::waitForUiEvent() {
+    UiAction action = UiAction::NONE;
+    {
+        TRACE_SPAN("wait ui");
+        std::unique_lock<std::mutex> lock(uiMutex);
+        while (state == GameState::PAUSED || state == GameState::GAME_OVER) {
+            int64_t deadline = ui.getDeadline();
+            if (deadline == 0) {
+                uiChanged.wait(lock);
+                continue;
+            }
+            int64_t now = monotonicNanos();
+            if (now >= deadline) {
+                action = ui.onTimeout(now);
+                break;
+            }
+            uiChanged.wait_for(lock, std::chrono::nanoseconds(deadline - now));
         }
-        
-        // 更新地图
-        updateMap();
-        
-        // 控制游戏速度
-        std::this_thread::sleep_for(std::chrono::milliseconds(gameSpeed));
+    }
+    dispatchUiAction(action);
+}
+
+// 界面截止时间到达
+void Game::handleUiTimeout() {
+    UiAction action;
+    {
+        std::lock_guard<std::mutex> lock(uiMutex);
+        action = ui.onTimeout(monotonicNanos());
+    }
+    dispatchUiAction(action);
+}
+
+// 执行状态机要求的动作
+void Game::dispatchUiAction(UiAction action) {
+    switch (action) {
+        case UiAction::SHOW_RESTART_PROMPT:
+            // 提示由渲染线程按界面状态合成
+            LOG_INFO("Game over, tap or press a key to play again");
+            break;
+        case UiAction::RESTART:
+            if (ui.getPolicy() == GameOverPolicy::AUTO_RESTART) {
+                // 演示模式中被接管的一局结束后也交还给自动驾驶
+                LOG_INFO("Game Over! Restarting...");
+                autopilotActive = true;
+            } else {
+                LOG_INFO("Player restarted the game");
+            }
+            restart();
+            break;
+        case UiAction::EXIT:
+            LOG_INFO("Replay finished! Exiting...");
+            exit();
+            break;
+        default:
+            break;
+    }
+}
+
+// 在调度器的截止时间执行一个游戏帧并计算下一帧的截止时间
+void Game::scheduledTick() {
+    TRACE_SPAN("tick");
+    AllocationScope allocationScope(tickAllocations);
+    // 速度改变（辣椒、蛇变长）时新周期从本帧的截止时间算起
+    int64_t now = monotonicNanos();
+    scheduler.beginTick(now);
+    int delay = tick();
+    scheduler.setPeriod(millisToNanos(delay));
+    watchdog.beat(WatchdogChannel::TICK, now, scheduler.getPeriod());
+    scheduler.advance(monotonicNanos());
+    Telemetry::set(TelemetryCounter::MISSED_DEADLINES, scheduler.getMissedDeadlines());
+}
+
+// 绘制一帧
+void Game::renderFrame() {
+    TRACE_SPAN("render frame");
+    AllocationScope allocationScope(frameAllocations);
+    watchdog.beat(WatchdogChannel::FRAME, monotonicNanos(), millisToNanos(1000 / TARGET_FPS));
+    // 取最新发布的快照，渲染期间不持有gameMutex，游戏帧不会被绘制耗时阻塞
+    snapshots.fetch();
+    const GameSnapshot& snapshot = snapshots.getReadBuffer();
+    
+    // 游戏结束画面已经合成，保持到新的一局发布快照（不再重画）；提示出现时只叠加一次提示
+    UiState uiState = ui.getState();
+    if (snapshot.state == GameState::GAME_OVER && overlayState != UiState::RUNNING) {
+        if (uiState == UiState::RESTART_PROMPT && overlayState != UiState::RESTART_PROMPT) {
+            display.drawRestartPrompt();
+            overlayState = UiState::RESTART_PROMPT;
+        }
+        return;
+    }
+    
+    // 渲染落后时中间的游戏帧没有画出（新的一局帧号从头开始，不算跳过）
+    if (snapshot.tick > renderedTick + 1) {
+        Telemetry::add(TelemetryCounter::FRAMES_SKIPPED, snapshot.tick - renderedTick - 1);
+    }
+    renderedTick = snapshot.tick;
+    
+    // 避免每帧都清空屏幕，利用Display类的背景缓存机制
+    display.drawFrame(snapshot);
+    
+    // 小地图覆盖在游戏画面之上
+    if (minimap.isConfigured()) {
+        TRACE_SPAN("minimap");
+        updateMinimap(snapshot);
+        if (!snapshot.body.empty()) {
+            display.drawMinimap(minimap, snapshot.body[0].first, snapshot.body[0].second);
+        }
+    }
+    display.update();
+    Telemetry::add(TelemetryCounter::FRAMES_RENDERED);
+    
+    // 这一帧第一次显示了最近应用的转向
+    if (snapshot.turnSerial != presentedTurnSerial) {
+        int64_t presentTime = monotonicNanos();
+        latency.record(LatencyStage::TICK_TO_PRESENT, presentTime - snapshot.turnTickTime);
+        latency.record(LatencyStage::END_TO_END, presentTime - snapshot.turnEventTime);
+        presentedTurnSerial = snapshot.turnSerial;
+    }
+    
+    // 如果游戏结束，在最后一帧上合成游戏结束画面（重新开始后允许再次合成）
+    if (snapshot.state != GameState::GAME_OVER) {
+        overlayState = UiState::RUNNING;
+    } else {
+        display.drawGameOver();
+        overlayState = UiState::GAME_OVER;
+        if (uiState == UiState::RESTART_PROMPT) {
+            display.drawRestartPrompt();
+            overlayState = UiState::RESTART_PROMPT;
         }
+    }
 }
 
+// 按快照更新小地图
+void Game::updateMinimap(const GameSnapshot& snapshot) {
+    if (minimapValid && snapshot.mapGeneration == minimapGeneration) {
+        if (snapshot.tick == minimapTick) {
+            // 同一帧重复发布（例如暂停），没有变化
+            return;
+        }
+        if (snapshot.tick == minimapTick + 1) {
+            for (const auto& change : snapshot.mapChanges) {
+                minimap.applyChange(change);
+            }
+            minimapTick = snapshot.tick;
+            return;
+        }
+    }
+    
+    // 渲染跳过了某些帧，或者开始了新的一局：从蛇和食物重新生成（与蛇长有关，与地图大小无关）
+    minimap.clear();
+    for (const auto& food : snapshot.foods) {
+        minimap.addCell(food.getX(), food.getY(), food.getMapElement());
+    }
+    for (size_t i = 0; i < snapshot.body.size(); i++) {
+        minimap.addCell(snapshot.body[i].first, snapshot.body[i].second,
+                        i == 0 ? MapElementType::SNAKE_HEAD : MapElementType::SNAKE_BODY);
+    }
+    for (const auto& rivalBody : snapshot.rivalBodies) {
+        for (size_t i = 0; i < rivalBody.size(); i++) {
+            minimap.addCell(rivalBody[i].first, rivalBody[i].second,
+                            i == 0 ? MapElementType::SNAKE_HEAD : MapElementType::SNAKE_BODY);
+        }
+    }
+    minimapTick = snapshot.tick;
+    minimapGeneration = snapshot.mapGeneration;
+    minimapValid = true;
+}
 
-// 渲染循环
+// 渲染循环（多线程模式）
 void Game::renderLoop() {
+    ThreadStats::nameThread("render");
     // 帧率控制
-    const int targetFPS = 15; // 降低帧率，减少闪烁
-    const std::chrono::milliseconds frameTime(1000 / targetFPS);
+    const std::chrono::milliseconds frameTime(1000 / TARGET_FPS);
     std::chrono::steady_clock::time_point lastFrameTime = std::chrono::steady_clock::now();
     
     while (state != GameState::EXIT) {
@@ -206,6 +677,7 @@ void Game::renderLoop() {
         
         // 如果距离上一帧时间不足，等待
         if (elapsedTime < frameTime) {
+            TRACE_SPAN("sleep");
             std::this_thread::sleep_for(frameTime - elapsedTime);
             continue;
         }
@@ -213,358 +685,275 @@ void Game::renderLoop() {
         // 更新上一帧时间
         lastFrameTime = std::chrono::steady_clock::now();
         
-        // 获取锁，确保在渲染时不会修改游戏状态
-        std::lock_guard<std::mutex> lock(gameMutex);
-        
-        // 避免每帧都清空屏幕，利用Display类的背景缓存机制
-        
-        // 绘制地图（这会利用背景缓存）
-        display.drawMap(&map);
-        
-        // 绘制所有食物
-        for (const auto& foodWithLifetime : foods) {
-            display.drawFood(&(foodWithLifetime.food));
-        }
-        
-        // 绘制蛇（最后绘制蛇，确保蛇覆盖在其他元素上方）
-        display.drawSnake(&snake);
-        
-        // 如果游戏结束，绘制游戏结束状态
-        if (state == GameState::GAME_OVER && !isGameOverDrawn) {
-            display.drawGameOver();
-            isGameOverDrawn = true;
-            std::this_thread::sleep_for(std::chrono::seconds(5));
-        }
+        renderFrame();
     }
+    ThreadStats::sampleCurrentThread();
 }
 
-// 输入处理循环
-void Game::inputLoop() {
-    Direction lastProcessedDirection = snake.getDirection();
-    bool directionChangedThisCycle = false;
-    InputEvent event;
+// 单线程事件循环：游戏帧由timerfd驱动，输入由fd就绪驱动，渲染由帧率timerfd驱动，
+// 界面超时由单次触发的timerfd驱动，其他线程改变游戏状态时通过eventfd唤醒
+void Game::eventLoop() {
+    ThreadStats::nameThread("event-loop");
+    int loopFd = epoll_create1(EPOLL_CLOEXEC);
+    int tickFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    int frameFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    int uiTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    
+    if (loopFd == -1 || tickFd == -1 || frameFd == -1 || uiTimerFd == -1 || uiEventFd == -1 ||
+        !addLoopFd(loopFd, tickFd) || !addLoopFd(loopFd, frameFd) || !addLoopFd(loopFd, uiTimerFd) ||
+        !addLoopFd(loopFd, uiEventFd) || !addLoopFd(loopFd, input.getPollFd())) {
+        LOG_ERROR("Failed to set up event loop: " << strerror(errno));
+        if (loopFd != -1) ::close(loopFd);
+        if (tickFd != -1) ::close(tickFd);
+        if (frameFd != -1) ::close(frameFd);
+        if (uiTimerFd != -1) ::close(uiTimerFd);
+        state = GameState::EXIT;
+        return;
+    }
     
+    // 游戏帧定时器在调度器的绝对截止时间单次触发，每帧后设置下一帧的截止时间（速度会随长度和辣椒效果变化）
+    bool scheduled = true;
+    {
+        PROFILED_LOCK(lock, gameMutex);
+        int64_t now = monotonicNanos();
+        scheduler.start(now, millisToNanos(sim.getGameSpeed()));
+        watchdog.arm(WatchdogChannel::TICK, now, scheduler.getPeriod());
+    }
+    armTimerAt(tickFd, scheduler.getDeadline());
+    armTimer(frameFd, 1000 / TARGET_FPS, true);
+    
+    // 界面定时器当前设置的截止时间（0表示未设置）
+    int64_t uiTimerDeadline = 0;
+    
+    struct epoll_event ready[8];
     while (state != GameState::EXIT) {
-        // 处理键盘输入
-        input.processKeyboardInput();
-        
-        // 处理触屏输入
-        if (input.getEvent(event)) {
-            // 如果是移动事件，转换为方向
-            if (event.type == InputEventType::TOUCH_MOVE) {
-                Direction touchDirection = input.convertEventToDirection(event, snake.getDirection());
-                input.setDirection(touchDirection);
+        int count;
+        {
+            TRACE_SPAN("wait");
+            count = epoll_wait(loopFd, ready, 8, -1);
+        }
+        if (count == -1) {
+            if (errno == EINTR) {
+                continue;
             }
+            LOG_ERROR("Error waiting in event loop: " << strerror(errno));
+            break;
         }
         
-        // 获取新的方向
-        Direction newDirection = input.getDirection();
-        
-        // 检查是否有新的输入
-        if (input.hasNewInput()) {
-            // 获取锁，确保在处理输入时不会更新游戏状态
-            std::lock_guard<std::mutex> lock(gameMutex);
+        for (int i = 0; i < count; i++) {
+            int fd = ready[i].data.fd;
+            uint64_t expirations;
             
-            // 只有当方向发生变化，且本周期内未改变过方向时才改变蛇的方向
-            if (newDirection != lastProcessedDirection && !directionChangedThisCycle) {
-                // 改变蛇的方向
-                snake.changeDirection(newDirection);
-                
-                // 更新上一次处理的方向
-                lastProcessedDirection = newDirection;
-                
-                // 标记本周期已改变方向
-                directionChangedThisCycle = true;
+            if (fd == tickFd) {
+                if (read(tickFd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+                    continue;
+                }
+                if (state == GameState::RUNNING) {
+                    scheduledTick();
+                }
+                // 暂停或结束后不再触发（不轮询），继续或开始新的一局时在下面重新对齐节拍
+                if (state == GameState::RUNNING) {
+                    armTimerAt(tickFd, scheduler.getDeadline());
+                } else {
+                    scheduled = false;
+                    watchdog.disarm(WatchdogChannel::TICK);
+                }
+            } else if (fd == frameFd) {
+                if (read(frameFd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+                    continue;
+                }
+                renderFrame();
+            } else if (fd == uiTimerFd) {
+                if (read(uiTimerFd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+                    continue;
+                }
+                uiTimerDeadline = 0;
+                handleUiTimeout();
+            } else if (fd == uiEventFd) {
+                // 只用于唤醒，状态在下面统一检查
+                uint64_t notifications;
+                if (read(uiEventFd, &notifications, sizeof(notifications)) != sizeof(notifications)) {
+                    continue;
+                }
+            } else {
+                // 输入就绪，处理所有已到达的事件但不阻塞
+                input.pollEvents(0);
             }
-            
-            // 清除新输入标记
-            input.clearNewInput();
         }
         
-        // 在每个游戏帧开始时重置方向改变标记
-        if (state == GameState::RUNNING) {
-            // 获取锁
-            std::lock_guard<std::mutex> lock(gameMutex);
-            directionChangedThisCycle = false;
+        // 继续或开始新的一局（可能来自输入、界面超时或其他线程）之后重新对齐节拍，不追赶暂停的时间
+        if (state == GameState::RUNNING && !scheduled) {
+            PROFILED_LOCK(lock, gameMutex);
+            int64_t now = monotonicNanos();
+            scheduler.start(now, millisToNanos(sim.getGameSpeed()));
+            watchdog.arm(WatchdogChannel::TICK, now, scheduler.getPeriod());
+            scheduled = true;
+            armTimerAt(tickFd, scheduler.getDeadline());
         }
         
-        // 控制输入处理速度
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        // 界面截止时间改变（游戏结束、超时已处理、重新开始）时重新设置单次定时器，截止时间为0时取消
+        int64_t uiDeadline;
+        {
+            std::lock_guard<std::mutex> lock(uiMutex);
+            uiDeadline = ui.getDeadline();
+        }
+        if (uiDeadline != uiTimerDeadline) {
+            armTimerAt(uiTimerFd, uiDeadline);
+            uiTimerDeadline = uiDeadline;
+        }
     }
+    
+    ::close(uiTimerFd);
+    ::close(frameFd);
+    ::close(tickFd);
+    ::close(loopFd);
+    ThreadStats::sampleCurrentThread();
 }
 
-// 更新游戏状态
-void Game::update() {
-    // 获取锁，确保在更新时不会渲染
-    std::lock_guard<std::mutex> lock(gameMutex);
-    
-    // 移动蛇
-    snake.move();
-    
-    // 检查蛇的长度，如果为0则游戏结束
-    if (snake.getBody().empty()) {
-        std::cout << "Snake has no length! Game over." << std::endl;
-        state = GameState::GAME_OVER;
-        return;
+// 输出运行时统计（CPU占用和上下文切换），用于比较不同运行模式
+void Game::reportRuntimeStats(std::ostream& out) const {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    
+    double wallSeconds = (monotonicNanos() - startTime) / 1e9;
+    double cpuSeconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+                        usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    
+    out << "Runtime: " << (options.runtime == RuntimeMode::EVENT_LOOP ? "event-loop" : "threaded")
+        << ", wall " << wallSeconds << " s, cpu " << cpuSeconds << " s ("
+        << (wallSeconds > 0 ? cpuSeconds * 100.0 / wallSeconds : 0.0) << "% of one core)"
+        << ", voluntary ctx switches " << usage.ru_nvcsw
+        << ", involuntary ctx switches " << usage.ru_nivcsw << std::endl;
+    
+    if (scheduler.getTickCount() > 0) {
+        const LatencyHistogram& lateness = scheduler.getLateness();
+        out << "Tick scheduler: " << (scheduler.getPolicy() == TickPolicy::CATCH_UP ? "catch-up" : "skip")
+            << " policy, " << scheduler.getTickCount() << " ticks, missed " << scheduler.getMissedDeadlines()
+            << " deadlines, skipped " << scheduler.getSkippedTicks() << " ticks, lateness mean "
+            << lateness.getMeanMicros() << " us, p99 " << lateness.getPercentileMicros(99) << " us, max "
+            << lateness.getMaxMicros() << " us" << std::endl;
     }
-    
-    // 检查辣椒效果是否结束
-    checkPepperEffect();
-    
-    // 检查和移除过期食物
-    checkAndRemoveExpiredFoods();
-    
-    // 根据蛇的长度调整游戏速度，长度越长速度越快，但有最低速度限制
-    // 只有在没有辣椒效果时才调整速度
-    if (!pepperEffectActive) {
-        int snakeLength = static_cast<int>(snake.getBody().size());
-        int newSpeed = std::max(150, 400 - (snakeLength - 3) * 10);
-        if (newSpeed != gameSpeed) {
-            gameSpeed = newSpeed;
-            originalGameSpeed = newSpeed; // 同时更新原始速度
-        }
+    watchdog.report(out);
+    tickAllocations.report(out);
+    frameAllocations.report(out);
+    ThreadStats::report(out);
+    reportLockProfile(out);
+    if (plannerTime.getCount() > 0) {
+        out << "Auto player: " << plannerTime.getCount() << " ticks, mean " << plannerTime.getMeanMicros()
+            << " us, p99 " << plannerTime.getPercentileMicros(99) << " us, max "
+            << plannerTime.getMaxMicros() << " us" << std::endl;
+    }
+    if (mctsPlayer.getDecisionCount() > 0) {
+        out << "MCTS: " << mctsPlayer.getThreadCount() << " threads, " << mctsPlayer.getRolloutCount()
+            << " rollouts, " << static_cast<uint64_t>(mctsPlayer.getRolloutsPerSecond()) << " rollouts/s" << std::endl;
     }
 }
 
-// 处理碰撞
-void Game::handleCollisions() {
-    // 获取锁，确保在处理碰撞时不会渲染
-    std::lock_guard<std::mutex> lock(gameMutex);
-    
-    // 检查蛇是否撞到自己
-    if (snake.checkCollisionWithSelf()) {
-        std::cout << "Snake hit itself! Game over." << std::endl;
-        state = GameState::GAME_OVER;
-        return; // 立即返回，不再处理其他碰撞
+// 开启或关闭自动驾驶
+void Game::setAutopilot(bool active) {
+    autopilotActive = active;
+}
+
+// 输入事件回调（在输入线程中调用）
+void Game::onInputEvent(const InputEvent& event) {
+    Telemetry::add(TelemetryCounter::INPUT_EVENTS);
+    
+    // 统计内核到输入线程的延迟
+    if (event.eventTime != 0) {
+        latency.record(LatencyStage::KERNEL_TO_READER, event.readTime - event.eventTime);
     }
     
-    // 检查蛇是否吃到食物
-    bool foodEaten = false;
-    auto it = foods.begin();
+    // 回放时转向来自录像
+    if (replaying) {
+        return;
+    }
     
-    while (it != foods.end()) {
-        if (snake.checkEat(it->food.getX(), it->food.getY())) {
-            foodEaten = true;
-            
-            // 根据食物类型处理不同的效果
-            FoodType foodType = it->food.getType();
-            
-            switch (foodType) {
-                case FoodType::APPLE:
-                    // 苹果：蛇增长一个单位
-                    snake.grow();
-                    break;
-                    
-                case FoodType::PEPPER:
-                    // 辣椒：蛇增长一个单位，短时间内增加移动速度
-                    snake.grow();
-                    // 如果辣椒效果未激活，保存原始速度
-                    if (!pepperEffectActive) {
-                        originalGameSpeed = gameSpeed;
-                    }
-                    // 将游戏速度减半（移动更快）
-                    gameSpeed = originalGameSpeed / 2;
-                    // 设置辣椒效果持续10秒
-                    pepperEffectEndTime = std::chrono::steady_clock::now() + std::chrono::seconds(10);
-                    pepperEffectActive = true;
-                    break;
-                    
-                case FoodType::MEAT:
-                    // 肉：蛇增长两个单位
-                    snake.grow();
-                    snake.grow();
-                    break;
-                    
-                case FoodType::BOMB:
-                    // 炸弹：蛇减少两个单位
-                    // 减少两次长度
-                    for (int i = 0; i < 2; i++) {
-                        // 检查蛇的长度，如果只有一个单位了，游戏结束
-                        if (snake.getBody().size() <= 1) {
-                            std::cout << "Snake ate a bomb and disappeared! Game over." << std::endl;
-                            state = GameState::GAME_OVER;
-                            return;
-                        }
-                        // 减少蛇的长度
-                        snake.shrink();
-                    }
-                    break;
-            }
-            
-            // 从食物列表中移除被吃掉的食物
-            it = foods.erase(it);
-            
-            // 直接在这里生成新食物，而不是调用generateFood方法
-            // 这样可以避免死锁，因为handleCollisions方法已经获取了gameMutex锁
-            int attempts = 0;
-            const int maxAttempts = 50;
-            
-            while (foods.size() < maxFoods && attempts < maxAttempts) {
-                attempts++;
-                
-                // 创建新食物
-                Food newFood;
-                newFood.generate(map, snake);
-                
-                // 检查新食物的位置是否与现有食物重叠
-                bool overlapping = false;
-                for (const auto& existingFood : foods) {
-                    if (newFood.getX() == existingFood.food.getX() && 
-                        newFood.getY() == existingFood.food.getY()) {
-                        overlapping = true;
-                        break;
-                    }
-                }
-                
-                // 如果新食物与现有食物重叠，重新生成
-                if (overlapping) {
-                    continue;
-                }
-                
-                // 设置食物的过期时间
-                auto expirationTime = std::chrono::steady_clock::now() + std::chrono::seconds(foodLifetime);
-                
-                // 添加到食物列表
-                foods.push_back({newFood, expirationTime});
+    // 游戏结束画面上的操作交给界面状态机，由它决定是否开始新的一局（显示、输入设备和线程都继续使用）；
+    // 演示模式的接管在下面处理
+    if (state == GameState::GAME_OVER && !(options.attractMode && autopilotActive)) {
+        bool tapped = event.type == InputEventType::TOUCH_DOWN || event.type == InputEventType::TOUCH_MOVE ||
+                      event.type == InputEventType::KEY_PRESS;
+        if (tapped) {
+            UiAction action;
+            {
+                std::lock_guard<std::mutex> lock(uiMutex);
+                action = ui.onTap(monotonicNanos());
             }
-            
-            // 一次只处理一个食物碰撞
-            break;
-        } else {
-            ++it;
-        }
-    }
-}
-
-
-
-// 检查辣椒效果是否结束
-void Game::checkPepperEffect() {
-    // 如果辣椒效果激活，检查是否已经结束
-    if (pepperEffectActive) {
-        auto now = std::chrono::steady_clock::now();
-        if (now >= pepperEffectEndTime) {
-            // 辣椒效果结束，恢复原始速度
-            gameSpeed = originalGameSpeed;
-            pepperEffectActive = false;
+            dispatchUiAction(action);
         }
+        return;
     }
-}
-
-// 更新地图
-void Game::updateMap() {
-    // 获取锁，确保在更新地图时不会渲染
-    std::lock_guard<std::mutex> lock(gameMutex);
     
-    // 清空地图
-    map.clear();
+    if (event.type != InputEventType::TOUCH_MOVE && event.type != InputEventType::KEY_PRESS) {
+        return;
+    }
     
-    // 更新所有食物位置
-    for (const auto& foodWithLifetime : foods) {
-        foodWithLifetime.food.updateMap(map);
+    // 演示模式下玩家的第一次操作只用于接管，从新的一局开始
+    if (options.attractMode && autopilotActive) {
+        LOG_INFO("Player took over from attract mode");
+        autopilotActive = false;
+        restart();
+        return;
     }
     
-    // 更新蛇在地图上的位置
-    const auto& body = snake.getBody();
+    // 只持有转向队列的锁，不会被渲染阻塞
+    PROFILED_LOCK(lock, turnMutex);
     
-    // 设置蛇头
-    if (!body.empty()) {
-        map.setElement(body[0].first, body[0].second, MapElementType::SNAKE_HEAD);
-        
-        // 设置蛇身
-        for (std::size_t i = 1; i < body.size(); i++) {
-            map.setElement(body[i].first, body[i].second, MapElementType::SNAKE_BODY);
+    // 与队尾相同的转向没有意义，直接丢弃
+    if (pendingTurnCount > 0) {
+        size_t last = (pendingTurnHead + pendingTurnCount - 1) % TURN_QUEUE_CAPACITY;
+        if (pendingTurns[last].direction == event.direction) {
+            return;
         }
     }
-}
-
-// 生成食物
-void Game::generateFood() {
-    // 获取锁，确保在生成食物时不会渲染
-    std::lock_guard<std::mutex> lock(gameMutex);
-    
-    // 检查当前食物数量，如果少于最大值，则生成新食物
-    int attempts = 0;
-    const int maxAttempts = 50; // 最大尝试次数，避免无限循环
     
-    while (foods.size() < maxFoods && attempts < maxAttempts) {
-        attempts++;
-        
-        // 创建新食物
-        Food newFood;
-        newFood.generate(map, snake);
-        
-        // 检查新食物的位置是否与现有食物重叠
-        bool overlapping = false;
-        for (const auto& existingFood : foods) {
-            if (newFood.getX() == existingFood.food.getX() && 
-                newFood.getY() == existingFood.food.getY()) {
-                overlapping = true;
-                break;
-            }
-        }
-        
-        // 如果新食物与现有食物重叠，重新生成
-        if (overlapping) {
-            continue;
-        }
-        
-        // 设置食物的过期时间
-        auto expirationTime = std::chrono::steady_clock::now() + std::chrono::seconds(foodLifetime);
-        
-        // 添加到食物列表
-        foods.push_back({newFood, expirationTime});
+    // 队列已满时丢弃新的转向
+    if (pendingTurnCount == TURN_QUEUE_CAPACITY) {
+        return;
     }
+    
+    TurnCommand& turn = pendingTurns[(pendingTurnHead + pendingTurnCount) % TURN_QUEUE_CAPACITY];
+    turn.direction = event.direction;
+    turn.eventTime = event.eventTime != 0 ? event.eventTime : event.readTime;
+    turn.readTime = event.readTime;
+    pendingTurnCount++;
 }
 
-// 检查和移除过期食物
-void Game::checkAndRemoveExpiredFoods() {
-    // 注意：不需要获取锁，因为调用此方法的update()已经获取了锁
-    
-    // 检查每个食物是否过期
-    auto it = foods.begin();
-    while (it != foods.end()) {
-        if (it->isExpired()) {
-            it = foods.erase(it);
-        } else {
-            ++it;
-        }
-    }
-    
-    // 如果食物数量少于最大值，生成新食物
-    if (foods.size() < maxFoods) {
-        // 直接在这里生成食物，而不是调用generateFood方法
-        // 因为调用此方法的update()已经获取了锁
-        int attempts = 0;
-        const int maxAttempts = 50;
+// 取出一个有效的待处理转向并应用到蛇上
+// 每帧最多改变一次方向，避免同一帧内连续两次转向导致蛇掉头撞到自己
+void Game::applyPendingTurn(uint64_t tick) {
+    PROFILED_LOCK(lock, turnMutex);
+    
+    while (pendingTurnCount > 0) {
+        TurnCommand turn = pendingTurns[pendingTurnHead];
+        pendingTurnHead = (pendingTurnHead + 1) % TURN_QUEUE_CAPACITY;
+        pendingTurnCount--;
         
-        while (foods.size() < maxFoods && attempts < maxAttempts) {
-            attempts++;
-            
-            // 创建新食物
-            Food newFood;
-            newFood.generate(map, snake);
-            
-            // 检查新食物的位置是否与现有食物重叠
-            bool overlapping = false;
-            for (const auto& existingFood : foods) {
-                if (newFood.getX() == existingFood.food.getX() && 
-                    newFood.getY() == existingFood.food.getY()) {
-                    overlapping = true;
-                    break;
-                }
-            }
-            
-            // 如果新食物与现有食物重叠，重新生成
-            if (overlapping) {
-                continue;
-            }
+        // 无效的转向（同向或反向）不占用本帧，继续取下一个
+        if (sim.turn(turn.direction)) {
+            // 只录制真正生效的转向
+            replayWriter.recordTurn(tick, turn.direction);
             
-            // 设置食物的过期时间
-            auto expirationTime = std::chrono::steady_clock::now() + std::chrono::seconds(foodLifetime);
-            
-            // 添加到食物列表
-            foods.push_back({newFood, expirationTime});
+            // 记录输入线程到游戏帧的延迟，并等待渲染线程第一次显示它
+            int64_t now = monotonicNanos();
+            latency.record(LatencyStage::READER_TO_TICK, now - turn.readTime);
+            turnSerial++;
+            turnEventTime = turn.eventTime;
+            turnTickTime = now;
+            break;
         }
     }
-}
\ No newline at end of file
+}
+
+// 发布当前状态的渲染快照
+void Game::publishSnapshot() {
+    GameSnapshot& snapshot = snapshots.getWriteBuffer();
+    
+    snapshot.capture(sim);
+    snapshot.state = state;
+    snapshot.turnSerial = turnSerial;
+    snapshot.turnEventTime = turnEventTime;
+    snapshot.turnTickTime = turnTickTime;
+    
+    snapshots.publish();
+}
@@ -0,0 +1,31 @@
+#include "../include/GameSnapshot.h"
+#include "../include/Simulation.h"
+
+// 从模拟中复制渲染所需的状态
+void GameSnapshot::capture(const Simulation& sim) {
+    tick = sim.getTick();
+    direction = sim.getSnake().getDirection();
+    // 容量足够时不会重新分配内存
+    sim.getSnake().copyBody(body);
+    foods.clear();
+    foods.reserve(sim.getRules().maxFoods);
+    for (const auto& foodWithLifetime : sim.getFoods()) {
+        foods.push_back(foodWithLifetime.food);
+    }
+    const std::vector<Snake>& rivals = sim.getRivals();
+    rivalBodies.resize(rivals.size());
+    rivalDirections.resize(rivals.size());
+    for (size_t i = 0; i < rivals.size(); i++) {
+        if (rivals[i].isAlive()) {
+            rivals[i].copyBody(rivalBodies[i]);
+        } else {
+            rivalBodies[i].clear();
+        }
+        rivalDirections[i] = rivals[i].getDirection();
+    }
+    // 与模拟中的变化列表预留相同的容量，复制时不再重新分配
+    mapChanges.reserve(sim.getChanges().capacity());
+    mapChanges = sim.getChanges();
+    mapGeneration = sim.getMapGeneration();
+    pepperActive = sim.isPepperActive();
+}
@@ -0,0 +1,223 @@
+#include "../include/HamiltonianPlayer.h"
+#include <algorithm>
+
+namespace {
+    const Direction DIRECTIONS[4] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+
+    // 抄近路时与蛇尾之间保留的格数（肉一次增长两节，再留出余量）
+    const int TAIL_MARGIN = 4;
+
+    // 吃到炸弹时蛇缩短的节数
+    const int BOMB_SHRINK = 2;
+}
+
+// 构造函数
+HamiltonianPlayer::HamiltonianPlayer()
+    : width(0), height(0), lastLength(0), lastTick(0), strictUntilTick(0), cycleLength(0) {
+}
+
+// 指定尺寸的地图是否存在哈密顿回路
+bool HamiltonianPlayer::cycleExists(int mapWidth, int mapHeight) {
+    return mapWidth >= 2 && mapHeight >= 2 && (mapWidth % 2 == 0 || mapHeight % 2 == 0);
+}
+
+// 按地图尺寸确定回路
+void HamiltonianPlayer::build(int mapWidth, int mapHeight) {
+    width = mapWidth;
+    height = mapHeight;
+    cycleLength = cycleExists(width, height) ? width * height : 0;
+}
+
+// 格子在回路上的序号
+// 高为偶数时第0列留作回程：其余格子按行蛇形遍历，偶数行向右、奇数行向左，
+// 最后一行在x=1结束，再沿第0列向上回到起点。高为奇数时宽一定为偶数，转置上面的构造：第0行留作回程，按列蛇形遍历
+int HamiltonianPlayer::cycleIndex(int cell) const {
+    int x = cell % width;
+    int y = cell / width;
+    if (height % 2 == 0) {
+        if (x == 0) {
+            return height * (width - 1) + (height - 1 - y);
+        }
+        return y * (width - 1) + (y % 2 == 0 ? x - 1 : width - 1 - x);
+    }
+    if (y == 0) {
+        return width * (height - 1) + (width - 1 - x);
+    }
+    return x * (height - 1) + (x % 2 == 0 ? y - 1 : height - 1 - y);
+}
+
+// 回路上第index个格子
+int HamiltonianPlayer::cycleCell(int index) const {
+    if (height % 2 == 0) {
+        int serpentine = height * (width - 1);
+        if (index >= serpentine) {
+            return (height - 1 - (index - serpentine)) * width;
+        }
+        int y = index / (width - 1);
+        int step = index % (width - 1);
+        return y * width + (y % 2 == 0 ? step + 1 : width - 1 - step);
+    }
+    int serpentine = width * (height - 1);
+    if (index >= serpentine) {
+        return width - 1 - (index - serpentine);
+    }
+    int x = index / (height - 1);
+    int step = index % (height - 1);
+    return (x % 2 == 0 ? step + 1 : height - 1 - step) * width + x;
+}
+
+// 沿回路从a走到b的距离
+int HamiltonianPlayer::cycleDistance(int from, int to) const {
+    return (cycleIndex(to) - cycleIndex(from) + cycleLength) % cycleLength;
+}
+
+// 获取相邻格子，越界时返回-1
+int HamiltonianPlayer::neighbor(int cell, Direction direction) const {
+    int x = cell % width;
+    int y = cell / width;
+    switch (direction) {
+        case Direction::UP: y--; break;
+        case Direction::DOWN: y++; break;
+        case Direction::LEFT: x--; break;
+        case Direction::RIGHT: x++; break;
+    }
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        return -1;
+    }
+    return y * width + x;
+}
+
+// 抄近路到cell之后，沿回路到蛇尾的空格是否容得下途中的增长
+bool HamiltonianPlayer::hasRoomAfter(const Simulation& sim, int cell, int tail) const {
+    // 途中的每个食物使蛇变长一节且可能在前方补充一个新食物，按两节计算；正在生长的一节也要算上
+    int room = cycleDistance(cell, tail);
+    int growth = sim.getSnake().isGrowing() ? 1 : 0;
+    for (const auto& foodWithLifetime : sim.getFoods()) {
+        const Food& food = foodWithLifetime.food;
+        if (food.getType() != FoodType::BOMB && cycleDistance(cell, food.getY() * width + food.getX()) < room) {
+            growth += 2;
+        }
+    }
+    return room > growth + TAIL_MARGIN;
+}
+
+// 为下一帧选择方向
+Direction HamiltonianPlayer::chooseDirection(const Simulation& sim) {
+    const Map& map = sim.getMap();
+    const Snake& snake = sim.getSnake();
+    Direction current = snake.getDirection();
+
+    if (map.getWidth() != width || map.getHeight() != height) {
+        build(map.getWidth(), map.getHeight());
+    }
+    if (cycleLength == 0) {
+        return current;
+    }
+
+    std::pair<int, int> headPos = snake.getHead();
+    if (headPos.first < 0 || headPos.first >= width || headPos.second < 0 || headPos.second >= height) {
+        return current;
+    }
+    int head = headPos.second * width + headPos.first;
+    std::pair<int, int> tailPos = snake.getTail();
+    int tail = tailPos.second * width + tailPos.first;
+    int length = static_cast<int>(snake.getLength());
+    int total = cycleLength;
+
+    // 新的一局重新开始；炸弹使蛇变短后在蛇长的帧数内严格沿回路走
+    uint64_t tick = sim.getTick();
+    if (tick < lastTick) {
+        strictUntilTick = 0;
+    } else if (static_cast<size_t>(length) < lastLength) {
+        strictUntilTick = tick + static_cast<uint64_t>(length);
+    }
+    lastTick = tick;
+    lastLength = static_cast<size_t>(length);
+
+    // 沿回路最近的非炸弹食物
+    int foodDistance = total;
+    for (const auto& foodWithLifetime : sim.getFoods()) {
+        const Food& food = foodWithLifetime.food;
+        if (food.getType() == FoodType::BOMB) {
+            continue;
+        }
+        int distance = cycleDistance(head, food.getY() * width + food.getX());
+        if (distance > 0 && distance < foodDistance) {
+            foodDistance = distance;
+        }
+    }
+
+    // 蛇身占据回路上从蛇尾到蛇头的一段，跳到的位置不能越过蛇尾；
+    // 蛇加上地图上的食物可能带来的增长超过半个地图后只沿回路走，保证剩余的空格始终连在一起
+    // （小地图上食物占的比例大，蛇在蛇尾走过跳过的格子之前可能连续吃到几个食物）
+    int tailDistance = cycleDistance(head, tail);
+    int reserved = length + 2 * static_cast<int>(sim.getFoods().size()) + TAIL_MARGIN;
+    bool shortcuts = reserved * 2 < total && tick >= strictUntilTick;
+    int shortcutLimit = shortcuts ? tailDistance - TAIL_MARGIN : 1;
+
+    int next = cycleCell((cycleIndex(head) + 1) % total);
+    int best = -1;
+    int bestDistance = 0;
+    for (Direction direction : DIRECTIONS) {
+        int cell = neighbor(head, direction);
+        if (cell < 0) {
+            continue;
+        }
+        MapElementType element = map.getElement(cell % width, cell / width);
+        // 蛇尾在这一帧会离开，除非蛇正在生长
+        bool blocked = (element == MapElementType::SNAKE_BODY || element == MapElementType::SNAKE_HEAD) &&
+                       (cell != tail || snake.isGrowing());
+        if (blocked || element == MapElementType::FOOD_BOMB) {
+            continue;
+        }
+        int distance = cycleDistance(head, cell);
+        bool allowed = (cell == next) ||
+                       (distance <= shortcutLimit && distance <= foodDistance && hasRoomAfter(sim, cell, tail));
+        if (allowed && distance > bestDistance) {
+            best = cell;
+            bestDistance = distance;
+        }
+    }
+
+    // 回路上的下一格被蛇身占据时（开局时蛇身可能还不在回路上，例如逆着回路的方向），
+    // 选择一个沿回路走下去不会追上蛇身的格子：回路上前方第d格的蛇身第i节在d帧之内必须已经离开
+    // （蛇长减i帧之后离开，途中可能再生长一节）。下一格是炸弹时一般沿回路吃掉它（绕开会打乱蛇身的顺序），
+    // 只有吃掉后蛇只剩一节（再吃一个炸弹就结束）时才这样绕开，没有这样的格子时仍然吃掉它
+    if (best < 0) {
+        best = next;
+        MapElementType element = map.getElement(next % width, next / width);
+        bool bodyAhead = (element == MapElementType::SNAKE_BODY || element == MapElementType::SNAKE_HEAD) && next != tail;
+        bool fatalBomb = element == MapElementType::FOOD_BOMB && length <= BOMB_SHRINK + 1;
+        if (bodyAhead || fatalBomb) {
+            int bestSlack = 0;
+            for (Direction direction : DIRECTIONS) {
+                int cell = neighbor(head, direction);
+                if (cell < 0) {
+                    continue;
+                }
+                MapElementType neighborElement = map.getElement(cell % width, cell / width);
+                if (neighborElement == MapElementType::SNAKE_BODY || neighborElement == MapElementType::SNAKE_HEAD ||
+                    neighborElement == MapElementType::FOOD_BOMB) {
+                    continue;
+                }
+                int slack = total;
+                for (int i = 0; i < length; i++) {
+                    std::pair<int, int> segment = snake.getSegment(static_cast<size_t>(i));
+                    int distance = cycleDistance(cell, segment.second * width + segment.first);
+                    slack = std::min(slack, distance - (length - i) - 1);
+                }
+                if ((best == next && (bodyAhead || slack >= 0)) || (best != next && slack > bestSlack)) {
+                    best = cell;
+                    bestSlack = slack;
+                }
+            }
+        }
+    }
+
+    for (Direction direction : DIRECTIONS) {
+        if (neighbor(head, direction) == best) {
+            return direction;
+        }
+    }
+    return current;
+}
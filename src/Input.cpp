@@ -1,18 +1,101 @@
 #include "../include/Input.h"
 #include <iostream>
+#include <algorithm>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <dirent.h>
+#include <cerrno>
 #include <cstring>
+#include <cstdlib>
 #include <linux/input.h>
-#include <cmath>
-#include <poll.h>
-#include <thread>
-#include <mutex>
+#include <time.h>
+#include "../include/Latency.h"
+#include "../include/Trace.h"
+#include "../include/ThreadStats.h"
+#include "../include/Log.h"
+
+namespace {
+    // epoll标记：标准输入和唤醒eventfd，其余值为设备索引
+    const uint32_t STDIN_TAG = 0xFFFFFFFEu;
+    const uint32_t WAKE_TAG = 0xFFFFFFFFu;
+
+    // 单次read批量读取的事件数
+    const size_t EVENT_BATCH = 64;
+
+    // 滑动识别的最小距离（像素）
+    const int SWIPE_THRESHOLD = 30;
+
+    // 能力位图辅助
+    const size_t BITS_PER_LONG = sizeof(unsigned long) * 8;
+
+    inline size_t bitLongs(size_t bits) {
+        return (bits + BITS_PER_LONG - 1) / BITS_PER_LONG;
+    }
+
+    inline bool testBit(const unsigned long* bits, int bit) {
+        return (bits[bit / BITS_PER_LONG] >> (bit % BITS_PER_LONG)) & 1UL;
+    }
+
+    // 将键码映射为方向，不是方向键返回false
+    bool keyToDirection(int code, Direction& dir) {
+        switch (code) {
+            case KEY_UP:
+            case KEY_W:
+            case BTN_DPAD_UP:
+                dir = Direction::UP;
+                return true;
+            case KEY_DOWN:
+            case KEY_S:
+            case BTN_DPAD_DOWN:
+                dir = Direction::DOWN;
+                return true;
+            case KEY_LEFT:
+            case KEY_A:
+            case BTN_DPAD_LEFT:
+                dir = Direction::LEFT;
+                return true;
+            case KEY_RIGHT:
+            case KEY_D:
+            case BTN_DPAD_RIGHT:
+                dir = Direction::RIGHT;
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // 取evdev事件的时间戳（纳秒）
+    int64_t eventNanos(const struct input_event& ev) {
+#ifdef input_event_sec
+        return static_cast<int64_t>(ev.input_event_sec) * 1000000000LL + ev.input_event_usec * 1000LL;
+#else
+        return static_cast<int64_t>(ev.time.tv_sec) * 1000000000LL + ev.time.tv_usec * 1000LL;
+#endif
+    }
+
+    // 将坐标从设备范围缩放到屏幕范围
+    int scaleAxis(int value, int minValue, int maxValue, int screenSize) {
+        if (maxValue <= minValue) {
+            return value;
+        }
+        return (value - minValue) * (screenSize - 1) / (maxValue - minValue);
+    }
+}
 
 // 构造函数
-Input::Input() : currentDirection(Direction::RIGHT), newInput(false), touchFd(-1), initialized(false) {
+Input::Input(int screenWidth, int screenHeight)
+    : epollFd(-1),
+      wakeFd(-1),
+      stdinWatched(false),
+      initialized(false),
+      screenWidth(screenWidth),
+      screenHeight(screenHeight),
+      running(false) {
 }
 
 // 析构函数
@@ -21,217 +104,384 @@ Input::~Input() {
 }
 
 // 初始化输入设备
-bool Input::initialize() {
-    // 尝试打开触摸屏设备
-    touchFd = open("/dev/input/event0", O_RDONLY | O_NONBLOCK);
-    if (touchFd == -1) {
-        std::cerr << "Warning: Could not open touch device, falling back to keyboard input" << std::endl;
-    } else {
-        std::cout << "Touch device initialized successfully!" << std::endl;
-    }
-    
+bool Input::initialize(bool probeDevices) {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd == -1) {
+        LOG_ERROR("Error creating epoll instance: " << strerror(errno));
+        return false;
+    }
+
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd == -1 || !watchFd(wakeFd, WAKE_TAG)) {
+        LOG_ERROR("Error creating input wake eventfd: " << strerror(errno));
+        close();
+        return false;
+    }
+
+    if (probeDevices) {
+        // 探测所有evdev设备
+        this->probeDevices();
+        if (devices.empty()) {
+            LOG_WARN("Warning: No usable input device found, falling back to keyboard input");
+        }
+
+        // 监听标准输入（标准输入为普通文件时epoll不支持，忽略即可）
+        stdinWatched = watchFd(STDIN_FILENO, STDIN_TAG);
+    }
+
     initialized = true;
     return true;
 }
 
-// 检查设备是否就绪
-bool Input::isDeviceReady() {
-    if (touchFd == -1) {
-        return false;
+// 探测并打开/dev/input下所有可用设备
+void Input::probeDevices() {
+    DIR* dir = opendir("/dev/input");
+    if (!dir) {
+        return;
     }
-    
-    struct pollfd pfd;
-    pfd.fd = touchFd;
-    pfd.events = POLLIN;
-    
-    // 轮询设备，超时时间为0（非阻塞）
-    int ret = poll(&pfd, 1, 0);
-    
-    return (ret > 0 && (pfd.revents & POLLIN));
-}
 
-// 读取设备数据的线程函数
-void Input::readDeviceThread() {
-    struct input_event ev;
-    ssize_t res;
-    int x = 0, y = 0;
-    int x0 = 0, y0 = 0;
-    
-    while (touchFd != -1) {
-        // 检查设备是否就绪
-        if (!isDeviceReady()) {
-            // 如果设备没有数据，短暂休眠减少CPU占用
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            continue;
+    std::vector<std::string> paths;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (strncmp(entry->d_name, "event", 5) == 0) {
+            paths.push_back(std::string("/dev/input/") + entry->d_name);
         }
-        
-        // 读取触摸屏数据
-        res = read(touchFd, &ev, sizeof(ev));
-        if (res == -1) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // 非阻塞模式下，没有数据可读
-                continue;
-            }
-            std::cerr << "Error reading touch device: " << strerror(errno) << std::endl;
+    }
+    closedir(dir);
+    std::sort(paths.begin(), paths.end());
+
+    for (const auto& path : paths) {
+        int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd == -1) {
             continue;
-        } else if (res != sizeof(ev)) {
-            std::cerr << "Incomplete read from touch device" << std::endl;
+        }
+
+        InputDeviceKind kind;
+        if (!classifyDevice(fd, kind)) {
+            ::close(fd);
             continue;
         }
-        
-        // 分析触摸屏数据
-        if (ev.type == EV_ABS) {
-            // 绝对值事件类型
-            if (ev.code == ABS_X) {
-                // 触摸点X值的事件
-                x = ev.value;
-                // 如果是GEC6818屏幕，可能需要进行等比缩放
-                x = x * 799 / 1023.0;
-            } else if (ev.code == ABS_Y) {
-                // 触摸点Y值的事件
-                y = ev.value;
-                // 如果是GEC6818屏幕，可能需要进行等比缩放
-                y = y * 479 / 599.0;
-            }
-        } else if (ev.type == EV_KEY && ev.code == BTN_TOUCH) {
-            // 触摸屏按键事件类型(按下和释放)
-            if (ev.value == 1) {
-                // 触摸屏被按下(手指接触触摸屏)
-                // 获取起始点坐标
-                x0 = x;
-                y0 = y;
-                
-                // 创建按下事件
-                InputEvent event;
-                event.type = InputEventType::TOUCH_DOWN;
-                event.x = x;
-                event.y = y;
-                addEvent(event);
-                
-            } else if (ev.value == 0) {
-                // 触摸屏被释放(手指离开触摸屏)
-                // 创建释放事件
-                InputEvent event;
-                event.type = InputEventType::TOUCH_UP;
-                event.x = x;
-                event.y = y;
-                
-                // 判断滑动方向
-                if (std::abs(x - x0) >= std::abs(y - y0) && std::abs(x - x0) >= 30) {
-                    // 水平方向滑动
-                    if (x > x0) {
-                        // 向右滑
-                        event.type = InputEventType::TOUCH_MOVE;
-                        event.direction = Direction::RIGHT;
-                    } else {
-                        // 向左滑
-                        event.type = InputEventType::TOUCH_MOVE;
-                        event.direction = Direction::LEFT;
-                    }
-                } else if (std::abs(x - x0) < std::abs(y - y0) && std::abs(y - y0) >= 30) {
-                    // 垂直方向滑动
-                    if (y > y0) {
-                        // 向下滑
-                        event.type = InputEventType::TOUCH_MOVE;
-                        event.direction = Direction::DOWN;
-                    } else {
-                        // 向上滑
-                        event.type = InputEventType::TOUCH_MOVE;
-                        event.direction = Direction::UP;
-                    }
-                }
-                
-                // 添加事件到队列
-                if (event.type == InputEventType::TOUCH_MOVE) {
-                    addEvent(event);
-                    
-                    // 立即更新方向，提高响应速度
-                    Direction newDirection = convertEventToDirection(event, currentDirection);
-                    if (newDirection != currentDirection) {
-                        currentDirection = newDirection;
-                        newInput = true;
-                    }
-                }
+
+        // 让事件时间戳使用CLOCK_MONOTONIC，便于与其他阶段的时间比较
+        int clockId = CLOCK_MONOTONIC;
+        ioctl(fd, EVIOCSCLOCKID, &clockId);
+
+        Device device;
+        device.fd = fd;
+        device.kind = kind;
+        device.path = path;
+        device.absMinX = device.absMaxX = 0;
+        device.absMinY = device.absMaxY = 0;
+        device.touchX = device.touchY = 0;
+        device.startX = device.startY = 0;
+        device.pendingTouch = -1;
+
+        if (kind == InputDeviceKind::TOUCH) {
+            // 读取坐标范围，优先使用单点坐标轴
+            struct input_absinfo absX, absY;
+            if (ioctl(fd, EVIOCGABS(ABS_X), &absX) == 0 && ioctl(fd, EVIOCGABS(ABS_Y), &absY) == 0 &&
+                absX.maximum > absX.minimum) {
+                device.absMinX = absX.minimum;
+                device.absMaxX = absX.maximum;
+                device.absMinY = absY.minimum;
+                device.absMaxY = absY.maximum;
+            } else if (ioctl(fd, EVIOCGABS(ABS_MT_POSITION_X), &absX) == 0 &&
+                       ioctl(fd, EVIOCGABS(ABS_MT_POSITION_Y), &absY) == 0) {
+                device.absMinX = absX.minimum;
+                device.absMaxX = absX.maximum;
+                device.absMinY = absY.minimum;
+                device.absMaxY = absY.maximum;
             }
         }
+
+        if (!watchFd(fd, static_cast<uint32_t>(devices.size()))) {
+            ::close(fd);
+            continue;
+        }
+
+        const char* kindName = kind == InputDeviceKind::TOUCH ? "touch" :
+                               kind == InputDeviceKind::KEYBOARD ? "keyboard" : "gamepad";
+        LOG_INFO("Input device " << path << ": " << kindName);
+        devices.push_back(device);
     }
 }
 
-// 添加事件到队列
-void Input::addEvent(const InputEvent& event) {
-    {
-        std::lock_guard<std::mutex> lock(eventMutex);
-        eventQueue.push(event);
+// 根据设备能力判断设备类型
+bool Input::classifyDevice(int fd, InputDeviceKind& kind) {
+    std::vector<unsigned long> evBits(bitLongs(EV_MAX + 1), 0);
+    std::vector<unsigned long> keyBits(bitLongs(KEY_MAX + 1), 0);
+    std::vector<unsigned long> absBits(bitLongs(ABS_MAX + 1), 0);
+
+    if (ioctl(fd, EVIOCGBIT(0, evBits.size() * sizeof(unsigned long)), evBits.data()) < 0) {
+        return false;
+    }
+    bool hasKey = testBit(evBits.data(), EV_KEY) &&
+                  ioctl(fd, EVIOCGBIT(EV_KEY, keyBits.size() * sizeof(unsigned long)), keyBits.data()) >= 0;
+    bool hasAbs = testBit(evBits.data(), EV_ABS) &&
+                  ioctl(fd, EVIOCGBIT(EV_ABS, absBits.size() * sizeof(unsigned long)), absBits.data()) >= 0;
+
+    // 触摸屏：有绝对坐标轴和BTN_TOUCH
+    if (hasAbs && hasKey && testBit(keyBits.data(), BTN_TOUCH) &&
+        ((testBit(absBits.data(), ABS_X) && testBit(absBits.data(), ABS_Y)) ||
+         (testBit(absBits.data(), ABS_MT_POSITION_X) && testBit(absBits.data(), ABS_MT_POSITION_Y)))) {
+        kind = InputDeviceKind::TOUCH;
+        return true;
+    }
+
+    // 手柄：有手柄按键、十字键或方向帽
+    if ((hasKey && (testBit(keyBits.data(), BTN_GAMEPAD) || testBit(keyBits.data(), BTN_DPAD_UP))) ||
+        (hasAbs && testBit(absBits.data(), ABS_HAT0X) && testBit(absBits.data(), ABS_HAT0Y))) {
+        kind = InputDeviceKind::GAMEPAD;
+        return true;
     }
-    hasEvent.notify_one();
+
+    // 键盘：有方向键或WASD
+    if (hasKey && (testBit(keyBits.data(), KEY_UP) || testBit(keyBits.data(), KEY_W))) {
+        kind = InputDeviceKind::KEYBOARD;
+        return true;
+    }
+
+    return false;
 }
 
-// 获取输入事件
-bool Input::getEvent(InputEvent& event) {
-    if (touchFd == -1) {
+// 将fd加入epoll监听
+bool Input::watchFd(int fd, uint32_t tag) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = tag;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+// 添加一个外部事件源
+bool Input::addDevice(int fd, InputDeviceKind kind, const std::string& name) {
+    if (epollFd == -1 || running || !watchFd(fd, static_cast<uint32_t>(devices.size()))) {
         return false;
     }
-    
-    std::unique_lock<std::mutex> lock(eventMutex);
-    if (eventQueue.empty()) {
-        // 非阻塞模式，队列为空时立即返回
+
+    Device device;
+    device.fd = fd;
+    device.kind = kind;
+    device.path = name;
+    device.absMinX = device.absMaxX = 0;
+    device.absMinY = device.absMaxY = 0;
+    device.touchX = device.touchY = 0;
+    device.startX = device.startY = 0;
+    device.pendingTouch = -1;
+    devices.push_back(device);
+    return true;
+}
+
+// 设置事件回调
+void Input::setEventHandler(const EventHandler& handler) {
+    eventHandler = handler;
+}
+
+// 转发事件
+void Input::dispatch(const InputEvent& event) {
+    if (eventHandler) {
+        eventHandler(event);
+    }
+}
+
+// 处理已就绪的输入并分发事件
+bool Input::pollEvents(int timeoutMs) {
+    struct epoll_event ready[16];
+
+    int count;
+    {
+        TRACE_SPAN("input wait");
+        count = epoll_wait(epollFd, ready, 16, timeoutMs);
+    }
+    if (count == -1) {
+        if (errno == EINTR) {
+            return true;
+        }
+        LOG_ERROR("Error waiting for input: " << strerror(errno));
         return false;
     }
-    
-    event = eventQueue.front();
-    eventQueue.pop();
+
+    for (int i = 0; i < count; i++) {
+        uint32_t tag = ready[i].data.u32;
+        if (tag == WAKE_TAG) {
+            uint64_t value;
+            while (read(wakeFd, &value, sizeof(value)) > 0) {
+            }
+        } else if (tag == STDIN_TAG) {
+            drainStdin();
+        } else if (tag < devices.size() && devices[tag].fd != -1) {
+            drainDevice(devices[tag]);
+        }
+    }
     return true;
 }
 
-// 处理键盘输入
-void Input::processKeyboardInput() {
-    // 非阻塞方式读取键盘输入
-    struct pollfd pfd;
-    pfd.fd = STDIN_FILENO;
-    pfd.events = POLLIN;
-    
-    int ret = poll(&pfd, 1, 0);
-    if (ret > 0 && (pfd.revents & POLLIN)) {
-        char c;
-        if (read(STDIN_FILENO, &c, 1) > 0) {
-            Direction newDir = currentDirection;
-            
-            // 根据输入的键值确定方向
-            switch (c) {
-                case 'w': // 上
-                    newDir = Direction::UP;
-                    break;
-                case 's': // 下
-                    newDir = Direction::DOWN;
-                    break;
-                case 'a': // 左
-                    newDir = Direction::LEFT;
-                    break;
-                case 'd': // 右
-                    newDir = Direction::RIGHT;
-                    break;
-                default:
-                    // 其他键不处理
-                    return;
+// 输入线程函数：阻塞等待任意设备就绪，没有输入时不占用CPU
+void Input::readDeviceThread() {
+    ThreadStats::nameThread("input");
+    while (running) {
+        if (!pollEvents(-1)) {
+            break;
+        }
+    }
+    ThreadStats::sampleCurrentThread();
+}
+
+// 批量读取并处理一个设备上的所有事件
+void Input::drainDevice(Device& device) {
+    TRACE_SPAN("input read");
+    struct input_event events[EVENT_BATCH];
+
+    for (;;) {
+        ssize_t res = read(device.fd, events, sizeof(events));
+        if (res == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                // 设备被拔出或出错，停止监听
+                LOG_ERROR("Error reading input device " << device.path << ": " << strerror(errno));
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, device.fd, nullptr);
+                ::close(device.fd);
+                device.fd = -1;
+            }
+            return;
+        }
+
+        // 同一批事件共用一个读取时间
+        int64_t readTime = monotonicNanos();
+        size_t count = static_cast<size_t>(res) / sizeof(struct input_event);
+        for (size_t i = 0; i < count; i++) {
+            handleDeviceEvent(device, events[i], readTime);
+        }
+
+        // 读到的事件不足一批，说明已经读空
+        if (count < EVENT_BATCH) {
+            return;
+        }
+    }
+}
+
+// 批量读取并处理标准输入
+void Input::drainStdin() {
+    TRACE_SPAN("input read");
+    char buf[64];
+    ssize_t res = read(STDIN_FILENO, buf, sizeof(buf));
+    if (res <= 0) {
+        if (res == 0 || (errno != EAGAIN && errno != EINTR)) {
+            // 标准输入已关闭，不再监听，避免epoll持续返回就绪
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, STDIN_FILENO, nullptr);
+            stdinWatched = false;
+        }
+        return;
+    }
+
+    // 标准输入没有内核时间戳，以读取时间代替
+    int64_t readTime = monotonicNanos();
+    for (ssize_t i = 0; i < res; i++) {
+        InputEvent event;
+        event.type = InputEventType::KEY_PRESS;
+        event.keyCode = buf[i];
+        event.eventTime = readTime;
+        event.readTime = readTime;
+
+        // 根据输入的键值确定方向
+        switch (buf[i]) {
+            case 'w': event.direction = Direction::UP; break;
+            case 's': event.direction = Direction::DOWN; break;
+            case 'a': event.direction = Direction::LEFT; break;
+            case 'd': event.direction = Direction::RIGHT; break;
+            default: continue;  // 其他键不处理
+        }
+        dispatch(event);
+    }
+}
+
+// 处理单个evdev事件
+void Input::handleDeviceEvent(Device& device, const struct input_event& ev, int64_t readTime) {
+    int type = ev.type;
+    int code = ev.code;
+    int value = ev.value;
+
+    if (device.kind == InputDeviceKind::TOUCH) {
+        if (type == EV_ABS) {
+            if (code == ABS_X || code == ABS_MT_POSITION_X) {
+                device.touchX = scaleAxis(value, device.absMinX, device.absMaxX, screenWidth);
+            } else if (code == ABS_Y || code == ABS_MT_POSITION_Y) {
+                device.touchY = scaleAxis(value, device.absMinY, device.absMaxY, screenHeight);
+            }
+        } else if (type == EV_KEY && code == BTN_TOUCH) {
+            // 按下/释放在SYN_REPORT时处理，保证同一帧的坐标已经更新
+            device.pendingTouch = value;
+        } else if (type == EV_SYN && code == SYN_REPORT && device.pendingTouch != -1) {
+            InputEvent event;
+            event.x = device.touchX;
+            event.y = device.touchY;
+            event.eventTime = eventNanos(ev);
+            event.readTime = readTime;
+
+            if (device.pendingTouch == 1) {
+                // 手指接触触摸屏，记录起始点坐标
+                device.startX = device.touchX;
+                device.startY = device.touchY;
+                event.type = InputEventType::TOUCH_DOWN;
+            } else {
+                // 手指离开触摸屏，判断滑动方向
+                int dx = device.touchX - device.startX;
+                int dy = device.touchY - device.startY;
+                event.type = InputEventType::TOUCH_UP;
+
+                if (std::abs(dx) >= std::abs(dy) && std::abs(dx) >= SWIPE_THRESHOLD) {
+                    // 水平方向滑动
+                    event.type = InputEventType::TOUCH_MOVE;
+                    event.direction = dx > 0 ? Direction::RIGHT : Direction::LEFT;
+                } else if (std::abs(dx) < std::abs(dy) && std::abs(dy) >= SWIPE_THRESHOLD) {
+                    // 垂直方向滑动
+                    event.type = InputEventType::TOUCH_MOVE;
+                    event.direction = dy > 0 ? Direction::DOWN : Direction::UP;
+                }
             }
-            
-            // 设置新方向
-            setDirection(newDir);
+
+            device.pendingTouch = -1;
+            dispatch(event);
         }
+        return;
+    }
+
+    // 键盘和手柄
+    InputEvent event;
+    event.keyCode = code;
+    event.eventTime = eventNanos(ev);
+    event.readTime = readTime;
+    if (type == EV_KEY && value == 1) {
+        // 只处理按下，忽略自动重复和释放
+        if (keyToDirection(code, event.direction)) {
+            event.type = InputEventType::KEY_PRESS;
+            dispatch(event);
+        }
+    } else if (type == EV_ABS && (code == ABS_HAT0X || code == ABS_HAT0Y) && value != 0) {
+        // 手柄方向帽
+        event.type = InputEventType::KEY_PRESS;
+        if (code == ABS_HAT0X) {
+            event.direction = value > 0 ? Direction::RIGHT : Direction::LEFT;
+        } else {
+            event.direction = value > 0 ? Direction::DOWN : Direction::UP;
+        }
+        dispatch(event);
     }
 }
 
 // 将输入事件转换为蛇的方向
 Direction Input::convertEventToDirection(const InputEvent& event, Direction currentDirection) {
     Direction newDirection = currentDirection;
-    
+
     // 根据事件类型处理
     if (event.type == InputEventType::TOUCH_MOVE) {
         newDirection = event.direction;
     } else if (event.type == InputEventType::KEY_PRESS) {
         newDirection = event.direction;
     }
-    
+
     // 防止蛇直接掉头（这会导致蛇撞到自己）
     if ((currentDirection == Direction::UP && newDirection == Direction::DOWN) ||
         (currentDirection == Direction::DOWN && newDirection == Direction::UP) ||
@@ -239,42 +489,57 @@ Direction Input::convertEventToDirection(const InputEvent& event, Direction curr
         (currentDirection == Direction::RIGHT && newDirection == Direction::LEFT)) {
         return currentDirection;
     }
-    
+
     return newDirection;
 }
 
 // 启动输入线程
-std::thread* Input::startInputThread() {
-    return new std::thread(&Input::readDeviceThread, this);
+bool Input::startInputThread() {
+    if (!initialized || running) {
+        return false;
+    }
+    running = true;
+    readerThread = std::thread(&Input::readDeviceThread, this);
+    return true;
 }
 
-// 关闭输入设备
-void Input::close() {
-    if (touchFd != -1) {
-        ::close(touchFd);
-        touchFd = -1;
+// 停止并等待输入线程结束
+void Input::stopInputThread() {
+    if (!running) {
+        return;
     }
-}
+    running = false;
 
-// 设置当前方向
-void Input::setDirection(Direction dir) {
-    std::lock_guard<std::mutex> lock(directionMutex);
-    currentDirection = dir;
-    newInput = true;
+    // 通过eventfd唤醒阻塞在epoll_wait上的输入线程
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) != sizeof(one)) {
+        LOG_ERROR("Error waking input thread: " << strerror(errno));
+    }
+    if (readerThread.joinable()) {
+        readerThread.join();
+    }
 }
 
-// 获取当前方向
-Direction Input::getDirection() const {
-    return currentDirection;
-}
+// 关闭输入设备
+void Input::close() {
+    stopInputThread();
 
-// 检查是否有新的输入
-bool Input::hasNewInput() const {
-    return newInput;
-}
+    for (auto& device : devices) {
+        if (device.fd != -1) {
+            ::close(device.fd);
+            device.fd = -1;
+        }
+    }
+    devices.clear();
 
-// 清除新输入标记
-void Input::clearNewInput() {
-    std::lock_guard<std::mutex> lock(directionMutex);
-    newInput = false;
-} 
\ No newline at end of file
+    if (wakeFd != -1) {
+        ::close(wakeFd);
+        wakeFd = -1;
+    }
+    if (epollFd != -1) {
+        ::close(epollFd);
+        epollFd = -1;
+    }
+    stdinWatched = false;
+    initialized = false;
+}
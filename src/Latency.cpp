@@ -0,0 +1,143 @@
+#include "../include/Latency.h"
+#include <fstream>
+#include <iomanip>
+#include <time.h>
+
+// 返回CLOCK_MONOTONIC时间（纳秒）
+int64_t monotonicNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+// 构造函数
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+// 记录一个延迟值
+void LatencyHistogram::record(int64_t nanos) {
+    int64_t micros = nanos > 0 ? nanos / 1000 : 0;
+
+    // 计算所在的桶（最高有效位）
+    int index = 0;
+    for (int64_t v = micros >> 1; v != 0 && index < BUCKET_COUNT - 1; v >>= 1) {
+        index++;
+    }
+
+    buckets[index].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumMicros.fetch_add(static_cast<uint64_t>(micros), std::memory_order_relaxed);
+
+    int64_t currentMax = maxMicros.load(std::memory_order_relaxed);
+    while (micros > currentMax &&
+           !maxMicros.compare_exchange_weak(currentMax, micros, std::memory_order_relaxed)) {
+    }
+}
+
+// 清空统计
+void LatencyHistogram::reset() {
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    sumMicros.store(0, std::memory_order_relaxed);
+    maxMicros.store(0, std::memory_order_relaxed);
+}
+
+// 获取平均值
+int64_t LatencyHistogram::getMeanMicros() const {
+    uint64_t n = getCount();
+    return n == 0 ? 0 : static_cast<int64_t>(sumMicros.load(std::memory_order_relaxed) / n);
+}
+
+// 估算百分位数
+int64_t LatencyHistogram::getPercentileMicros(double percentile) const {
+    uint64_t n = getCount();
+    if (n == 0) {
+        return 0;
+    }
+
+    uint64_t target = static_cast<uint64_t>(percentile / 100.0 * n);
+    if (target >= n) {
+        target = n - 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        seen += getBucket(i);
+        if (seen > target) {
+            // 返回桶上界，但不超过实际最大值
+            int64_t upper = (static_cast<int64_t>(1) << (i + 1)) - 1;
+            return upper < getMaxMicros() ? upper : getMaxMicros();
+        }
+    }
+    return getMaxMicros();
+}
+
+// 记录某个阶段的延迟
+void LatencyTracker::record(LatencyStage stage, int64_t nanos) {
+    histograms[static_cast<int>(stage)].record(nanos);
+}
+
+// 获取某个阶段的直方图
+const LatencyHistogram& LatencyTracker::getHistogram(LatencyStage stage) const {
+    return histograms[static_cast<int>(stage)];
+}
+
+// 清空所有阶段
+void LatencyTracker::reset() {
+    for (int i = 0; i < static_cast<int>(LatencyStage::COUNT); i++) {
+        histograms[i].reset();
+    }
+}
+
+// 获取阶段名称
+const char* LatencyTracker::stageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::KERNEL_TO_READER: return "kernel->reader";
+        case LatencyStage::READER_TO_TICK:   return "reader->tick";
+        case LatencyStage::TICK_TO_PRESENT:  return "tick->present";
+        case LatencyStage::END_TO_END:       return "end-to-end";
+        default:                             return "unknown";
+    }
+}
+
+// 输出文本报告
+void LatencyTracker::report(std::ostream& out) const {
+    out << "Input latency (microseconds):" << std::endl;
+    out << std::left << std::setw(16) << "stage" << std::right
+        << std::setw(8) << "count" << std::setw(10) << "mean"
+        << std::setw(10) << "p50" << std::setw(10) << "p90"
+        << std::setw(10) << "p99" << std::setw(10) << "max" << std::endl;
+
+    for (int i = 0; i < static_cast<int>(LatencyStage::COUNT); i++) {
+        const LatencyHistogram& h = histograms[i];
+        out << std::left << std::setw(16) << stageName(static_cast<LatencyStage>(i)) << std::right
+            << std::setw(8) << h.getCount() << std::setw(10) << h.getMeanMicros()
+            << std::setw(10) << h.getPercentileMicros(50) << std::setw(10) << h.getPercentileMicros(90)
+            << std::setw(10) << h.getPercentileMicros(99) << std::setw(10) << h.getMaxMicros() << std::endl;
+    }
+}
+
+// 将报告写入文件
+bool LatencyTracker::writeReport(const std::string& path) const {
+    std::ofstream file(path.c_str());
+    if (!file) {
+        return false;
+    }
+    report(file);
+
+    // 附带原始桶数据，便于外部工具绘制直方图
+    file << std::endl << "buckets (upper bound us: count):" << std::endl;
+    for (int i = 0; i < static_cast<int>(LatencyStage::COUNT); i++) {
+        file << stageName(static_cast<LatencyStage>(i)) << ":";
+        for (int b = 0; b < LatencyHistogram::BUCKET_COUNT; b++) {
+            if (histograms[i].getBucket(b) != 0) {
+                file << " " << ((static_cast<int64_t>(1) << (b + 1)) - 1) << ":" << histograms[i].getBucket(b);
+            }
+        }
+        file << std::endl;
+    }
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,97 @@
+#include "../include/LatencyBench.h"
+#include "../include/Game.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/input.h>
+
+namespace {
+    // 合成事件之间的间隔（毫秒），约为两到三个游戏帧，使蛇绕小圈移动
+    const int INJECT_INTERVAL_MS = 1000;
+
+    // 写入一条evdev事件记录，时间戳使用CLOCK_MONOTONIC
+    bool writeEvent(int fd, int type, int code, int value, int64_t timestamp) {
+        struct input_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+#ifdef input_event_sec
+        ev.input_event_sec = timestamp / 1000000000LL;
+        ev.input_event_usec = (timestamp % 1000000000LL) / 1000;
+#else
+        ev.time.tv_sec = timestamp / 1000000000LL;
+        ev.time.tv_usec = (timestamp % 1000000000LL) / 1000;
+#endif
+        ev.type = type;
+        ev.code = code;
+        ev.value = value;
+        return write(fd, &ev, sizeof(ev)) == sizeof(ev);
+    }
+}
+
+// 无头输入延迟测试
+int runLatencyBench(const std::string& resourcePath, int turnCount, const std::string& reportPath,
+                    const GameOptions& baseOptions) {
+    int fds[2];
+    if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) == -1) {
+        std::cerr << "Failed to create event pipe: " << strerror(errno) << std::endl;
+        return 1;
+    }
+
+    GameOptions options = baseOptions;
+    options.headless = true;
+    options.probeInputDevices = false;
+
+    int result = 1;
+    {
+        Game game(800, 480, 40, resourcePath, options);
+        if (!game.initialize() || !game.getInput().addDevice(fds[0], InputDeviceKind::KEYBOARD, "synthetic-pipe")) {
+            std::cerr << "Failed to initialize latency bench" << std::endl;
+            ::close(fds[0]);
+            ::close(fds[1]);
+            return 1;
+        }
+        game.start();
+
+        // 依次向上、左、下、右转，每次都与当前方向垂直，使蛇在原地绕圈
+        const int keys[4] = {KEY_UP, KEY_LEFT, KEY_DOWN, KEY_RIGHT};
+
+        std::cout << "Injecting " << turnCount << " synthetic turns..." << std::endl;
+        for (int i = 0; i < turnCount; i++) {
+            if (game.getState() == GameState::GAME_OVER) {
+                game.restart();
+            }
+
+            int64_t now = monotonicNanos();
+            if (!writeEvent(fds[1], EV_KEY, keys[i % 4], 1, now) ||
+                !writeEvent(fds[1], EV_SYN, SYN_REPORT, 0, now) ||
+                !writeEvent(fds[1], EV_KEY, keys[i % 4], 0, now) ||
+                !writeEvent(fds[1], EV_SYN, SYN_REPORT, 0, now)) {
+                std::cerr << "Failed to inject synthetic event: " << strerror(errno) << std::endl;
+                break;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(INJECT_INTERVAL_MS));
+        }
+
+        game.exit();
+        game.waitForThreads();
+
+        const LatencyTracker& latency = game.getLatencyTracker();
+        latency.report(std::cout);
+        game.reportRuntimeStats(std::cout);
+        if (!reportPath.empty() && !latency.writeReport(reportPath)) {
+            std::cerr << "Failed to write latency report: " << reportPath << std::endl;
+        }
+
+        if (!game.isAllocationFree()) {
+            std::cerr << "Steady-state ticks or frames allocated memory" << std::endl;
+        } else if (latency.getHistogram(LatencyStage::END_TO_END).getCount() > 0) {
+            result = 0;
+        }
+    }
+
+    // 读端已交给Input管理，随Game一起关闭
+    ::close(fds[1]);
+    return result;
+}
@@ -0,0 +1,321 @@
+#include "../include/Level.h"
+#include "../include/Checkpoint.h"
+#include "../include/Snake.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+    const char LEVEL_MAGIC[4] = {'S', 'N', 'K', 'L'};
+    const uint32_t LEVEL_VERSION = 1;
+
+    // 地图每边最多的格子数（与--board的限制相同）
+    const uint32_t MAX_LEVEL_SIZE = 4096;
+
+    // 文件头
+    struct LevelFileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t width;
+        uint32_t height;
+        uint32_t wallRunCount;
+        uint32_t spawnCount;
+        uint32_t zoneRunCount;
+        uint32_t crc;
+    };
+
+    // 方向对应的坐标变化
+    void directionDelta(uint8_t direction, int& dx, int& dy) {
+        dx = 0;
+        dy = 0;
+        switch (static_cast<Direction>(direction)) {
+            case Direction::UP: dy = -1; break;
+            case Direction::DOWN: dy = 1; break;
+            case Direction::LEFT: dx = -1; break;
+            default: dx = 1; break;
+        }
+    }
+
+    // 把一行中连续的同类格子合并为段
+    void appendRuns(const std::string& line, int y, char kind, std::vector<LevelRun>& runs) {
+        int x = 0;
+        int width = static_cast<int>(line.size());
+        while (x < width) {
+            if (line[x] != kind) {
+                x++;
+                continue;
+            }
+            int start = x;
+            while (x < width && line[x] == kind) {
+                x++;
+            }
+            LevelRun run;
+            run.x = static_cast<uint16_t>(start);
+            run.y = static_cast<uint16_t>(y);
+            run.length = static_cast<uint16_t>(x - start);
+            run.reserved = 0;
+            runs.push_back(run);
+        }
+    }
+}
+
+// 构造函数
+Level::Level()
+    : fd(-1), base(nullptr), fileSize(0), width(0), height(0), wallRuns(nullptr), wallRunCount(0),
+      spawns(nullptr), spawnCount(0), zoneRuns(nullptr), zoneRunCount(0) {
+}
+
+// 析构函数
+Level::~Level() {
+    close();
+}
+
+// 映射并检查关卡文件
+bool Level::load(const std::string& path) {
+    close();
+
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Failed to open level file: " << path << " (" << strerror(errno) << ")" << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(LevelFileHeader)) {
+        std::cerr << "Level file is too small: " << path << std::endl;
+        close();
+        return false;
+    }
+    fileSize = static_cast<size_t>(info.st_size);
+
+    void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to map level file: " << path << " (" << strerror(errno) << ")" << std::endl;
+        close();
+        return false;
+    }
+    base = static_cast<const uint8_t*>(mapped);
+
+    if (!validate(path)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+// 检查映射的内容是否合法
+bool Level::validate(const std::string& path) {
+    const LevelFileHeader* header = reinterpret_cast<const LevelFileHeader*>(base);
+    if (memcmp(header->magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) != 0 || header->version != LEVEL_VERSION) {
+        std::cerr << "Not a level file or unsupported version: " << path << std::endl;
+        return false;
+    }
+    if (header->width < 3 || header->height < 3 || header->width > MAX_LEVEL_SIZE || header->height > MAX_LEVEL_SIZE) {
+        std::cerr << "Invalid level size " << header->width << "x" << header->height << ": " << path << std::endl;
+        return false;
+    }
+    // 各段的数量不超过格子数，下面计算文件大小时不会溢出
+    uint64_t cells = static_cast<uint64_t>(header->width) * header->height;
+    if (header->wallRunCount > cells || header->spawnCount > cells || header->zoneRunCount > cells) {
+        std::cerr << "Invalid level section sizes: " << path << std::endl;
+        return false;
+    }
+    uint64_t expectedSize = sizeof(LevelFileHeader) +
+                            (static_cast<uint64_t>(header->wallRunCount) + header->zoneRunCount) * sizeof(LevelRun) +
+                            static_cast<uint64_t>(header->spawnCount) * sizeof(LevelSpawn);
+    if (expectedSize != fileSize) {
+        std::cerr << "Level file size does not match its header: " << path << std::endl;
+        return false;
+    }
+    const uint8_t* payload = base + sizeof(LevelFileHeader);
+    if (crc32Update(0, payload, fileSize - sizeof(LevelFileHeader)) != header->crc) {
+        std::cerr << "Level file is corrupted (CRC mismatch): " << path << std::endl;
+        return false;
+    }
+
+    width = static_cast<int>(header->width);
+    height = static_cast<int>(header->height);
+    wallRunCount = header->wallRunCount;
+    spawnCount = header->spawnCount;
+    zoneRunCount = header->zoneRunCount;
+    wallRuns = reinterpret_cast<const LevelRun*>(payload);
+    spawns = reinterpret_cast<const LevelSpawn*>(payload + wallRunCount * sizeof(LevelRun));
+    zoneRuns = reinterpret_cast<const LevelRun*>(payload + wallRunCount * sizeof(LevelRun) +
+                                                 spawnCount * sizeof(LevelSpawn));
+
+    // 墙位图
+    wallBits.assign((cells + 63) / 64, 0);
+    for (uint32_t i = 0; i < wallRunCount; i++) {
+        const LevelRun& run = wallRuns[i];
+        if (run.length == 0 || run.y >= height || run.x + run.length > width) {
+            std::cerr << "Wall outside the level: " << path << std::endl;
+            return false;
+        }
+        for (int x = run.x; x < run.x + run.length; x++) {
+            size_t cell = static_cast<size_t>(run.y) * width + x;
+            wallBits[cell >> 6] |= static_cast<uint64_t>(1) << (cell & 63);
+        }
+    }
+
+    // 至少要有玩家的出生点，出生点的三节蛇身必须都在地图内且不是墙
+    if (spawnCount == 0) {
+        std::cerr << "Level has no spawn point: " << path << std::endl;
+        return false;
+    }
+    for (uint32_t i = 0; i < spawnCount; i++) {
+        const LevelSpawn& spawn = spawns[i];
+        if (spawn.direction > static_cast<uint8_t>(Direction::RIGHT)) {
+            std::cerr << "Invalid spawn direction: " << path << std::endl;
+            return false;
+        }
+        int dx = 0;
+        int dy = 0;
+        directionDelta(spawn.direction, dx, dy);
+        for (int segment = 0; segment < 3; segment++) {
+            int x = spawn.x - dx * segment;
+            int y = spawn.y - dy * segment;
+            if (x < 0 || x >= width || y < 0 || y >= height || isWall(x, y)) {
+                std::cerr << "Spawn point blocked or outside the level: " << path << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // 食物区只能在内部格子（不含地图边缘）中，且不能是墙
+    zoneEnds.clear();
+    uint32_t zoneCells = 0;
+    for (uint32_t i = 0; i < zoneRunCount; i++) {
+        const LevelRun& run = zoneRuns[i];
+        if (run.length == 0 || run.y < 1 || run.y >= height - 1 || run.x < 1 || run.x + run.length > width - 1) {
+            std::cerr << "Food zone outside the level interior: " << path << std::endl;
+            return false;
+        }
+        for (int x = run.x; x < run.x + run.length; x++) {
+            if (isWall(x, run.y)) {
+                std::cerr << "Food zone overlaps a wall: " << path << std::endl;
+                return false;
+            }
+        }
+        zoneCells += run.length;
+        zoneEnds.push_back(zoneCells);
+    }
+    return true;
+}
+
+// 解除映射
+void Level::close() {
+    if (base) {
+        munmap(const_cast<uint8_t*>(base), fileSize);
+        base = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    width = 0;
+    height = 0;
+    wallRuns = nullptr;
+    wallRunCount = 0;
+    spawns = nullptr;
+    spawnCount = 0;
+    zoneRuns = nullptr;
+    zoneRunCount = 0;
+    wallBits.clear();
+    zoneEnds.clear();
+}
+
+// 按行优先顺序获取第index个食物区格子
+void Level::getZoneCell(uint32_t index, int& x, int& y) const {
+    // 二分查找第一个累计数大于index的段
+    size_t run = std::upper_bound(zoneEnds.begin(), zoneEnds.end(), index) - zoneEnds.begin();
+    uint32_t start = run == 0 ? 0 : zoneEnds[run - 1];
+    x = zoneRuns[run].x + static_cast<int>(index - start);
+    y = zoneRuns[run].y;
+}
+
+// 把文本关卡编译为关卡文件
+bool Level::compile(const std::string& textPath, const std::string& levelPath) {
+    std::ifstream in(textPath.c_str());
+    if (!in) {
+        std::cerr << "Failed to open level text: " << textPath << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> lines;
+    std::string line;
+    size_t maxWidth = 0;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line[line.size() - 1] == '\r') {
+            line.erase(line.size() - 1);
+        }
+        if (!line.empty() && line[0] == ';') {
+            continue;
+        }
+        maxWidth = std::max(maxWidth, line.size());
+        lines.push_back(line);
+    }
+
+    std::vector<LevelRun> walls;
+    std::vector<LevelSpawn> spawnPoints;
+    std::vector<LevelRun> zones;
+    for (size_t y = 0; y < lines.size(); y++) {
+        appendRuns(lines[y], static_cast<int>(y), '#', walls);
+        appendRuns(lines[y], static_cast<int>(y), '*', zones);
+        for (size_t x = 0; x < lines[y].size(); x++) {
+            Direction direction;
+            switch (lines[y][x]) {
+                case '^': direction = Direction::UP; break;
+                case 'v': direction = Direction::DOWN; break;
+                case '<': direction = Direction::LEFT; break;
+                case '>': direction = Direction::RIGHT; break;
+                default: continue;
+            }
+            LevelSpawn spawn;
+            memset(&spawn, 0, sizeof(spawn));
+            spawn.x = static_cast<uint16_t>(x);
+            spawn.y = static_cast<uint16_t>(y);
+            spawn.direction = static_cast<uint8_t>(direction);
+            spawnPoints.push_back(spawn);
+        }
+    }
+    if (maxWidth < 3 || lines.size() < 3 || maxWidth > MAX_LEVEL_SIZE || lines.size() > MAX_LEVEL_SIZE) {
+        std::cerr << "Level must be between 3x3 and " << MAX_LEVEL_SIZE << "x" << MAX_LEVEL_SIZE << " cells: "
+                  << textPath << std::endl;
+        return false;
+    }
+
+    // 数据部分按文件中的顺序拼接后计算CRC
+    std::vector<uint8_t> payload;
+    payload.insert(payload.end(), reinterpret_cast<const uint8_t*>(walls.data()),
+                   reinterpret_cast<const uint8_t*>(walls.data() + walls.size()));
+    payload.insert(payload.end(), reinterpret_cast<const uint8_t*>(spawnPoints.data()),
+                   reinterpret_cast<const uint8_t*>(spawnPoints.data() + spawnPoints.size()));
+    payload.insert(payload.end(), reinterpret_cast<const uint8_t*>(zones.data()),
+                   reinterpret_cast<const uint8_t*>(zones.data() + zones.size()));
+
+    LevelFileHeader header;
+    memcpy(header.magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+    header.version = LEVEL_VERSION;
+    header.width = static_cast<uint32_t>(maxWidth);
+    header.height = static_cast<uint32_t>(lines.size());
+    header.wallRunCount = static_cast<uint32_t>(walls.size());
+    header.spawnCount = static_cast<uint32_t>(spawnPoints.size());
+    header.zoneRunCount = static_cast<uint32_t>(zones.size());
+    header.crc = crc32Update(0, payload.data(), payload.size());
+
+    std::ofstream out(levelPath.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+    if (!out) {
+        std::cerr << "Failed to write level file: " << levelPath << std::endl;
+        return false;
+    }
+    std::cout << "Level " << header.width << "x" << header.height << ": " << walls.size() << " wall runs, "
+              << spawnPoints.size() << " spawn points, " << zones.size() << " food zone runs" << std::endl;
+    return true;
+}
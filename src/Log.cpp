@@ -0,0 +1,377 @@
+#include "../include/Log.h"
+#include "../include/Latency.h"
+#include "../include/ThreadStats.h"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <thread>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+namespace {
+    // 每秒的纳秒数（限速窗口）
+    const int64_t RATE_WINDOW_NANOS = 1000000000LL;
+
+    // 一个线程的环形缓冲区：所属线程写入记录后以release递增head，写线程读出后递增tail
+    struct LogBuffer {
+        std::atomic<uint64_t> head;
+        std::atomic<uint64_t> tail;
+        LogRecord records[Log::RECORDS_PER_THREAD];
+        LogBuffer* next;
+    };
+
+    // 所有线程的缓冲区（新缓冲区插入表头），保留到进程退出
+    std::atomic<LogBuffer*> buffers(nullptr);
+    thread_local LogBuffer* threadBuffer = nullptr;
+
+    // 未启动写线程时格式化用的记录
+    thread_local LogRecord scratch;
+
+    std::atomic<bool> running(false);
+    std::atomic<bool> stopping(false);
+    // 已经通知写线程、它还没有开始处理
+    std::atomic<bool> pending(false);
+    // 缓冲区满而丢弃的记录数
+    std::atomic<uint64_t> dropped(0);
+    int wakeFd = -1;
+    std::thread writer;
+
+    // 写出全部数据
+    void writeAll(int fd, const char* data, size_t length) {
+        while (length > 0) {
+            ssize_t written = ::write(fd, data, length);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            data += written;
+            length -= static_cast<size_t>(written);
+        }
+    }
+
+    // 记录写到标准输出还是标准错误
+    int outputFd(LogLevel level) {
+        return level >= LogLevel::WARN ? STDERR_FILENO : STDOUT_FILENO;
+    }
+
+    // 一个输出流的批量缓冲
+    struct Output {
+        int fd;
+        size_t length;
+        char data[4096];
+
+        explicit Output(int fd) : fd(fd), length(0) {}
+
+        void add(const char* text, size_t size) {
+            if (length + size > sizeof(data)) {
+                flush();
+            }
+            memcpy(data + length, text, size);
+            length += size;
+        }
+
+        void flush() {
+            writeAll(fd, data, length);
+            length = 0;
+        }
+    };
+
+    // 给记录加上换行（预留时保证了空间）
+    size_t finishLine(LogRecord& record) {
+        record.text[record.length] = '\n';
+        return record.length + 1;
+    }
+
+    // 写出所有缓冲区中的记录
+    void drain() {
+        Output out(STDOUT_FILENO);
+        Output err(STDERR_FILENO);
+        for (LogBuffer* buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+            uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+            uint64_t head = buffer->head.load(std::memory_order_acquire);
+            for (; tail < head; tail++) {
+                LogRecord& record = buffer->records[tail % Log::RECORDS_PER_THREAD];
+                size_t size = finishLine(record);
+                (outputFd(record.level) == STDERR_FILENO ? err : out).add(record.text, size);
+            }
+            buffer->tail.store(tail, std::memory_order_release);
+        }
+        uint64_t lost = dropped.exchange(0, std::memory_order_relaxed);
+        if (lost > 0) {
+            char note[64];
+            int size = snprintf(note, sizeof(note), "Log buffer full, dropped %llu messages\n",
+                                static_cast<unsigned long long>(lost));
+            err.add(note, static_cast<size_t>(size));
+        }
+        out.flush();
+        err.flush();
+    }
+
+    // 后台写线程：没有新记录时阻塞在eventfd上
+    void writerLoop() {
+        ThreadStats::nameThread("log");
+        while (true) {
+            uint64_t value;
+            if (read(wakeFd, &value, sizeof(value)) < 0 && errno != EINTR) {
+                break;
+            }
+            // 清除pending和读取各缓冲区的head之间需要全序屏障（与commit中的屏障配对），
+            // 否则写线程可能读到旧的head，而生产者同时看到pending仍为true、不再唤醒，记录留在缓冲区中
+            pending.store(false, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            drain();
+            if (stopping.load(std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        ThreadStats::sampleCurrentThread();
+    }
+
+    // 日志文本的哈希（FNV-1a），用于识别重复的日志
+    uint32_t hashText(const char* text, size_t length) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ static_cast<uint8_t>(text[i])) * 16777619u;
+        }
+        return hash;
+    }
+
+    // 为当前线程创建缓冲区
+    LogBuffer* createBuffer() {
+        LogBuffer* buffer = new LogBuffer();
+        buffer->head.store(0, std::memory_order_relaxed);
+        buffer->tail.store(0, std::memory_order_relaxed);
+        LogBuffer* head = buffers.load(std::memory_order_relaxed);
+        do {
+            buffer->next = head;
+        } while (!buffers.compare_exchange_weak(head, buffer, std::memory_order_release, std::memory_order_relaxed));
+        threadBuffer = buffer;
+        return buffer;
+    }
+}
+
+// 类内初始化的静态常量在按引用传递时需要定义
+const size_t LogRecord::TEXT_SIZE;
+const uint32_t LogSite::REPEATS_PER_SECOND;
+const size_t LogSite::TEXTS_PER_SITE;
+const size_t Log::RECORDS_PER_THREAD;
+
+// 本条是否输出
+bool LogSite::allow(uint32_t hash) {
+    int64_t now = monotonicNanos();
+    Entry* unused = nullptr;
+    for (Entry& entry : entries) {
+        int64_t start = entry.windowStart.load(std::memory_order_relaxed);
+        bool expired = start == 0 || now - start >= RATE_WINDOW_NANOS;
+        if (start != 0 && entry.hash.load(std::memory_order_relaxed) == hash) {
+            // 这种文本的窗口已过，重新开始计数
+            if (expired) {
+                entry.windowStart.store(now, std::memory_order_relaxed);
+                entry.windowCount.store(0, std::memory_order_relaxed);
+            }
+            if (entry.windowCount.fetch_add(1, std::memory_order_relaxed) < REPEATS_PER_SECOND) {
+                return true;
+            }
+            suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (expired && !unused) {
+            unused = &entry;
+        }
+    }
+    
+    // 新的文本占用一个空闲或窗口已过的位置；一秒内的文本种类太多时同样丢弃
+    if (!unused) {
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    unused->hash.store(hash, std::memory_order_relaxed);
+    unused->windowCount.store(1, std::memory_order_relaxed);
+    unused->windowStart.store(now, std::memory_order_relaxed);
+    return true;
+}
+
+// 开始一行日志
+LogLine::LogLine(LogLevel level, LogSite& site) : site(site), record(Log::reserve(reserved)) {
+    if (record) {
+        record->level = level;
+        record->length = 0;
+    }
+}
+
+// 提交一行日志
+LogLine::~LogLine() {
+    if (!record) {
+        return;
+    }
+    // 重复的日志不提交（预留的记录留给下一条使用）
+    if (!site.allow(hashText(record->text, record->length))) {
+        return;
+    }
+    uint64_t suppressed = site.takeSuppressed();
+    if (suppressed > 0) {
+        *this << " (" << static_cast<unsigned long long>(suppressed) << " rate-limited messages suppressed)";
+    }
+    Log::commit(record, reserved);
+}
+
+// 追加文本（超出记录长度的部分截断，保留一个字节给换行）
+void LogLine::append(const char* text, size_t length) {
+    if (!record) {
+        return;
+    }
+    size_t room = LogRecord::TEXT_SIZE - 1 - record->length;
+    if (length > room) {
+        length = room;
+    }
+    memcpy(record->text + record->length, text, length);
+    record->length += static_cast<uint32_t>(length);
+}
+
+LogLine& LogLine::operator<<(const char* text) {
+    append(text, strlen(text));
+    return *this;
+}
+
+LogLine& LogLine::operator<<(const std::string& text) {
+    append(text.data(), text.size());
+    return *this;
+}
+
+LogLine& LogLine::operator<<(char value) {
+    append(&value, 1);
+    return *this;
+}
+
+LogLine& LogLine::operator<<(int value) {
+    return *this << static_cast<long long>(value);
+}
+
+LogLine& LogLine::operator<<(unsigned int value) {
+    return *this << static_cast<unsigned long long>(value);
+}
+
+LogLine& LogLine::operator<<(long value) {
+    return *this << static_cast<long long>(value);
+}
+
+LogLine& LogLine::operator<<(unsigned long value) {
+    return *this << static_cast<unsigned long long>(value);
+}
+
+LogLine& LogLine::operator<<(long long value) {
+    char text[24];
+    int length = snprintf(text, sizeof(text), "%lld", value);
+    append(text, static_cast<size_t>(length));
+    return *this;
+}
+
+LogLine& LogLine::operator<<(unsigned long long value) {
+    char text[24];
+    int length = snprintf(text, sizeof(text), "%llu", value);
+    append(text, static_cast<size_t>(length));
+    return *this;
+}
+
+LogLine& LogLine::operator<<(double value) {
+    // 与std::ostream的默认格式一致（6位有效数字）
+    char text[32];
+    int length = snprintf(text, sizeof(text), "%g", value);
+    append(text, static_cast<size_t>(length));
+    return *this;
+}
+
+// 启动后台写线程
+void Log::start() {
+    if (running.load(std::memory_order_relaxed)) {
+        return;
+    }
+    wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (wakeFd < 0) {
+        // 没有写线程时日志直接写出，只是失去了异步
+        perror("Failed to create log eventfd");
+        return;
+    }
+    stopping.store(false, std::memory_order_relaxed);
+    writer = std::thread(writerLoop);
+    running.store(true, std::memory_order_release);
+}
+
+// 停止写线程（其他线程已经不再写日志时调用）
+void Log::stop() {
+    if (!running.load(std::memory_order_relaxed)) {
+        return;
+    }
+    stopping.store(true, std::memory_order_relaxed);
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) < 0) {
+        perror("Failed to wake log writer");
+    }
+    writer.join();
+    running.store(false, std::memory_order_relaxed);
+    // 写线程最后一次处理之后提交的记录
+    drain();
+    ::close(wakeFd);
+    wakeFd = -1;
+}
+
+// 预留一条记录
+LogRecord* Log::reserve(bool& reserved) {
+    if (!running.load(std::memory_order_acquire)) {
+        reserved = false;
+        return &scratch;
+    }
+    LogBuffer* buffer = threadBuffer ? threadBuffer : createBuffer();
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    if (head - buffer->tail.load(std::memory_order_acquire) >= RECORDS_PER_THREAD) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        reserved = false;
+        return nullptr;
+    }
+    reserved = true;
+    return &buffer->records[head % RECORDS_PER_THREAD];
+}
+
+// 提交预留的记录
+void Log::commit(LogRecord* record, bool reserved) {
+    if (!reserved) {
+        size_t size = finishLine(*record);
+        writeAll(outputFd(record->level), record->text, size);
+        return;
+    }
+    LogBuffer* buffer = threadBuffer;
+    buffer->head.store(buffer->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    // 发布head和检查pending之间的全序屏障：写线程要么读到新的head，要么这里读到它清除后的pending并唤醒它
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // 写线程已经被通知过时不再写eventfd，一批日志只有第一条需要系统调用
+    if (!pending.exchange(true, std::memory_order_acq_rel)) {
+        uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0) {
+            // 下一条日志再尝试唤醒
+            pending.store(false, std::memory_order_relaxed);
+        }
+    }
+}
+
+// 日志限速的自检
+int runLogCheck() {
+    const int lines = 100;
+    LogSite site;
+    for (int i = 0; i < lines; i++) {
+        // 与LOG_WARN展开后相同，只是语句的限速状态由这里持有，便于检查
+        LogLine(LogLevel::WARN, site) << "Log check: BMP file not found: " << (i % 2 == 0 ? "a.bmp" : "b.bmp");
+    }
+    // 两种文本各输出第一条，其余都在一秒内被丢弃
+    uint64_t suppressed = site.takeSuppressed();
+    uint64_t expected = static_cast<uint64_t>(lines - 2);
+    if (suppressed != expected) {
+        fprintf(stderr, "Log check FAILED: %llu of %d alternating messages suppressed, expected %llu\n",
+                static_cast<unsigned long long>(suppressed), lines, static_cast<unsigned long long>(expected));
+        return 1;
+    }
+    printf("Log check OK: %llu of %d alternating messages suppressed\n",
+           static_cast<unsigned long long>(suppressed), lines);
+    return 0;
+}
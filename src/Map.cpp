@@ -1,9 +1,22 @@
 #include "../include/Map.h"
+#include <algorithm>
+
+// 类内初始化的静态常量在按引用传递时需要定义
+const uint32_t Map::NO_CHUNK;
+const size_t Map::RESERVED_CHUNKS;
 
 // 构造函数
-Map::Map(int width, int height) : width(width), height(height) {
-    // 初始化地图网格
-    grid.resize(height, std::vector<MapElementType>(width, MapElementType::EMPTY));
+Map::Map(int width, int height)
+    : width(width), height(height), chunkColumns((width + CHUNK_MASK) >> CHUNK_SHIFT), interiorOccupied(0) {
+    // 初始化地图网格（只有块索引，格子在写入非空元素时才分配）
+    int chunkRows = (height + CHUNK_MASK) >> CHUNK_SHIFT;
+    chunkIndex.assign(static_cast<size_t>(chunkColumns) * chunkRows, NO_CHUNK);
+    rowOccupied.assign(height, 0);
+    // 块的计数和回收列表按所有块预留（每块只占几个字节），分配和回收块时不再增长
+    chunkOccupied.reserve(chunkIndex.size());
+    freeChunks.reserve(chunkIndex.size());
+    chunkSlots.reserve(chunkIndex.size());
+    chunkPool.reserve(std::min(chunkIndex.size(), RESERVED_CHUNKS) * CHUNK_CELLS);
 }
 
 // 获取地图宽度
@@ -23,8 +36,8 @@ MapElementType Map::getElement(int x, int y) const {
         // 如果坐标无效，返回墙壁类型（防止蛇越界）
         return MapElementType::WALL;
     }
-    
-    return grid[y][x];
+
+    return getCell(x, y);
 }
 
 // 设置指定位置的元素类型
@@ -33,16 +46,127 @@ void Map::setElement(int x, int y, MapElementType element) {
     if (x < 0 || x >= width || y < 0 || y >= height) {
         return; // 坐标无效，不执行操作
     }
-    
-    grid[y][x] = element;
+
+    setCell(x, y, element);
+}
+
+// 分配一个全空的块
+uint32_t Map::allocateChunk(int slot) {
+    // 回收的块在最后一个格子清空时才回收，其中的格子都已经是EMPTY
+    if (!freeChunks.empty()) {
+        uint32_t chunk = freeChunks.back();
+        freeChunks.pop_back();
+        chunkSlots[chunk] = slot;
+        return chunk;
+    }
+    uint32_t chunk = static_cast<uint32_t>(chunkOccupied.size());
+    chunkPool.resize(chunkPool.size() + CHUNK_CELLS, MapElementType::EMPTY);
+    chunkOccupied.push_back(0);
+    chunkSlots.push_back(slot);
+    return chunk;
+}
+
+// 设置指定位置的元素类型（不做边界检查）
+void Map::setCell(int x, int y, MapElementType element) {
+    int slot = chunkSlot(x, y);
+    uint32_t chunk = chunkIndex[slot];
+    if (chunk == NO_CHUNK) {
+        // 未分配的块中都是EMPTY
+        if (element == MapElementType::EMPTY) {
+            return;
+        }
+        chunk = allocateChunk(slot);
+        chunkIndex[slot] = chunk;
+    }
+
+    MapElementType& cell = chunkPool[chunk * CHUNK_CELLS + chunkOffset(x, y)];
+    bool wasEmpty = cell == MapElementType::EMPTY;
+    bool isEmpty = element == MapElementType::EMPTY;
+    cell = element;
+    if (wasEmpty == isEmpty) {
+        return;
+    }
+
+    // 更新占用计数，块中没有非空格子时回收
+    int delta = isEmpty ? -1 : 1;
+    chunkOccupied[chunk] += delta;
+    if (x > 0 && x < width - 1 && y > 0 && y < height - 1) {
+        rowOccupied[y] += delta;
+        interiorOccupied += delta;
+    }
+    if (chunkOccupied[chunk] == 0) {
+        chunkIndex[slot] = NO_CHUNK;
+        freeChunks.push_back(chunk);
+    }
 }
 
 // 清空地图
 void Map::clear() {
-    // 将所有元素设置为EMPTY
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            grid[y][x] = MapElementType::EMPTY;
+    // 只访问已分配的块：撤销块下标并清零它覆盖的行的计数（回收的块中没有非空格子，不需要处理）
+    for (size_t chunk = 0; chunk < chunkOccupied.size(); chunk++) {
+        if (chunkOccupied[chunk] == 0) {
+            continue;
+        }
+        int slot = chunkSlots[chunk];
+        chunkIndex[slot] = NO_CHUNK;
+        int firstRow = (slot / chunkColumns) << CHUNK_SHIFT;
+        int lastRow = std::min(firstRow + CHUNK_SIZE, height);
+        std::fill(rowOccupied.begin() + firstRow, rowOccupied.begin() + lastRow, 0);
+    }
+    
+    // 回收所有块（池的容量保留，之后分配块不再申请内存）
+    chunkPool.clear();
+    chunkOccupied.clear();
+    freeChunks.clear();
+    chunkSlots.clear();
+    interiorOccupied = 0;
+}
+
+// 内部格子中空格子的数量
+int Map::countEmptyInterior() const {
+    if (width < 3 || height < 3) {
+        return 0;
+    }
+    return (width - 2) * (height - 2) - interiorOccupied;
+}
+
+// 按行优先顺序查找第index个空的内部格子
+bool Map::findEmptyInterior(int index, int& x, int& y) const {
+    if (index < 0) {
+        return false;
+    }
+    for (int row = 1; row < height - 1; row++) {
+        // 用每行的计数跳过整行
+        int emptyInRow = (width - 2) - rowOccupied[row];
+        if (index >= emptyInRow) {
+            index -= emptyInRow;
+            continue;
         }
+
+        // 在这一行中逐块查找，未分配的块整块跳过
+        int column = 1;
+        while (column < width - 1) {
+            int chunkEnd = std::min((column | CHUNK_MASK) + 1, width - 1);
+            if (chunkIndex[chunkSlot(column, row)] == NO_CHUNK) {
+                int span = chunkEnd - column;
+                if (index < span) {
+                    x = column + index;
+                    y = row;
+                    return true;
+                }
+                index -= span;
+                column = chunkEnd;
+                continue;
+            }
+            for (; column < chunkEnd; column++) {
+                if (getCell(column, row) == MapElementType::EMPTY && index-- == 0) {
+                    x = column;
+                    y = row;
+                    return true;
+                }
+            }
+        }
+        return false;
     }
-}
\ No newline at end of file
+    return false;
+}
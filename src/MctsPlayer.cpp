@@ -0,0 +1,323 @@
+#include "../include/MctsPlayer.h"
+#include "../include/Latency.h"
+#include "../include/ThreadStats.h"
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+    const Direction DIRECTIONS[4] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+
+    // 每次迭代（树中选择加推演）最多模拟的帧数
+    const int HORIZON = 40;
+
+    // 每得一分的回报（活过整个推演的回报为1）
+    const double SCORE_WEIGHT = 0.25;
+
+    // UCB的探索系数
+    const double EXPLORATION = 0.7;
+
+    // 推演中走向最近食物的概率（百分比）
+    const unsigned int FOOD_BIAS = 70;
+
+    // 获取相反方向
+    Direction opposite(Direction direction) {
+        switch (direction) {
+            case Direction::UP: return Direction::DOWN;
+            case Direction::DOWN: return Direction::UP;
+            case Direction::LEFT: return Direction::RIGHT;
+            default: return Direction::LEFT;
+        }
+    }
+
+    // 沿方向移动一格
+    std::pair<int, int> stepFrom(std::pair<int, int> cell, Direction direction) {
+        switch (direction) {
+            case Direction::UP: cell.second--; break;
+            case Direction::DOWN: cell.second++; break;
+            case Direction::LEFT: cell.first--; break;
+            case Direction::RIGHT: cell.first++; break;
+        }
+        return cell;
+    }
+}
+
+// 工作状态
+MctsPlayer::Worker::Worker(const Simulation& sim, uint32_t seed)
+    : scratch(sim), rng(seed), rollouts(0) {
+    nodes.reserve(4096);
+    path.reserve(HORIZON + 1);
+}
+
+// 构造函数
+MctsPlayer::MctsPlayer(const MctsSettings& settings)
+    : settings(settings), threadCount(0), generation(0), pending(0), stopping(false), root(nullptr),
+      deadline(0), decisionCount(0), searchNanos(0) {
+}
+
+// 析构函数
+MctsPlayer::~MctsPlayer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCondition.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// 第一次决策时创建工作状态和后台线程
+void MctsPlayer::start(const Simulation& sim) {
+    threadCount = settings.threads > 0 ? settings.threads : static_cast<int>(std::thread::hardware_concurrency());
+    threadCount = std::max(1, threadCount);
+
+    // 草稿状态每次迭代都从根状态复制（复制时容量已经足够，不再分配内存）
+    for (int i = 0; i < threadCount; i++) {
+        workers.push_back(std::unique_ptr<Worker>(new Worker(sim, sim.getSeed() + 7919u * (i + 1))));
+    }
+    for (int i = 1; i < threadCount; i++) {
+        threads.push_back(std::thread(&MctsPlayer::workerLoop, this, i));
+    }
+}
+
+// 后台线程主循环
+void MctsPlayer::workerLoop(int index) {
+    ThreadStats::nameThread("mcts");
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCondition.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+
+        search(*workers[index]);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) {
+                doneCondition.notify_one();
+            }
+        }
+    }
+}
+
+// 分配一个新节点
+int32_t MctsPlayer::newNode(Worker& worker) {
+    Node node;
+    for (int i = 0; i < 4; i++) {
+        node.children[i] = -1;
+    }
+    node.visits = 0;
+    node.value = 0;
+    worker.nodes.push_back(node);
+    return static_cast<int32_t>(worker.nodes.size() - 1);
+}
+
+// 推演中选择方向
+Direction MctsPlayer::rolloutDirection(Worker& worker) {
+    const Simulation& sim = worker.scratch;
+    const Map& map = sim.getMap();
+    const Snake& snake = sim.getSnake();
+    Direction current = snake.getDirection();
+    std::pair<int, int> head = snake.getHead();
+
+    // 最近的非炸弹食物（曼哈顿距离）
+    int foodX = -1;
+    int foodY = -1;
+    int bestDistance = 0;
+    for (const auto& foodWithLifetime : sim.getFoods()) {
+        const Food& food = foodWithLifetime.food;
+        if (food.getType() == FoodType::BOMB) {
+            continue;
+        }
+        int distance = std::abs(food.getX() - head.first) + std::abs(food.getY() - head.second);
+        if (foodX < 0 || distance < bestDistance) {
+            foodX = food.getX();
+            foodY = food.getY();
+            bestDistance = distance;
+        }
+    }
+
+    // 不会立即撞上的方向（蛇尾在下一帧可能空出，这里保守地当作障碍）
+    Direction safe[3];
+    Direction closer[3];
+    int safeCount = 0;
+    int closerCount = 0;
+    for (Direction direction : DIRECTIONS) {
+        if (direction == opposite(current)) {
+            continue;
+        }
+        std::pair<int, int> next = stepFrom(head, direction);
+        if (!map.contains(next.first, next.second)) {
+            continue;
+        }
+        MapElementType element = map.getCell(next.first, next.second);
+        if (element == MapElementType::SNAKE_HEAD || element == MapElementType::SNAKE_BODY ||
+            element == MapElementType::WALL || element == MapElementType::FOOD_BOMB) {
+            continue;
+        }
+        safe[safeCount++] = direction;
+        if (foodX >= 0 && std::abs(foodX - next.first) + std::abs(foodY - next.second) < bestDistance) {
+            closer[closerCount++] = direction;
+        }
+    }
+
+    if (safeCount == 0) {
+        return current;
+    }
+    if (closerCount > 0 && worker.rng() % 100 < FOOD_BIAS) {
+        return closer[worker.rng() % closerCount];
+    }
+    return safe[worker.rng() % safeCount];
+}
+
+// 在截止时间之前搜索
+void MctsPlayer::search(Worker& worker) {
+    worker.nodes.clear();
+    newNode(worker);
+    uint32_t startScore = root->getScore();
+
+    do {
+        // 从根状态开始，隐藏真实的未来食物
+        worker.scratch = *root;
+        worker.scratch.reseedRandom(worker.rng());
+        worker.path.clear();
+        worker.path.push_back(0);
+
+        int32_t node = 0;
+        int depth = 0;
+        // 选择：沿UCB最大的子节点向下，遇到未扩展的动作时扩展一个节点后开始推演
+        while (!worker.scratch.isGameOver() && depth < HORIZON) {
+            Direction reverse = opposite(worker.scratch.getSnake().getDirection());
+            int action = -1;
+            bool expand = false;
+            for (int a = 0; a < 4; a++) {
+                if (DIRECTIONS[a] != reverse && worker.nodes[node].children[a] < 0) {
+                    action = a;
+                    expand = true;
+                    break;
+                }
+            }
+            if (!expand) {
+                double logVisits = std::log(static_cast<double>(worker.nodes[node].visits));
+                double bestScore = -1;
+                for (int a = 0; a < 4; a++) {
+                    if (DIRECTIONS[a] == reverse) {
+                        continue;
+                    }
+                    const Node& child = worker.nodes[worker.nodes[node].children[a]];
+                    double score = child.value / child.visits + EXPLORATION * std::sqrt(logVisits / child.visits);
+                    if (score > bestScore) {
+                        bestScore = score;
+                        action = a;
+                    }
+                }
+            }
+
+            int32_t child = expand ? newNode(worker) : worker.nodes[node].children[action];
+            worker.nodes[node].children[action] = child;
+            worker.scratch.turn(DIRECTIONS[action]);
+            worker.scratch.step();
+            depth++;
+            node = child;
+            worker.path.push_back(node);
+            if (expand) {
+                break;
+            }
+        }
+
+        // 推演
+        while (!worker.scratch.isGameOver() && depth < HORIZON) {
+            worker.scratch.turn(rolloutDirection(worker));
+            worker.scratch.step();
+            depth++;
+        }
+
+        // 回报：存活的比例加上得分
+        double reward = worker.scratch.isGameOver() ? static_cast<double>(depth) / HORIZON : 1.0;
+        reward += SCORE_WEIGHT * (worker.scratch.getScore() - startScore);
+        for (int32_t index : worker.path) {
+            worker.nodes[index].visits++;
+            worker.nodes[index].value += reward;
+        }
+        worker.rollouts++;
+    } while (monotonicNanos() < deadline);
+}
+
+// 为下一帧选择方向
+Direction MctsPlayer::chooseDirection(const Simulation& sim) {
+    Direction current = sim.getSnake().getDirection();
+    if (sim.isGameOver()) {
+        return current;
+    }
+    if (workers.empty()) {
+        start(sim);
+    }
+
+    int64_t startTime = monotonicNanos();
+    root = &sim;
+    deadline = startTime + static_cast<int64_t>(settings.budgetMs) * 1000000;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation++;
+        pending = threadCount - 1;
+    }
+    startCondition.notify_all();
+
+    search(*workers[0]);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        doneCondition.wait(lock, [&] { return pending == 0; });
+    }
+    root = nullptr;
+    searchNanos += monotonicNanos() - startTime;
+    decisionCount++;
+
+    // 合并各线程根节点的统计，选择访问次数最多的动作
+    uint64_t visits[4] = {0, 0, 0, 0};
+    double values[4] = {0, 0, 0, 0};
+    for (const auto& worker : workers) {
+        const Node& rootNode = worker->nodes[0];
+        for (int a = 0; a < 4; a++) {
+            if (rootNode.children[a] >= 0) {
+                visits[a] += worker->nodes[rootNode.children[a]].visits;
+                values[a] += worker->nodes[rootNode.children[a]].value;
+            }
+        }
+    }
+    Direction best = current;
+    uint64_t bestVisits = 0;
+    double bestMean = 0;
+    for (int a = 0; a < 4; a++) {
+        if (visits[a] == 0) {
+            continue;
+        }
+        double mean = values[a] / visits[a];
+        if (visits[a] > bestVisits || (visits[a] == bestVisits && mean > bestMean)) {
+            best = DIRECTIONS[a];
+            bestVisits = visits[a];
+            bestMean = mean;
+        }
+    }
+    return best;
+}
+
+// 推演总次数
+uint64_t MctsPlayer::getRolloutCount() const {
+    uint64_t total = 0;
+    for (const auto& worker : workers) {
+        total += worker->rollouts;
+    }
+    return total;
+}
+
+// 每秒推演次数
+double MctsPlayer::getRolloutsPerSecond() const {
+    return searchNanos > 0 ? getRolloutCount() * 1e9 / searchNanos : 0.0;
+}
@@ -0,0 +1,141 @@
+#include "../include/Minimap.h"
+#include <algorithm>
+
+// 类内初始化的静态常量在按引用传递时需要定义
+const uint32_t Minimap::BACKGROUND_COLOR;
+const uint32_t Minimap::SNAKE_COLOR;
+const uint32_t Minimap::FOOD_COLOR;
+const uint32_t Minimap::WALL_COLOR;
+
+// 构造函数
+Minimap::Minimap()
+    : worldWidth(0), worldHeight(0), pixelsPerCell(1), cellsPerPixel(1), blockColumns(0), blockRows(0) {
+}
+
+// 选择缩放比例
+void Minimap::configure(int width, int height, int maxWidth, int maxHeight) {
+    worldWidth = width;
+    worldHeight = height;
+    if (width <= 0 || height <= 0 || maxWidth <= 0 || maxHeight <= 0) {
+        blockColumns = 0;
+        blockRows = 0;
+        pixels.clear();
+        return;
+    }
+
+    if (width <= maxWidth && height <= maxHeight) {
+        // 放得下：每个格子放大成整数倍的像素块
+        pixelsPerCell = std::max(1, std::min(maxWidth / width, maxHeight / height));
+        cellsPerPixel = 1;
+    } else {
+        // 放不下：每个像素合并若干格子（向上取整，保证整个地图都在缩略图内）
+        pixelsPerCell = 1;
+        cellsPerPixel = std::max((width + maxWidth - 1) / maxWidth, (height + maxHeight - 1) / maxHeight);
+    }
+    blockColumns = (width + cellsPerPixel - 1) / cellsPerPixel;
+    blockRows = (height + cellsPerPixel - 1) / cellsPerPixel;
+
+    size_t blocks = static_cast<size_t>(blockColumns) * blockRows;
+    snakeCells.assign(blocks, 0);
+    foodCells.assign(blocks, 0);
+    wallCells.assign(blocks, 0);
+    wallBlocks.clear();
+    pixels.assign(static_cast<size_t>(getWidth()) * getHeight(), BACKGROUND_COLOR);
+}
+
+// 设置关卡的墙
+void Minimap::setWalls(const Level& level) {
+    if (!isConfigured()) {
+        return;
+    }
+    std::fill(wallCells.begin(), wallCells.end(), 0);
+    wallBlocks.clear();
+    for (size_t i = 0; i < level.getWallRunCount(); i++) {
+        const LevelRun& run = level.getWallRun(i);
+        if (run.y >= worldHeight) {
+            continue;
+        }
+        int end = std::min(static_cast<int>(run.x + run.length), worldWidth);
+        for (int x = run.x; x < end; x++) {
+            int block = (run.y / cellsPerPixel) * blockColumns + x / cellsPerPixel;
+            if (wallCells[block]++ == 0) {
+                wallBlocks.push_back(block);
+            }
+        }
+    }
+    clear();
+}
+
+// 清空蛇和食物的计数和像素
+void Minimap::clear() {
+    std::fill(snakeCells.begin(), snakeCells.end(), 0);
+    std::fill(foodCells.begin(), foodCells.end(), 0);
+    std::fill(pixels.begin(), pixels.end(), BACKGROUND_COLOR);
+    for (int block : wallBlocks) {
+        paintBlock(block);
+    }
+}
+
+// 按计数重画一个像素块（蛇优先于食物，食物优先于墙）
+void Minimap::paintBlock(int block) {
+    uint32_t color = BACKGROUND_COLOR;
+    if (snakeCells[block] > 0) {
+        color = SNAKE_COLOR;
+    } else if (foodCells[block] > 0) {
+        color = FOOD_COLOR;
+    } else if (wallCells[block] > 0) {
+        color = WALL_COLOR;
+    }
+
+    int width = getWidth();
+    int left = (block % blockColumns) * pixelsPerCell;
+    int top = (block / blockColumns) * pixelsPerCell;
+    for (int row = top; row < top + pixelsPerCell; row++) {
+        uint32_t* line = &pixels[static_cast<size_t>(row) * width + left];
+        std::fill(line, line + pixelsPerCell, color);
+    }
+}
+
+// 调整格子所在像素块的计数
+void Minimap::countCell(int x, int y, MapElementType element, int delta) {
+    if (x < 0 || x >= worldWidth || y < 0 || y >= worldHeight) {
+        return;
+    }
+    std::vector<uint16_t>* counts = nullptr;
+    if (isSnake(element)) {
+        counts = &snakeCells;
+    } else if (isFood(element)) {
+        counts = &foodCells;
+    } else {
+        return;
+    }
+
+    int block = (y / cellsPerPixel) * blockColumns + x / cellsPerPixel;
+    uint16_t& count = (*counts)[block];
+    bool wasEmpty = count == 0;
+    if (delta < 0 && count == 0) {
+        return;
+    }
+    count += delta;
+    // 只有计数在0和非0之间变化时颜色才可能改变
+    if (wasEmpty != (count == 0)) {
+        paintBlock(block);
+    }
+}
+
+// 加入一个格子
+void Minimap::addCell(int x, int y, MapElementType element) {
+    if (!isConfigured()) {
+        return;
+    }
+    countCell(x, y, element, 1);
+}
+
+// 应用一个格子的变化
+void Minimap::applyChange(const MapChange& change) {
+    if (!isConfigured()) {
+        return;
+    }
+    countCell(change.x, change.y, change.before, -1);
+    countCell(change.x, change.y, change.after, 1);
+}
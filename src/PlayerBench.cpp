@@ -0,0 +1,334 @@
+#include "../include/PlayerBench.h"
+#include "../include/Autopilot.h"
+#include "../include/HamiltonianPlayer.h"
+#include "../include/MctsPlayer.h"
+#include "../include/Display.h"
+#include "../include/Minimap.h"
+#include "../include/Latency.h"
+#include "../include/AllocationCounter.h"
+#include "../include/GameSnapshot.h"
+#include <iostream>
+#include <algorithm>
+
+namespace {
+    // 单局最多执行的帧数（每个格子），防止找不到食物时无限绕圈
+    const uint64_t MAX_TICKS_PER_CELL = 2000;
+
+    // 每隔多少帧测量一次drawSnake（绘制比游戏帧慢得多）
+    const uint64_t DRAW_SAMPLE_INTERVAL = 50;
+
+    // 分配检查前不检查的帧数（make ALLOC_COUNT=1时检查之后的游戏帧和绘制不分配内存）
+    const uint64_t ALLOCATION_WARMUP = 100;
+
+    // 绘制区域最大与游戏屏幕相同（800x480，每格40像素），地图更大时由摄像机跟随蛇头滚动
+    const int VIEW_COLUMNS = 20;
+    const int VIEW_ROWS = 12;
+    const int CELL_PIXELS = 40;
+
+    // 一个阶段的耗时统计
+    struct StageTimer {
+        LatencyHistogram histogram;
+        int64_t total;
+        int64_t max;
+        uint64_t count;
+
+        StageTimer() : total(0), max(0), count(0) {}
+
+        void record(int64_t nanos) {
+            histogram.record(nanos);
+            total += nanos;
+            max = std::max(max, nanos);
+            count++;
+        }
+
+        void report(const char* name) const {
+            if (count == 0) {
+                return;
+            }
+            std::cout << "  " << name << ": " << count << " samples, mean " << total / static_cast<int64_t>(count)
+                      << " ns, p99 " << histogram.getPercentileMicros(99) << " us, max " << max / 1000 << " us"
+                      << std::endl;
+        }
+    };
+
+    const char* playerName(PlayerKind player) {
+        switch (player) {
+            case PlayerKind::SOLVER: return "Hamiltonian solver";
+            case PlayerKind::MCTS: return "MCTS";
+            default: return "Autopilot";
+        }
+    }
+}
+
+// 无头自动玩家测试
+int runPlayerBench(PlayerKind player, int games, uint32_t seed, int mapWidth, int mapHeight,
+                   const std::string& resourcePath, const MctsSettings& mcts) {
+    if (player == PlayerKind::SOLVER && !HamiltonianPlayer::cycleExists(mapWidth, mapHeight)) {
+        std::cerr << "No Hamiltonian cycle exists for a " << mapWidth << "x" << mapHeight << " board" << std::endl;
+        return 1;
+    }
+
+    std::cout << playerName(player) << " bench: " << games << " games on " << mapWidth << "x" << mapHeight
+              << ", seed " << seed << std::endl;
+
+    // 给出资源路径时在内存帧缓冲区上测量绘制
+    Display display(std::min(mapWidth, VIEW_COLUMNS) * CELL_PIXELS, std::min(mapHeight, VIEW_ROWS) * CELL_PIXELS,
+                    CELL_PIXELS);
+    bool drawing = false;
+    if (!resourcePath.empty()) {
+        drawing = display.initializeHeadless() && display.loadResources(resourcePath);
+        if (!drawing) {
+            std::cerr << "Failed to set up headless display, skipping drawSnake timing" << std::endl;
+        } else {
+            // 先缓存背景，之后摄像机移动时只滚动背景缓冲区
+            display.setWorldSize(mapWidth, mapHeight);
+            display.drawMap(nullptr);
+        }
+    }
+    
+    // 地图大于视口时同时测量小地图的增量更新和绘制
+    Minimap minimap;
+    if (drawing && (mapWidth > VIEW_COLUMNS || mapHeight > VIEW_ROWS)) {
+        minimap.configure(mapWidth, mapHeight, display.getScreenWidth() / 5, display.getScreenHeight() / 5);
+    }
+
+    Simulation sim(mapWidth, mapHeight);
+    Autopilot autopilot;
+    HamiltonianPlayer solver;
+    MctsPlayer mctsPlayer(mcts);
+    const size_t cellCount = static_cast<size_t>(mapWidth) * mapHeight;
+    const size_t nearFullLength = cellCount * 9 / 10;
+    const uint64_t maxTicks = MAX_TICKS_PER_CELL * cellCount;
+
+    StageTimer chooseTime, stepTime, drawTime, scrollTime, minimapTime, nearFullStep, nearFullDraw;
+    AllocationCheck stepAllocations("game tick", ALLOCATION_WARMUP);
+    AllocationCheck drawAllocations("drawSnake", ALLOCATION_WARMUP / DRAW_SAMPLE_INTERVAL);
+    uint64_t totalTicks = 0;
+    size_t totalLength = 0;
+    size_t maxLength = 0;
+    int filled = 0;
+    int timedOut = 0;
+
+    int64_t startTime = monotonicNanos();
+    for (int game = 0; game < games; game++) {
+        sim.reset(seed + game);
+        autopilot.reset();
+        size_t lastDrawnLength = 0;
+        if (minimap.isConfigured()) {
+            minimap.clear();
+            for (size_t i = 0; i < sim.getSnake().getLength(); i++) {
+                minimap.addCell(sim.getSnake().getSegment(i).first, sim.getSnake().getSegment(i).second,
+                                MapElementType::SNAKE_BODY);
+            }
+            for (const auto& foodWithLifetime : sim.getFoods()) {
+                const Food& food = foodWithLifetime.food;
+                minimap.addCell(food.getX(), food.getY(), food.getMapElement());
+            }
+        }
+
+        while (!sim.isGameOver() && sim.getTick() < maxTicks) {
+            int64_t t0 = monotonicNanos();
+            Direction direction;
+            if (player == PlayerKind::SOLVER) {
+                direction = solver.chooseDirection(sim);
+            } else if (player == PlayerKind::MCTS) {
+                direction = mctsPlayer.chooseDirection(sim);
+            } else {
+                direction = autopilot.chooseDirection(sim);
+            }
+            int64_t t1 = monotonicNanos();
+            stepAllocations.begin();
+            sim.turn(direction);
+            sim.step();
+            stepAllocations.end();
+            int64_t t2 = monotonicNanos();
+
+            size_t length = sim.getSnake().getLength();
+            chooseTime.record(t1 - t0);
+            stepTime.record(t2 - t1);
+            if (length >= nearFullLength) {
+                nearFullStep.record(t2 - t1);
+            }
+
+            // 摄像机每帧跟随蛇头，移动时测量背景滚动
+            if (drawing && !sim.isGameOver()) {
+                int cameraX = display.getCamera().getX();
+                int cameraY = display.getCamera().getY();
+                int64_t scrollStart = monotonicNanos();
+                display.followHead(sim.getSnake().getHead().first, sim.getSnake().getHead().second);
+                if (display.getCamera().getX() != cameraX || display.getCamera().getY() != cameraY) {
+                    scrollTime.record(monotonicNanos() - scrollStart);
+                }
+            }
+            
+            // 小地图每帧只应用改变的格子
+            if (minimap.isConfigured() && !sim.isGameOver()) {
+                int64_t minimapStart = monotonicNanos();
+                for (const auto& change : sim.getChanges()) {
+                    minimap.applyChange(change);
+                }
+                display.drawMinimap(minimap, sim.getSnake().getHead().first, sim.getSnake().getHead().second);
+                minimapTime.record(monotonicNanos() - minimapStart);
+            }
+
+            // 接近占满时每次长度变化都测量一次
+            bool sample = sim.getTick() % DRAW_SAMPLE_INTERVAL == 0 ||
+                          (length >= nearFullLength && length != lastDrawnLength);
+            if (drawing && !sim.isGameOver() && sample) {
+                lastDrawnLength = length;
+                int64_t drawStart = monotonicNanos();
+                drawAllocations.begin();
+                display.drawSnake(&sim.getSnake());
+                drawAllocations.end();
+                int64_t elapsed = monotonicNanos() - drawStart;
+                drawTime.record(elapsed);
+                if (length >= nearFullLength) {
+                    nearFullDraw.record(elapsed);
+                }
+            }
+
+            // 蛇占满地图，没有空位再生成食物
+            if (length >= cellCount) {
+                break;
+            }
+        }
+
+        size_t length = sim.getSnake().getLength();
+        if (length >= cellCount) {
+            filled++;
+        } else if (!sim.isGameOver()) {
+            timedOut++;
+        }
+        totalTicks += sim.getTick();
+        totalLength += length;
+        maxLength = std::max(maxLength, length);
+    }
+    double seconds = (monotonicNanos() - startTime) / 1e9;
+
+    if (games <= 0 || totalTicks == 0) {
+        std::cerr << "No ticks were played" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Played " << totalTicks << " ticks in " << seconds << " s";
+    if (seconds > 0) {
+        std::cout << " (" << static_cast<uint64_t>(totalTicks / seconds) << " ticks/s)";
+    }
+    std::cout << std::endl;
+    std::cout << "Ticks per game " << totalTicks / games << ", final length mean "
+              << static_cast<double>(totalLength) / games << ", max " << maxLength << " of " << cellCount
+              << ", filled the board " << filled << ", hit tick limit " << timedOut << std::endl;
+    std::cout << "Timing per tick:" << std::endl;
+    chooseTime.report("choose direction");
+    stepTime.report("game tick");
+    drawTime.report("drawSnake (sampled)");
+    scrollTime.report("camera scroll");
+    minimapTime.report("minimap update");
+    // 没有一局达到这个长度时只说明没有样本，不输出空的小节
+    std::cout << "Timing with length >= " << nearFullLength << ":";
+    if (nearFullStep.count == 0) {
+        std::cout << " no samples" << std::endl;
+    } else {
+        std::cout << std::endl;
+        nearFullStep.report("game tick");
+        nearFullDraw.report("drawSnake");
+    }
+    if (player == PlayerKind::AUTOPILOT) {
+        std::cout << "Full plans " << autopilot.getPlanCount() << ", reused paths " << autopilot.getReuseCount()
+                  << std::endl;
+    }
+    if (player == PlayerKind::MCTS) {
+        std::cout << "MCTS: " << mctsPlayer.getThreadCount() << " threads, " << mcts.budgetMs << " ms per decision, "
+                  << mctsPlayer.getRolloutCount() << " rollouts, "
+                  << static_cast<uint64_t>(mctsPlayer.getRolloutsPerSecond()) << " rollouts/s, "
+                  << mctsPlayer.getRolloutCount() / std::max<uint64_t>(mctsPlayer.getDecisionCount(), 1)
+                  << " per decision" << std::endl;
+    }
+    stepAllocations.report(std::cout);
+    drawAllocations.report(std::cout);
+    if (!stepAllocations.isClean() || !drawAllocations.isClean()) {
+        std::cerr << "Steady-state ticks allocated memory" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// 对手蛇数量测试
+int runRivalBench(int ticks, size_t maxRivals, uint32_t seed, int mapWidth, int mapHeight) {
+    if (ticks <= 0) {
+        std::cerr << "Rival bench needs at least one tick" << std::endl;
+        return 1;
+    }
+    std::cout << "Rival bench: " << ticks << " ticks per snake count on " << mapWidth << "x" << mapHeight
+              << ", seed " << seed << std::endl;
+
+    size_t rivalCount = 0;
+    while (true) {
+        SimulationRules rules;
+        rules.rivalSnakes = rivalCount;
+        Simulation sim(mapWidth, mapHeight, rules);
+        uint32_t gameSeed = seed;
+        sim.reset(gameSeed);
+        std::mt19937 playerRng(seed);
+
+        StageTimer stepTime;
+        uint64_t aliveTotal = 0;
+        int games = 1;
+        for (int tick = 0; tick < ticks; tick++) {
+            if (sim.isGameOver()) {
+                sim.reset(++gameSeed);
+                games++;
+            }
+            sim.turn(sim.greedyDirection(sim.getSnake(), playerRng));
+            int64_t stepStart = monotonicNanos();
+            sim.step();
+            stepTime.record(monotonicNanos() - stepStart);
+            for (const auto& rival : sim.getRivals()) {
+                aliveTotal += rival.isAlive() ? 1 : 0;
+            }
+        }
+
+        std::cout << rivalCount << " rivals, " << static_cast<double>(aliveTotal) / ticks << " alive on average, "
+                  << games << " games:" << std::endl;
+        stepTime.report("game tick");
+
+        if (rivalCount >= maxRivals) {
+            break;
+        }
+        rivalCount = std::min(maxRivals, rivalCount == 0 ? 1 : rivalCount * 2);
+    }
+    return 0;
+}
+
+// 重新开局测试
+int runResetBench(uint32_t seed, int mapWidth, int mapHeight) {
+    if (!HamiltonianPlayer::cycleExists(mapWidth, mapHeight)) {
+        std::cerr << "No Hamiltonian cycle exists for a " << mapWidth << "x" << mapHeight << " board" << std::endl;
+        return 1;
+    }
+    std::cout << "Reset bench on " << mapWidth << "x" << mapHeight << ", seed " << seed << std::endl;
+
+    Simulation sim(mapWidth, mapHeight);
+    HamiltonianPlayer solver;
+    GameSnapshot snapshot;
+    size_t maxLength = static_cast<size_t>(mapWidth) * mapHeight / 2;
+    for (size_t target = 16; target <= maxLength; target *= 2) {
+        sim.reset(seed);
+        uint64_t maxTicks = static_cast<uint64_t>(mapWidth) * mapHeight * MAX_TICKS_PER_CELL;
+        while (!sim.isGameOver() && sim.getSnake().getLength() < target && sim.getTick() < maxTicks) {
+            sim.turn(solver.chooseDirection(sim));
+            sim.step();
+        }
+        size_t length = sim.getSnake().getLength();
+        size_t chunks = sim.getMap().getAllocatedChunks();
+
+        int64_t resetStart = monotonicNanos();
+        sim.reset(seed);
+        snapshot.capture(sim);
+        int64_t resetNanos = monotonicNanos() - resetStart;
+
+        std::cout << "previous length " << length << ", " << chunks << " map chunks: reset "
+                  << resetNanos / 1000.0 << " us" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include "../include/ProfiledMutex.h"
+
+#ifdef PROFILE_LOCKS
+
+#include <atomic>
+#include <cstring>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace {
+    // 保留的最长持有次数
+    const int LONGEST_HOLDS = 8;
+
+    // 一次持有
+    struct HoldRecord {
+        int64_t nanos;
+        const LockSite* site;
+        long threadId;
+        char threadName[16];
+    };
+
+    // 所有加锁位置的链表（新位置插入表头）
+    std::atomic<LockSite*> sites(nullptr);
+
+    // 未通过PROFILED_LOCK加锁时统计到这里
+    LockSite untaggedSite("(untagged)", "", "mutex");
+
+    // 最长的几次持有，按时间从长到短；只有超过当前最短一条时才加锁更新
+    std::mutex holdsMutex;
+    HoldRecord longestHolds[LONGEST_HOLDS];
+    int holdCount = 0;
+    std::atomic<int64_t> holdThreshold(0);
+
+    // 记录一次持有
+    void recordHold(int64_t nanos, const LockSite* site) {
+        if (nanos <= holdThreshold.load(std::memory_order_relaxed)) {
+            return;
+        }
+        HoldRecord record;
+        record.nanos = nanos;
+        record.site = site;
+        record.threadId = syscall(SYS_gettid);
+        if (pthread_getname_np(pthread_self(), record.threadName, sizeof(record.threadName)) != 0) {
+            record.threadName[0] = '\0';
+        }
+
+        std::lock_guard<std::mutex> lock(holdsMutex);
+        int position;
+        if (holdCount < LONGEST_HOLDS) {
+            position = holdCount++;
+        } else if (longestHolds[LONGEST_HOLDS - 1].nanos < nanos) {
+            position = LONGEST_HOLDS - 1;
+        } else {
+            return;
+        }
+        while (position > 0 && longestHolds[position - 1].nanos < nanos) {
+            longestHolds[position] = longestHolds[position - 1];
+            position--;
+        }
+        longestHolds[position] = record;
+        if (holdCount == LONGEST_HOLDS) {
+            holdThreshold.store(longestHolds[LONGEST_HOLDS - 1].nanos, std::memory_order_relaxed);
+        }
+    }
+
+    // 输出一个直方图的摘要
+    void reportHistogram(std::ostream& out, const char* label, const LatencyHistogram& histogram) {
+        out << label << " mean " << histogram.getMeanMicros() << " us, p99 " << histogram.getPercentileMicros(99)
+            << " us, max " << histogram.getMaxMicros() << " us";
+    }
+}
+
+// 构造加锁位置并加入链表
+LockSite::LockSite(const char* function, const char* location, const char* mutexName)
+    : function(function), location(location), mutexName(mutexName), next(nullptr) {
+    LockSite* head = sites.load(std::memory_order_relaxed);
+    do {
+        next = head;
+    } while (!sites.compare_exchange_weak(head, this, std::memory_order_release, std::memory_order_relaxed));
+}
+
+// 构造函数
+ProfiledMutex::ProfiledMutex() : holderSite(nullptr), acquiredAt(0) {
+}
+
+// 在指定位置加锁
+void ProfiledMutex::lock(LockSite& site) {
+    int64_t start = monotonicNanos();
+    mutex.lock();
+    acquiredAt = monotonicNanos();
+    holderSite = &site;
+    site.waitTime.record(acquiredAt - start);
+}
+
+// 未标记位置的加锁
+void ProfiledMutex::lock() {
+    lock(untaggedSite);
+}
+
+// 尝试加锁（不等待，不记录等待时间）
+bool ProfiledMutex::try_lock() {
+    if (!mutex.try_lock()) {
+        return false;
+    }
+    acquiredAt = monotonicNanos();
+    holderSite = &untaggedSite;
+    untaggedSite.waitTime.record(0);
+    return true;
+}
+
+// 释放锁，释放前记录持有时间
+void ProfiledMutex::unlock() {
+    int64_t held = monotonicNanos() - acquiredAt;
+    LockSite* site = holderSite;
+    site->holdTime.record(held);
+    recordHold(held, site);
+    mutex.unlock();
+}
+
+// 输出各加锁位置的统计和最长的几次持有
+void reportLockProfile(std::ostream& out) {
+    out << "Lock profile:" << std::endl;
+    for (LockSite* site = sites.load(std::memory_order_acquire); site; site = site->next) {
+        uint64_t count = site->waitTime.getCount();
+        if (count == 0) {
+            continue;
+        }
+        out << "  " << site->mutexName << " in " << site->function << " (" << site->location << "): " << count
+            << " acquisitions, ";
+        reportHistogram(out, "wait", site->waitTime);
+        out << "; ";
+        reportHistogram(out, "hold", site->holdTime);
+        out << std::endl;
+    }
+
+    std::lock_guard<std::mutex> lock(holdsMutex);
+    if (holdCount > 0) {
+        out << "Longest holds:" << std::endl;
+    }
+    for (int i = 0; i < holdCount; i++) {
+        const HoldRecord& record = longestHolds[i];
+        out << "  " << record.nanos / 1000 << " us " << record.site->mutexName << " in " << record.site->function
+            << " (" << record.site->location << ") by thread " << record.threadId;
+        if (record.threadName[0] != '\0') {
+            out << " \"" << record.threadName << "\"";
+        }
+        out << std::endl;
+    }
+}
+
+#else
+
+// 未启用竞争统计
+void reportLockProfile(std::ostream&) {
+}
+
+#endif // PROFILE_LOCKS
@@ -0,0 +1,219 @@
+#include "../include/Replay.h"
+#include "../include/Simulation.h"
+#include "../include/Latency.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+
+namespace {
+    const char REPLAY_MAGIC[4] = {'S', 'N', 'K', 'R'};
+    const uint64_t REPLAY_VERSION = 1;
+
+    // 地图每边的格子数范围（与关卡的限制相同），超出时拒绝录像，调用者不必再检查
+    const uint64_t MIN_REPLAY_SIZE = 3;
+    const uint64_t MAX_REPLAY_SIZE = 4096;
+
+    // 从缓冲区读取一个变长整数
+    bool readVarint(const std::vector<uint8_t>& data, size_t& pos, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos < data.size(); shift += 7) {
+            uint8_t byte = data[pos++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+// 构造函数
+ReplayWriter::ReplayWriter() : file(nullptr), lastTick(0) {
+}
+
+// 析构函数
+ReplayWriter::~ReplayWriter() {
+    // 没有正常结束的录像只关闭文件，不写结束标记
+    if (file) {
+        fclose(file);
+    }
+}
+
+// 写入一个变长整数
+void ReplayWriter::writeVarint(uint64_t value) {
+    uint8_t buf[10];
+    size_t len = 0;
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        buf[len++] = value ? (byte | 0x80) : byte;
+    } while (value);
+    fwrite(buf, 1, len, file);
+}
+
+// 创建录像文件并写入文件头
+bool ReplayWriter::open(const std::string& path, int width, int height, uint32_t seed) {
+    file = fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Failed to create replay file: " << path << " (" << strerror(errno) << ")" << std::endl;
+        return false;
+    }
+
+    fwrite(REPLAY_MAGIC, 1, sizeof(REPLAY_MAGIC), file);
+    writeVarint(REPLAY_VERSION);
+    writeVarint(width);
+    writeVarint(height);
+    writeVarint(seed);
+    lastTick = 0;
+    return true;
+}
+
+// 记录一个转向（只写入stdio缓冲区，不会在游戏帧中阻塞于磁盘）
+void ReplayWriter::recordTurn(uint64_t tick, Direction direction) {
+    if (!file || tick <= lastTick) {
+        return;
+    }
+    writeVarint(((tick - lastTick) << 2) | static_cast<uint64_t>(direction));
+    lastTick = tick;
+}
+
+// 写入结束标记并关闭文件
+void ReplayWriter::finish(uint64_t finalTick, size_t finalLength) {
+    if (!file) {
+        return;
+    }
+    writeVarint(0);
+    writeVarint(finalTick);
+    writeVarint(finalLength);
+    fclose(file);
+    file = nullptr;
+}
+
+// 构造函数
+ReplayReader::ReplayReader()
+    : width(0), height(0), seed(0), nextTurn(0), finalTick(0), finalLength(0), complete(false) {
+}
+
+// 读取整个录像文件
+bool ReplayReader::load(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Failed to open replay file: " << path << " (" << strerror(errno) << ")" << std::endl;
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    fclose(file);
+
+    // 检查文件头
+    uint64_t version, w, h, s;
+    size_t pos = sizeof(REPLAY_MAGIC);
+    if (data.size() < pos || memcmp(data.data(), REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) != 0 ||
+        !readVarint(data, pos, version) || version != REPLAY_VERSION ||
+        !readVarint(data, pos, w) || !readVarint(data, pos, h) || !readVarint(data, pos, s)) {
+        std::cerr << "Invalid replay file: " << path << std::endl;
+        return false;
+    }
+    if (w < MIN_REPLAY_SIZE || h < MIN_REPLAY_SIZE || w > MAX_REPLAY_SIZE || h > MAX_REPLAY_SIZE) {
+        std::cerr << "Invalid replay file: " << path << " (map size " << w << "x" << h << " is outside "
+                  << MIN_REPLAY_SIZE << "x" << MIN_REPLAY_SIZE << " to " << MAX_REPLAY_SIZE << "x" << MAX_REPLAY_SIZE
+                  << ")" << std::endl;
+        return false;
+    }
+    width = static_cast<int>(w);
+    height = static_cast<int>(h);
+    seed = static_cast<uint32_t>(s);
+
+    // 读取转向记录，直到结束标记或文件末尾
+    turns.clear();
+    complete = false;
+    uint64_t tick = 0;
+    uint64_t record;
+    while (readVarint(data, pos, record)) {
+        if (record == 0) {
+            uint64_t length;
+            complete = readVarint(data, pos, finalTick) && readVarint(data, pos, length);
+            finalLength = static_cast<size_t>(length);
+            break;
+        }
+        tick += record >> 2;
+        ReplayTurn turn;
+        turn.tick = tick;
+        turn.direction = static_cast<Direction>(record & 3);
+        turns.push_back(turn);
+    }
+
+    nextTurn = 0;
+    return true;
+}
+
+// 取出应在指定帧之前应用的转向
+bool ReplayReader::takeTurn(uint64_t tick, Direction& direction) {
+    // 跳过已经错过的转向（正常回放时不会发生）
+    while (nextTurn < turns.size() && turns[nextTurn].tick < tick) {
+        nextTurn++;
+    }
+    if (nextTurn < turns.size() && turns[nextTurn].tick == tick) {
+        direction = turns[nextTurn++].direction;
+        return true;
+    }
+    return false;
+}
+
+// 无头快进回放
+int runReplayFastForward(const std::string& path) {
+    ReplayReader replay;
+    if (!replay.load(path)) {
+        return 1;
+    }
+
+    std::cout << "Replay " << path << ": " << replay.getWidth() << "x" << replay.getHeight()
+              << ", seed " << replay.getSeed() << ", " << replay.getTurnCount() << " turns" << std::endl;
+
+    Simulation sim(replay.getWidth(), replay.getHeight());
+    sim.reset(replay.getSeed());
+
+    int64_t startTime = monotonicNanos();
+    // 录像不完整时一直执行到游戏结束（没有转向后蛇总会撞墙）
+    while (!sim.isGameOver()) {
+        if (replay.isComplete() && sim.getTick() >= replay.getFinalTick()) {
+            break;
+        }
+
+        Direction direction;
+        if (replay.takeTurn(sim.getTick() + 1, direction)) {
+            sim.turn(direction);
+        }
+        sim.step();
+    }
+    int64_t elapsed = monotonicNanos() - startTime;
+
+    double seconds = elapsed / 1e9;
+    std::cout << "Played " << sim.getTick() << " ticks (" << sim.getTimeMs() / 1000.0
+              << " s of game time) in " << seconds * 1000.0 << " ms";
+    if (seconds > 0) {
+        std::cout << ", " << static_cast<uint64_t>(sim.getTick() / seconds) << " ticks/s";
+    }
+    std::cout << std::endl;
+    std::cout << "Final length: " << sim.getSnake().getLength()
+              << (sim.isGameOver() ? " (game over)" : "") << std::endl;
+
+    if (!replay.isComplete()) {
+        std::cout << "Replay has no end marker, result cannot be verified" << std::endl;
+        return 0;
+    }
+
+    if (sim.getTick() != replay.getFinalTick() || sim.getSnake().getLength() != replay.getFinalLength()) {
+        std::cerr << "Replay diverged: recorded " << replay.getFinalTick() << " ticks, length "
+                  << replay.getFinalLength() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Replay reproduced exactly" << std::endl;
+    return 0;
+}
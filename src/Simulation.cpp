@@ -0,0 +1,793 @@
+#include "../include/Simulation.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+// 检查点直接按内存布局保存RNG状态
+static_assert(sizeof(std::mt19937) <= CHECKPOINT_RNG_SIZE, "RNG state does not fit in a checkpoint");
+static_assert(std::is_trivially_copyable<std::mt19937>::value, "RNG state cannot be copied bytewise");
+
+// 预先为蛇分配的最大长度（64K节，512KB）
+static const size_t MAX_RESERVED_SNAKE_LENGTH = 65536;
+
+// 预先为每条对手蛇分配的长度，更长时按需加倍
+static const size_t RESERVED_RIVAL_LENGTH = 256;
+
+namespace {
+    const Direction DIRECTIONS[4] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+
+    // 获取相反方向
+    Direction opposite(Direction direction) {
+        switch (direction) {
+            case Direction::UP: return Direction::DOWN;
+            case Direction::DOWN: return Direction::UP;
+            case Direction::LEFT: return Direction::RIGHT;
+            default: return Direction::LEFT;
+        }
+    }
+
+    // 沿方向移动一格
+    std::pair<int, int> stepFrom(std::pair<int, int> cell, Direction direction) {
+        switch (direction) {
+            case Direction::UP: cell.second--; break;
+            case Direction::DOWN: cell.second++; break;
+            case Direction::LEFT: cell.first--; break;
+            case Direction::RIGHT: cell.first++; break;
+        }
+        return cell;
+    }
+
+    // 格子是否被蛇或墙占用（走进去就会撞死）
+    bool isBlocking(MapElementType element) {
+        return element == MapElementType::SNAKE_HEAD || element == MapElementType::SNAKE_BODY ||
+               element == MapElementType::WALL;
+    }
+}
+
+// 构造函数
+Simulation::Simulation(int width, int height, const SimulationRules& rules)
+    : map(width, height),
+      snake(width / 2, height / 2),
+      mapGeneration(0),
+      rules(rules),
+      level(nullptr),
+      seed(0),
+      tickCount(0),
+      timeMs(0),
+      gameSpeed(rules.initialSpeed),
+      originalGameSpeed(rules.initialSpeed),
+      pepperEffectEndTime(0),
+      pepperEffectActive(false),
+      gameOver(false),
+      score(0) {
+    // 蛇最长占满地图，预先分配之后移动和生长不再分配内存（很大的地图只预先分配一部分，之后按需加倍）
+    snake.reserve(snakeCapacity());
+    // 每帧最多清除所有过期食物和炸弹移走的两节蛇尾
+    vacatedCells.reserve(rules.maxFoods + 2);
+    // 每帧最多改变蛇头、旧蛇头、蛇尾、空出的格子和所有食物格子
+    changes.reserve(2 * rules.maxFoods + 8 + 3 * rules.rivalSnakes);
+
+    // 对手蛇开局前都是死亡状态，reset时放到地图上
+    rivals.assign(rules.rivalSnakes, Snake(0, 0));
+    for (auto& rival : rivals) {
+        rival.reserve(std::min(snakeCapacity(), RESERVED_RIVAL_LENGTH));
+        rival.setAlive(false);
+    }
+    movedRivals.reserve(rivals.size());
+    feedingRivals.reserve(rivals.size());
+    size_t headSlots = 4;
+    while (headSlots < 2 * (rivals.size() + 1)) {
+        headSlots *= 2;
+    }
+    headCells.assign(headSlots, 0);
+    headOwners.assign(headSlots, 0);
+}
+
+// 预先为蛇分配的长度
+size_t Simulation::snakeCapacity() const {
+    return std::min(static_cast<size_t>(map.getWidth()) * map.getHeight(), MAX_RESERVED_SNAKE_LENGTH);
+}
+
+// 以指定种子开始新的一局
+void Simulation::reset(uint32_t newSeed) {
+    seed = newSeed;
+    rng.seed(seed);
+
+    // 在原来的环形缓冲区中重置蛇，不重新分配容量（蛇的部分与上一局的长度无关；
+    // 清空地图的耗时与上一局分配的块数成正比，见Map::clear）
+    snake.reserve(snakeCapacity());
+    if (level) {
+        // 玩家从关卡的第一个出生点开始
+        const LevelSpawn& spawn = level->getSpawn(0);
+        snake.reset(spawn.x, spawn.y, static_cast<Direction>(spawn.direction));
+    } else {
+        snake.reset(map.getWidth() / 2, map.getHeight() / 2, Direction::RIGHT);
+    }
+    for (auto& rival : rivals) {
+        rival.setAlive(false);
+    }
+    foods.clear();
+    vacatedCells.clear();
+    tickCount = 0;
+    timeMs = 0;
+    gameSpeed = rules.initialSpeed;
+    originalGameSpeed = rules.initialSpeed;
+    pepperEffectEndTime = 0;
+    pepperEffectActive = false;
+    gameOver = false;
+    score = 0;
+
+    // 生成初始食物
+    updateMap();
+    fillFoods();
+    updateMap();
+
+    // 对手蛇放在蛇和食物之外的空位上
+    if (!rivals.empty()) {
+        spawnRivals();
+        updateMap();
+    }
+}
+
+// 改变蛇的方向
+bool Simulation::turn(Direction direction) {
+    Direction before = snake.getDirection();
+    snake.changeDirection(direction);
+    return snake.getDirection() != before;
+}
+
+// 推进一个游戏帧
+void Simulation::step() {
+    if (gameOver) {
+        return;
+    }
+
+    tickCount++;
+    timeMs += gameSpeed;
+    changes.clear();
+
+    // 对手蛇根据帧开始时的地图选择方向
+    for (auto& rival : rivals) {
+        if (rival.isAlive()) {
+            rival.changeDirection(greedyDirection(rival, rng));
+        }
+    }
+
+    // 更新游戏状态（包括撞墙和撞到自己）
+    update();
+    if (gameOver) {
+        return;
+    }
+
+    // 处理食物碰撞
+    handleCollisions();
+    if (gameOver) {
+        return;
+    }
+
+    // 地图增量更新，不再每帧重建
+    syncFoodCells();
+}
+
+// 本帧结束时把食物的变化和缩短的蛇尾同步到地图
+// 本帧内生成食物时看到的仍是帧开始时的食物格子，与之前每帧结束时重建地图的结果一致
+void Simulation::syncFoodCells() {
+    for (const auto& cell : vacatedCells) {
+        setMapCell(cell.first, cell.second, MapElementType::EMPTY);
+    }
+    vacatedCells.clear();
+
+    // 蛇头可能刚好停在过期的食物上
+    setMapCell(snake.getHead().first, snake.getHead().second, MapElementType::SNAKE_HEAD);
+    for (const auto& rival : rivals) {
+        if (rival.isAlive()) {
+            setMapCell(rival.getHead().first, rival.getHead().second, MapElementType::SNAKE_HEAD);
+        }
+    }
+    for (const auto& foodWithLifetime : foods) {
+        const Food& food = foodWithLifetime.food;
+        setMapCell(food.getX(), food.getY(), food.getMapElement());
+    }
+}
+
+// 修改一个格子并记录变化
+void Simulation::setMapCell(int x, int y, MapElementType element) {
+    MapElementType before = map.getCell(x, y);
+    if (before == element) {
+        return;
+    }
+    map.setCell(x, y, element);
+    MapChange change = {x, y, before, element};
+    changes.push_back(change);
+}
+
+// 移动蛇并处理定时效果
+void Simulation::update() {
+    // 移动蛇
+    std::pair<int, int> oldHead = snake.getHead();
+    std::pair<int, int> oldTail = snake.getTail();
+    bool growing = snake.isGrowing();
+    snake.move();
+
+    // 检查蛇是否撞到墙
+    std::pair<int, int> head = snake.getHead();
+    if (!map.contains(head.first, head.second)) {
+        gameOver = true;
+        return;
+    }
+
+    // 同步地图上蛇头和蛇尾的变化，下面生成食物时地图才是准确的
+    // （否则刚空出的蛇尾不能生成食物，蛇只差一格占满地图时就再也吃不到食物）
+    if (!growing) {
+        setMapCell(oldTail.first, oldTail.second, MapElementType::EMPTY);
+    }
+    // 只剩一节的蛇（被炸弹炸短）移动后旧蛇头就是空出的蛇尾
+    if (snake.getLength() > 1) {
+        setMapCell(oldHead.first, oldHead.second, MapElementType::SNAKE_BODY);
+    }
+
+    // 对手蛇同时移动，所有蛇都空出蛇尾之后才检查碰撞，结果与处理顺序无关
+    moveRivals();
+
+    // 检查蛇是否撞到自己、其他蛇或墙：蛇尾已经移走，新蛇头所在格子仍被占用就是撞上了
+    bool crashed = isBlocking(map.getCell(head.first, head.second));
+    if (!rivals.empty() && resolveRivalCollisions(head)) {
+        crashed = true;
+    }
+    if (crashed) {
+        gameOver = true;
+        return;
+    }
+    setMapCell(head.first, head.second, MapElementType::SNAKE_HEAD);
+    if (!rivals.empty()) {
+        settleRivals();
+        spawnRivals();
+    }
+
+    // 检查辣椒效果是否结束
+    checkPepperEffect();
+
+    // 检查和移除过期食物
+    checkAndRemoveExpiredFoods();
+
+    // 根据蛇的长度调整游戏速度，长度越长速度越快，但有最低速度限制
+    // 只有在没有辣椒效果时才调整速度
+    if (!pepperEffectActive) {
+        int snakeLength = static_cast<int>(snake.getLength());
+        int newSpeed = std::max(rules.minSpeed, rules.speedBase - (snakeLength - 3) * rules.speedStep);
+        if (newSpeed != gameSpeed) {
+            gameSpeed = newSpeed;
+            originalGameSpeed = newSpeed; // 同时更新原始速度
+        }
+    }
+}
+
+// 处理碰撞
+void Simulation::handleCollisions() {
+    // 检查蛇是否吃到食物（一次只处理一个食物碰撞）
+    for (auto it = foods.begin(); it != foods.end(); ++it) {
+        if (!snake.checkEat(it->food.getX(), it->food.getY())) {
+            continue;
+        }
+
+        // 根据食物类型处理不同的效果
+        switch (it->food.getType()) {
+            case FoodType::APPLE:
+                // 苹果：蛇增长一个单位
+                snake.grow();
+                score += 1;
+                break;
+
+            case FoodType::PEPPER:
+                // 辣椒：蛇增长一个单位，短时间内增加移动速度
+                snake.grow();
+                score += 1;
+                // 如果辣椒效果未激活，保存原始速度
+                if (!pepperEffectActive) {
+                    originalGameSpeed = gameSpeed;
+                }
+                // 将游戏速度减半（移动更快）
+                gameSpeed = originalGameSpeed / 2;
+                // 设置辣椒效果持续时间（默认10秒）
+                pepperEffectEndTime = timeMs + rules.pepperDurationMs;
+                pepperEffectActive = true;
+                break;
+
+            case FoodType::MEAT:
+                // 肉：蛇增长两个单位
+                snake.grow();
+                snake.grow();
+                score += 2;
+                break;
+
+            case FoodType::BOMB:
+                // 炸弹：蛇减少两个单位
+                for (int i = 0; i < 2; i++) {
+                    // 检查蛇的长度，如果只有一个单位了，游戏结束
+                    if (snake.getLength() <= 1) {
+                        gameOver = true;
+                        return;
+                    }
+                    vacatedCells.push_back(snake.getTail());
+                    snake.shrink();
+                }
+                break;
+        }
+
+        // 从食物列表中移除被吃掉的食物（它的格子已经被蛇头覆盖），并补充新食物
+        foods.erase(it);
+        fillFoods();
+        break;
+    }
+
+    if (!feedingRivals.empty()) {
+        feedRivals();
+    }
+}
+
+// 走向最近的食物
+Direction Simulation::greedyDirection(const Snake& target, std::mt19937& random) const {
+    Direction current = target.getDirection();
+    std::pair<int, int> head = target.getHead();
+
+    // 最近的非炸弹食物（曼哈顿距离）
+    int foodX = -1;
+    int foodY = -1;
+    int bestDistance = 0;
+    for (const auto& foodWithLifetime : foods) {
+        const Food& food = foodWithLifetime.food;
+        if (food.getType() == FoodType::BOMB) {
+            continue;
+        }
+        int distance = std::abs(food.getX() - head.first) + std::abs(food.getY() - head.second);
+        if (foodX < 0 || distance < bestDistance) {
+            foodX = food.getX();
+            foodY = food.getY();
+            bestDistance = distance;
+        }
+    }
+
+    // 不会立即撞上的方向，优先选择离食物更近的
+    Direction safe[3];
+    Direction closer[3];
+    int safeCount = 0;
+    int closerCount = 0;
+    for (Direction direction : DIRECTIONS) {
+        if (direction == opposite(current)) {
+            continue;
+        }
+        std::pair<int, int> next = stepFrom(head, direction);
+        if (!map.contains(next.first, next.second)) {
+            continue;
+        }
+        MapElementType element = map.getCell(next.first, next.second);
+        if (isBlocking(element) || element == MapElementType::FOOD_BOMB) {
+            continue;
+        }
+        safe[safeCount++] = direction;
+        if (foodX >= 0 && std::abs(foodX - next.first) + std::abs(foodY - next.second) < bestDistance) {
+            closer[closerCount++] = direction;
+        }
+    }
+
+    if (closerCount > 0) {
+        return closer[random() % closerCount];
+    }
+    if (safeCount > 0) {
+        return safe[random() % safeCount];
+    }
+    return current;
+}
+
+// 移动所有存活的对手蛇并空出蛇尾
+void Simulation::moveRivals() {
+    movedRivals.clear();
+    feedingRivals.clear();
+    for (size_t i = 0; i < rivals.size(); i++) {
+        Snake& rival = rivals[i];
+        if (!rival.isAlive()) {
+            continue;
+        }
+        std::pair<int, int> oldHead = rival.getHead();
+        std::pair<int, int> oldTail = rival.getTail();
+        bool growing = rival.isGrowing();
+        rival.move();
+        if (!growing) {
+            setMapCell(oldTail.first, oldTail.second, MapElementType::EMPTY);
+        }
+        if (rival.getLength() > 1) {
+            setMapCell(oldHead.first, oldHead.second, MapElementType::SNAKE_BODY);
+        }
+        movedRivals.push_back(i);
+    }
+}
+
+// 把新蛇头加入哈希表
+int Simulation::insertHead(int x, int y, int owner) {
+    uint32_t cell = static_cast<uint32_t>(y) * map.getWidth() + x + 1;
+    size_t mask = headCells.size() - 1;
+    size_t slot = (cell * 2654435761u) & mask;
+    while (headCells[slot] != 0) {
+        if (headCells[slot] == cell) {
+            return headOwners[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    headCells[slot] = cell;
+    headOwners[slot] = owner;
+    return -2;
+}
+
+// 检查对手蛇的碰撞
+bool Simulation::resolveRivalCollisions(std::pair<int, int> playerHead) {
+    std::fill(headCells.begin(), headCells.end(), 0);
+    bool playerHit = false;
+    insertHead(playerHead.first, playerHead.second, -1);
+
+    for (size_t index : movedRivals) {
+        Snake& rival = rivals[index];
+        std::pair<int, int> head = rival.getHead();
+        if (!map.contains(head.first, head.second)) {
+            rival.setAlive(false);
+            continue;
+        }
+
+        // 与本帧的其他新蛇头相撞时双方都死亡
+        int other = insertHead(head.first, head.second, static_cast<int>(index));
+        if (other != -2) {
+            rival.setAlive(false);
+            if (other == -1) {
+                playerHit = true;
+            } else {
+                rivals[other].setAlive(false);
+            }
+            continue;
+        }
+
+        MapElementType target = map.getCell(head.first, head.second);
+        if (isBlocking(target)) {
+            rival.setAlive(false);
+        } else if (target != MapElementType::EMPTY) {
+            feedingRivals.push_back(index);
+        }
+    }
+    return playerHit;
+}
+
+// 写入存活对手蛇的蛇头，移除撞死的对手蛇
+void Simulation::settleRivals() {
+    for (size_t index : movedRivals) {
+        Snake& rival = rivals[index];
+        if (rival.isAlive()) {
+            setMapCell(rival.getHead().first, rival.getHead().second, MapElementType::SNAKE_HEAD);
+            continue;
+        }
+        // 撞死的蛇头没有写入地图，只清除蛇身
+        for (size_t i = 1; i < rival.getLength(); i++) {
+            std::pair<int, int> segment = rival.getSegment(i);
+            setMapCell(segment.first, segment.second, MapElementType::EMPTY);
+        }
+    }
+}
+
+// 蛇头和其后两节都是空格子，且前方一格在地图内且为空
+bool Simulation::canSpawn(int x, int y, Direction direction) const {
+    std::pair<int, int> ahead = stepFrom(std::make_pair(x, y), direction);
+    if (!map.contains(ahead.first, ahead.second) || map.getCell(ahead.first, ahead.second) != MapElementType::EMPTY) {
+        return false;
+    }
+    std::pair<int, int> cell = std::make_pair(x, y);
+    for (int i = 0; i < 3; i++) {
+        if (!map.contains(cell.first, cell.second) || map.getCell(cell.first, cell.second) != MapElementType::EMPTY) {
+            return false;
+        }
+        cell = stepFrom(cell, opposite(direction));
+    }
+    return true;
+}
+
+// 重新放置死亡的对手蛇
+void Simulation::spawnRivals() {
+    for (size_t index = 0; index < rivals.size(); index++) {
+        Snake& rival = rivals[index];
+        if (rival.isAlive()) {
+            continue;
+        }
+        // 关卡中玩家之后的出生点依次分给对手蛇，被占用时改用随机空位
+        if (level && index + 1 < level->getSpawnCount()) {
+            const LevelSpawn& spawn = level->getSpawn(index + 1);
+            Direction direction = static_cast<Direction>(spawn.direction);
+            if (canSpawn(spawn.x, spawn.y, direction)) {
+                rival.reset(spawn.x, spawn.y, direction);
+                setMapCell(rival.getSegment(2).first, rival.getSegment(2).second, MapElementType::SNAKE_BODY);
+                setMapCell(rival.getSegment(1).first, rival.getSegment(1).second, MapElementType::SNAKE_BODY);
+                setMapCell(spawn.x, spawn.y, MapElementType::SNAKE_HEAD);
+                continue;
+            }
+        }
+        int empty = map.countEmptyInterior();
+        int x = 0;
+        int y = 0;
+        if (empty <= 0 || !map.findEmptyInterior(static_cast<int>(rng() % empty), x, y)) {
+            return;
+        }
+        // 新蛇向右，蛇头、蛇身、蛇尾和前方一格都必须是空的
+        if (x < 3 || x + 1 >= map.getWidth() - 1 ||
+            map.getCell(x - 1, y) != MapElementType::EMPTY || map.getCell(x - 2, y) != MapElementType::EMPTY ||
+            map.getCell(x + 1, y) != MapElementType::EMPTY) {
+            continue;
+        }
+        rival.reset(x, y);
+        setMapCell(x - 2, y, MapElementType::SNAKE_BODY);
+        setMapCell(x - 1, y, MapElementType::SNAKE_BODY);
+        setMapCell(x, y, MapElementType::SNAKE_HEAD);
+    }
+}
+
+// 处理对手蛇吃到的食物（效果与玩家相同，但不计分，辣椒也不改变游戏速度）
+void Simulation::feedRivals() {
+    for (size_t index : feedingRivals) {
+        Snake& rival = rivals[index];
+        if (!rival.isAlive()) {
+            continue;
+        }
+        for (auto it = foods.begin(); it != foods.end(); ++it) {
+            if (!rival.checkEat(it->food.getX(), it->food.getY())) {
+                continue;
+            }
+            switch (it->food.getType()) {
+                case FoodType::MEAT:
+                    rival.grow();
+                    rival.grow();
+                    break;
+                case FoodType::BOMB:
+                    for (int i = 0; i < 2 && rival.isAlive(); i++) {
+                        if (rival.getLength() <= 1) {
+                            killRival(rival);
+                            break;
+                        }
+                        vacatedCells.push_back(rival.getTail());
+                        rival.shrink();
+                    }
+                    break;
+                default:
+                    rival.grow();
+                    break;
+            }
+            foods.erase(it);
+            fillFoods();
+            break;
+        }
+    }
+}
+
+// 对手蛇死亡，所有格子在帧结束时清除
+void Simulation::killRival(Snake& rival) {
+    for (size_t i = 0; i < rival.getLength(); i++) {
+        vacatedCells.push_back(rival.getSegment(i));
+    }
+    rival.setAlive(false);
+}
+
+// 检查辣椒效果是否结束
+void Simulation::checkPepperEffect() {
+    if (pepperEffectActive && timeMs >= pepperEffectEndTime) {
+        // 辣椒效果结束，恢复原始速度
+        gameSpeed = originalGameSpeed;
+        pepperEffectActive = false;
+    }
+}
+
+// 补充食物到最大数量
+void Simulation::fillFoods() {
+    int attempts = 0;
+    const int maxAttempts = 50; // 最大尝试次数，避免无限循环
+
+    while (foods.size() < rules.maxFoods && attempts < maxAttempts) {
+        attempts++;
+
+        // 创建新食物，没有空位时停止
+        // 关卡有食物区时只在食物区生成，选中的格子被占用时重试
+        Food newFood;
+        if (level && level->getZoneCellCount() > 0) {
+            if (!newFood.generateInZone(map, rng, rules.foodWeights, *level)) {
+                continue;
+            }
+        } else if (!newFood.generate(map, rng, rules.foodWeights)) {
+            break;
+        }
+
+        // 检查新食物的位置是否与现有食物重叠
+        bool overlapping = false;
+        for (const auto& existingFood : foods) {
+            if (newFood.getX() == existingFood.food.getX() &&
+                newFood.getY() == existingFood.food.getY()) {
+                overlapping = true;
+                break;
+            }
+        }
+
+        // 如果新食物与现有食物重叠，重新生成
+        if (overlapping) {
+            continue;
+        }
+
+        // 设置食物的过期时间并添加到食物列表
+        FoodWithLifetime entry;
+        entry.food = newFood;
+        entry.expirationTime = timeMs + static_cast<int64_t>(rules.foodLifetime) * 1000;
+        foods.push_back(entry);
+    }
+}
+
+// 检查和移除过期食物
+void Simulation::checkAndRemoveExpiredFoods() {
+    // 过期食物的格子在本帧结束时才清除，本帧不会在原地生成新食物
+    auto it = foods.begin();
+    while (it != foods.end()) {
+        if (it->isExpired(timeMs)) {
+            vacatedCells.push_back(std::make_pair(it->food.getX(), it->food.getY()));
+            it = foods.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // 如果食物数量少于最大值，生成新食物
+    if (foods.size() < rules.maxFoods) {
+        fillFoods();
+    }
+}
+
+// 根据蛇和食物重建地图（开局和恢复检查点时使用，之后每帧增量更新）
+void Simulation::updateMap() {
+    // 清空地图，派生视图需要整体重建
+    map.clear();
+    changes.clear();
+    mapGeneration++;
+    stampWalls();
+
+    // 更新所有食物位置
+    for (const auto& foodWithLifetime : foods) {
+        foodWithLifetime.food.updateMap(map);
+    }
+
+    // 更新蛇在地图上的位置：先设置蛇身，再设置蛇头
+    for (size_t i = 1; i < snake.getLength(); i++) {
+        std::pair<int, int> segment = snake.getSegment(i);
+        map.setElement(segment.first, segment.second, MapElementType::SNAKE_BODY);
+    }
+    map.setElement(snake.getHead().first, snake.getHead().second, MapElementType::SNAKE_HEAD);
+
+    for (const auto& rival : rivals) {
+        if (!rival.isAlive()) {
+            continue;
+        }
+        for (size_t i = 1; i < rival.getLength(); i++) {
+            map.setElement(rival.getSegment(i).first, rival.getSegment(i).second, MapElementType::SNAKE_BODY);
+        }
+        map.setElement(rival.getHead().first, rival.getHead().second, MapElementType::SNAKE_HEAD);
+    }
+}
+
+// 把墙写入地图
+void Simulation::stampWalls() {
+    if (!level) {
+        return;
+    }
+    for (size_t i = 0; i < level->getWallRunCount(); i++) {
+        const LevelRun& run = level->getWallRun(i);
+        for (int x = run.x; x < run.x + run.length; x++) {
+            map.setCell(x, run.y, MapElementType::WALL);
+        }
+    }
+}
+
+// 将完整状态写入检查点
+bool Simulation::saveCheckpoint(CheckpointState& state, CheckpointCell* cells, size_t maxCells) const {
+    // 检查点只有玩家的蛇，也不记录关卡
+    size_t length = snake.getLength();
+    if (length > maxCells || foods.size() > CHECKPOINT_MAX_FOODS || !rivals.empty() || level) {
+        return false;
+    }
+
+    state.seed = seed;
+    state.score = score;
+    state.gameSpeed = gameSpeed;
+    state.originalGameSpeed = originalGameSpeed;
+    state.pepperEffectActive = pepperEffectActive;
+    state.gameOver = gameOver;
+    state.direction = static_cast<uint8_t>(snake.getDirection());
+    state.growing = snake.isGrowing();
+    state.tickCount = tickCount;
+    state.timeMs = timeMs;
+    state.pepperEffectEndTime = pepperEffectEndTime;
+
+    state.foodCount = static_cast<uint32_t>(foods.size());
+    for (size_t i = 0; i < foods.size(); i++) {
+        CheckpointFood& saved = state.foods[i];
+        saved.x = static_cast<int16_t>(foods[i].food.getX());
+        saved.y = static_cast<int16_t>(foods[i].food.getY());
+        saved.type = static_cast<uint8_t>(foods[i].food.getType());
+        memset(saved.reserved, 0, sizeof(saved.reserved));
+        saved.expirationTime = foods[i].expirationTime;
+    }
+    // 未使用的食物槽也要清零，否则CRC会覆盖到上一次的残留数据
+    memset(state.foods + foods.size(), 0, (CHECKPOINT_MAX_FOODS - foods.size()) * sizeof(CheckpointFood));
+
+    state.rngSize = sizeof(rng);
+    memcpy(state.rng, &rng, sizeof(rng));
+    memset(state.rng + sizeof(rng), 0, sizeof(state.rng) - sizeof(rng));
+
+    state.bodyLength = static_cast<uint32_t>(length);
+    for (size_t i = 0; i < length; i++) {
+        std::pair<int, int> segment = snake.getSegment(i);
+        cells[i].x = static_cast<int16_t>(segment.first);
+        cells[i].y = static_cast<int16_t>(segment.second);
+    }
+    return true;
+}
+
+// 从检查点恢复完整状态
+bool Simulation::restoreCheckpoint(const CheckpointState& state, const CheckpointCell* cells) {
+    // 检查状态是否合法（CRC只能发现损坏，不能发现不同版本写入的不合理数据）
+    if (state.bodyLength == 0 || state.bodyLength > static_cast<uint32_t>(map.getWidth() * map.getHeight()) ||
+        state.foodCount > rules.maxFoods || state.direction > static_cast<uint8_t>(Direction::RIGHT) ||
+        state.rngSize != sizeof(rng) || state.gameSpeed <= 0 || state.originalGameSpeed <= 0) {
+        return false;
+    }
+    for (uint32_t i = 0; i < state.foodCount; i++) {
+        if (state.foods[i].type > static_cast<uint8_t>(FoodType::BOMB) ||
+            state.foods[i].x < 0 || state.foods[i].x >= map.getWidth() ||
+            state.foods[i].y < 0 || state.foods[i].y >= map.getHeight()) {
+            return false;
+        }
+    }
+
+    // 蛇身的每一格都要在地图内并与前一格相邻，且不重复，否则之后的移动会越界读写地图
+    std::vector<std::pair<int, int>> body(state.bodyLength);
+    for (uint32_t i = 0; i < state.bodyLength; i++) {
+        body[i] = std::make_pair(cells[i].x, cells[i].y);
+        if (!map.contains(body[i].first, body[i].second)) {
+            return false;
+        }
+        if (i > 0 && std::abs(body[i].first - body[i - 1].first) + std::abs(body[i].second - body[i - 1].second) != 1) {
+            return false;
+        }
+    }
+    std::vector<std::pair<int, int>> sorted(body);
+    std::sort(sorted.begin(), sorted.end());
+    if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+        return false;
+    }
+    snake.restore(body, static_cast<Direction>(state.direction), state.growing != 0);
+
+    foods.clear();
+    for (uint32_t i = 0; i < state.foodCount; i++) {
+        const CheckpointFood& saved = state.foods[i];
+        FoodWithLifetime entry;
+        entry.food = Food(saved.x, saved.y, static_cast<FoodType>(saved.type));
+        entry.expirationTime = saved.expirationTime;
+        foods.push_back(entry);
+    }
+
+    memcpy(&rng, state.rng, sizeof(rng));
+    seed = state.seed;
+    score = state.score;
+    tickCount = state.tickCount;
+    timeMs = state.timeMs;
+    gameSpeed = state.gameSpeed;
+    originalGameSpeed = state.originalGameSpeed;
+    pepperEffectEndTime = state.pepperEffectEndTime;
+    pepperEffectActive = state.pepperEffectActive != 0;
+    gameOver = state.gameOver != 0;
+
+    // 检查点中没有对手蛇（有对手蛇时不会保存检查点）
+    for (auto& rival : rivals) {
+        rival.setAlive(false);
+    }
+    vacatedCells.clear();
+    updateMap();
+    return true;
+}
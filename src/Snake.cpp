@@ -1,48 +1,75 @@
 #include "../include/Snake.h"
 #include <iostream>
+#include <algorithm>
 
 // 构造函数
-Snake::Snake(int x, int y) : direction(Direction::RIGHT), lastDirectionChange(Direction::RIGHT), growing(false) {
+Snake::Snake(int x, int y)
+    : ring(4), headIndex(0), length(3), direction(Direction::RIGHT), lastDirectionChange(Direction::RIGHT),
+      alive(true), growing(false) {
     // 初始化蛇的身体，默认长度为3
-    body.push_back(std::make_pair(x, y));       // 蛇头
-    body.push_back(std::make_pair(x - 1, y));   // 蛇身
-    body.push_back(std::make_pair(x - 2, y));   // 蛇尾
+    ring[0] = std::make_pair(x, y);       // 蛇头
+    ring[1] = std::make_pair(x - 1, y);   // 蛇身
+    ring[2] = std::make_pair(x - 2, y);   // 蛇尾
+}
+
+// 预留容量
+void Snake::reserve(size_t capacity) {
+    if (capacity > ring.size()) {
+        growCapacity(capacity);
+    }
+}
+
+// 扩大环形缓冲区，保持各节顺序
+void Snake::growCapacity(size_t minCapacity) {
+    size_t capacity = ring.size();
+    while (capacity < minCapacity) {
+        capacity *= 2;
+    }
+    std::vector<std::pair<int, int>> larger(capacity);
+    for (size_t i = 0; i < length; i++) {
+        larger[i] = getSegment(i);
+    }
+    ring.swap(larger);
+    headIndex = 0;
 }
 
 // 移动蛇
 void Snake::move() {
-    if (body.empty()) return;
+    if (length == 0) return;
     
     // 获取当前蛇头位置
-    std::pair<int, int> head = body.front();
+    std::pair<int, int> head = getHead();
     
     // 根据方向计算新的头部位置
-    std::pair<int, int> newHead;
+    std::pair<int, int> newHead = head;
     switch (direction) {
         case Direction::UP:
-            newHead = std::make_pair(head.first, head.second - 1);
+            newHead.second--;
             break;
         case Direction::DOWN:
-            newHead = std::make_pair(head.first, head.second + 1);
+            newHead.second++;
             break;
         case Direction::LEFT:
-            newHead = std::make_pair(head.first - 1, head.second);
+            newHead.first--;
             break;
         case Direction::RIGHT:
-            newHead = std::make_pair(head.first + 1, head.second);
+            newHead.first++;
             break;
     }
     
-    // 在蛇身体前端插入新的头部
-    body.insert(body.begin(), newHead);
-    
-    // 如果蛇不在生长状态，则移除尾部
-    if (!growing) {
-        body.pop_back();
-    } else {
+    // 生长时保留蛇尾，长度加一，需要时扩大缓冲区
+    if (growing) {
+        if (length == ring.size()) {
+            growCapacity(length + 1);
+        }
+        length++;
         // 重置生长状态
         growing = false;
     }
+    
+    // 蛇头向前移动一格，不生长时原来的蛇尾位置被新蛇头覆盖或落到长度之外
+    headIndex = (headIndex - 1) & (ring.size() - 1);
+    ring[headIndex] = newHead;
 }
 
 // 改变蛇的方向
@@ -86,7 +113,8 @@ void Snake::grow() {
 // 检查蛇是否吃到了食物
 bool Snake::checkEat(int foodX, int foodY) const {
     // 检查蛇头是否与食物位置重合
-    return (body.front().first == foodX && body.front().second == foodY);
+    std::pair<int, int> head = getHead();
+    return (head.first == foodX && head.second == foodY);
 }
 
 // 检查蛇是否撞到了自己
@@ -95,8 +123,9 @@ bool Snake::checkCollisionWithSelf() const {
     std::pair<int, int> head = getHead();
     
     // 从第二个身体部分开始检查是否与头部重叠
-    for (std::size_t i = 1; i < body.size(); i++) {
-        if (body[i].first == head.first && body[i].second == head.second) {
+    for (std::size_t i = 1; i < length; i++) {
+        std::pair<int, int> segment = getSegment(i);
+        if (segment.first == head.first && segment.second == head.second) {
             return true;
         }
     }
@@ -115,12 +144,19 @@ bool Snake::checkCollisionWithWall(int mapWidth, int mapHeight) const {
 
 // 获取蛇头位置
 std::pair<int, int> Snake::getHead() const {
-    return body.front();
+    return ring[headIndex];
 }
 
-// 获取蛇身体
-const std::vector<std::pair<int, int>>& Snake::getBody() const {
-    return body;
+// 按从蛇头到蛇尾的顺序复制蛇身体
+void Snake::copyBody(std::vector<std::pair<int, int>>& out) const {
+    // 预留整个环形缓冲区的容量，蛇在这之内变长时out不再重新分配
+    if (out.capacity() < ring.size()) {
+        out.reserve(ring.size());
+    }
+    out.resize(length);
+    for (size_t i = 0; i < length; i++) {
+        out[i] = getSegment(i);
+    }
 }
 
 // 检查蛇是否存活
@@ -141,7 +177,47 @@ Direction Snake::getDirection() const {
 // 使蛇缩短（减少一个单位长度）
 void Snake::shrink() {
     // 如果蛇身体长度大于1，则移除尾部
-    if (body.size() > 1) {
-        body.pop_back();
+    if (length > 1) {
+        length--;
     }
-} 
\ No newline at end of file
+} 
+
+// 蛇是否会在下一次移动时增长
+bool Snake::isGrowing() const {
+    return growing;
+}
+
+// 在指定位置重新开始
+void Snake::reset(int startX, int startY, Direction startDirection) {
+    int dx = 0;
+    int dy = 0;
+    switch (startDirection) {
+        case Direction::UP: dy = -1; break;
+        case Direction::DOWN: dy = 1; break;
+        case Direction::LEFT: dx = -1; break;
+        case Direction::RIGHT: dx = 1; break;
+    }
+    headIndex = 0;
+    length = 3;
+    ring[0] = std::make_pair(startX, startY);
+    ring[1] = std::make_pair(startX - dx, startY - dy);
+    ring[2] = std::make_pair(startX - 2 * dx, startY - 2 * dy);
+    direction = startDirection;
+    lastDirectionChange = startDirection;
+    growing = false;
+    alive = true;
+}
+
+// 从保存的状态恢复蛇
+void Snake::restore(const std::vector<std::pair<int, int>>& savedBody, Direction savedDirection, bool savedGrowing) {
+    if (savedBody.size() > ring.size()) {
+        growCapacity(savedBody.size());
+    }
+    headIndex = 0;
+    length = savedBody.size();
+    std::copy(savedBody.begin(), savedBody.end(), ring.begin());
+    direction = savedDirection;
+    lastDirectionChange = savedDirection;
+    growing = savedGrowing;
+    alive = true;
+}
@@ -0,0 +1,130 @@
+#include "../include/Telemetry.h"
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+    const char TELEMETRY_MAGIC[4] = {'S', 'N', 'K', 'T'};
+
+    const char* const COUNTER_NAMES[] = {
+        "ticks",
+        "frames rendered",
+        "frames skipped",
+        "missed deadlines",
+        "input events",
+        "mutex wait ns",
+        "bytes blitted",
+        "sprite cache hits",
+        "sprite loads",
+        "snake length",
+        "score"
+    };
+    static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == static_cast<size_t>(TelemetryCounter::COUNT),
+                  "every telemetry counter needs a name");
+}
+
+// 类内初始化的静态常量在按引用传递时需要定义
+const uint32_t Telemetry::VERSION;
+
+// 未发布时计数写入进程内的块（静态存储，初始为0）
+TelemetryBlock Telemetry::localBlock;
+TelemetryBlock* Telemetry::block = &Telemetry::localBlock;
+std::string Telemetry::publishedName;
+
+// 在共享内存中创建遥测块
+bool Telemetry::publish(const std::string& name) {
+    unpublish();
+    if (!std::atomic<uint64_t>().is_lock_free()) {
+        // 原子操作用进程内的锁实现时外部工具读到的值可能不完整
+        std::cerr << "Warning: 64-bit atomics are not lock-free, telemetry readers may see torn values" << std::endl;
+    }
+
+    // 上一次运行留下的块先删除再新建（不截断旧块，仍映射着它的读者不会因此出错）
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to create telemetry block " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, sizeof(TelemetryBlock)) != 0) {
+        std::cerr << "Failed to size telemetry block " << name << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* mapped = mmap(nullptr, sizeof(TelemetryBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to map telemetry block " << name << ": " << strerror(errno) << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // 共享内存初始为0，原子计数器不需要构造
+    TelemetryBlock* shared = static_cast<TelemetryBlock*>(mapped);
+    shared->version = VERSION;
+    shared->counterCount = static_cast<uint32_t>(TelemetryCounter::COUNT);
+    shared->pid = static_cast<int32_t>(getpid());
+    // 魔数最后写入，读者看到魔数时其余字段已经有效
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(shared->magic, TELEMETRY_MAGIC, sizeof(TELEMETRY_MAGIC));
+
+    block = shared;
+    publishedName = name;
+    std::cout << "Telemetry published at " << name << std::endl;
+    return true;
+}
+
+// 删除共享内存
+void Telemetry::unpublish() {
+    if (block == &localBlock) {
+        return;
+    }
+    TelemetryBlock* shared = block;
+    block = &localBlock;
+    munmap(shared, sizeof(TelemetryBlock));
+    shm_unlink(publishedName.c_str());
+    publishedName.clear();
+}
+
+// 计数器的名称
+const char* Telemetry::counterName(TelemetryCounter counter) {
+    size_t index = static_cast<size_t>(counter);
+    return index < static_cast<size_t>(TelemetryCounter::COUNT) ? COUNTER_NAMES[index] : "unknown";
+}
+
+// 只读映射其他进程发布的遥测块
+const TelemetryBlock* Telemetry::attach(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(TelemetryBlock)) {
+        ::close(fd);
+        return nullptr;
+    }
+    void* mapped = mmap(nullptr, sizeof(TelemetryBlock), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+    const TelemetryBlock* attached = static_cast<const TelemetryBlock*>(mapped);
+    if (memcmp(attached->magic, TELEMETRY_MAGIC, sizeof(TELEMETRY_MAGIC)) != 0 || attached->version != VERSION ||
+        attached->counterCount != static_cast<uint32_t>(TelemetryCounter::COUNT)) {
+        munmap(mapped, sizeof(TelemetryBlock));
+        return nullptr;
+    }
+    return attached;
+}
+
+// 解除只读映射
+void Telemetry::detach(const TelemetryBlock* attached) {
+    if (attached) {
+        munmap(const_cast<TelemetryBlock*>(attached), sizeof(TelemetryBlock));
+    }
+}
@@ -0,0 +1,174 @@
+#include "../include/ThreadStats.h"
+#include "../include/Trace.h"
+#include "../include/Latency.h"
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace {
+    // 一次采样的计数（CPU时间以时钟节拍为单位）
+    struct TaskCounters {
+        std::string name;
+        uint64_t utime;
+        uint64_t stime;
+        uint64_t voluntary;
+        uint64_t involuntary;
+    };
+
+    // 一个线程第一次和最后一次采样的计数
+    struct ThreadRecord {
+        std::string name;
+        int64_t firstTime;
+        int64_t lastTime;
+        TaskCounters first;
+        TaskCounters last;
+    };
+
+    std::mutex recordsMutex;
+    std::map<long, ThreadRecord> records;
+
+    // 读取一个线程的计数，线程已经退出时返回false
+    bool readTask(long tid, TaskCounters& counters) {
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/self/task/%ld/stat", tid);
+        FILE* file = fopen(path, "r");
+        if (!file) {
+            return false;
+        }
+        char line[512];
+        bool parsed = fgets(line, sizeof(line), file) != nullptr;
+        fclose(file);
+        if (!parsed) {
+            return false;
+        }
+
+        // 线程名在括号中，可能含有空格，取最后一个右括号之后的字段（从第3个字段state开始）
+        char* open = strchr(line, '(');
+        char* close = strrchr(line, ')');
+        if (!open || !close || close < open) {
+            return false;
+        }
+        counters.name.assign(open + 1, close);
+        unsigned long utime = 0;
+        unsigned long stime = 0;
+        if (sscanf(close + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime) != 2) {
+            return false;
+        }
+        counters.utime = utime;
+        counters.stime = stime;
+
+        // 上下文切换次数只在status中
+        snprintf(path, sizeof(path), "/proc/self/task/%ld/status", tid);
+        file = fopen(path, "r");
+        if (!file) {
+            return false;
+        }
+        counters.voluntary = 0;
+        counters.involuntary = 0;
+        while (fgets(line, sizeof(line), file)) {
+            if (strncmp(line, "voluntary_ctxt_switches:", 24) == 0) {
+                counters.voluntary = strtoull(line + 24, nullptr, 10);
+            } else if (strncmp(line, "nonvoluntary_ctxt_switches:", 27) == 0) {
+                counters.involuntary = strtoull(line + 27, nullptr, 10);
+            }
+        }
+        fclose(file);
+        return true;
+    }
+
+    // 记录一次采样（调用者持有recordsMutex）
+    void store(long tid, const TaskCounters& counters, int64_t now) {
+        std::map<long, ThreadRecord>::iterator found = records.find(tid);
+        if (found == records.end()) {
+            ThreadRecord record;
+            record.firstTime = now;
+            record.first = counters;
+            found = records.insert(std::make_pair(tid, record)).first;
+        }
+        found->second.name = counters.name;
+        found->second.lastTime = now;
+        found->second.last = counters;
+    }
+}
+
+// 设置当前线程的名称
+void ThreadStats::nameThread(const char* name) {
+    pthread_setname_np(pthread_self(), name);
+    Trace::setThreadName(name);
+}
+
+// 采样所有线程
+void ThreadStats::sample() {
+    DIR* tasks = opendir("/proc/self/task");
+    if (!tasks) {
+        return;
+    }
+    int64_t now = monotonicNanos();
+    std::lock_guard<std::mutex> lock(recordsMutex);
+    while (struct dirent* entry = readdir(tasks)) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+            continue;
+        }
+        long tid = strtol(entry->d_name, nullptr, 10);
+        TaskCounters counters;
+        if (readTask(tid, counters)) {
+            store(tid, counters, now);
+        }
+    }
+    closedir(tasks);
+}
+
+// 采样当前线程
+void ThreadStats::sampleCurrentThread() {
+    long tid = syscall(SYS_gettid);
+    TaskCounters counters;
+    if (!readTask(tid, counters)) {
+        return;
+    }
+    int64_t now = monotonicNanos();
+    std::lock_guard<std::mutex> lock(recordsMutex);
+    store(tid, counters, now);
+}
+
+// 输出每个线程的统计
+void ThreadStats::report(std::ostream& out) {
+    double tickMillis = 1000.0 / sysconf(_SC_CLK_TCK);
+    std::lock_guard<std::mutex> lock(recordsMutex);
+    if (records.empty()) {
+        return;
+    }
+
+    // 在单独的流中设置小数格式，不影响调用者的流
+    std::ostringstream table;
+    table << std::fixed << std::setprecision(1);
+    table << "Threads (between first and last sample):" << std::endl;
+    table << std::setw(9) << "tid" << "  " << std::left << std::setw(16) << "name" << std::right << std::setw(9)
+          << "user ms" << std::setw(9) << "sys ms" << std::setw(7) << "cpu%" << std::setw(10) << "vol csw"
+          << std::setw(10) << "wakeup/s" << std::setw(10) << "invol csw" << std::setw(9) << "invol/s" << std::endl;
+    for (std::map<long, ThreadRecord>::const_iterator it = records.begin(); it != records.end(); ++it) {
+        const ThreadRecord& record = it->second;
+        double seconds = (record.lastTime - record.firstTime) / 1e9;
+        double userMs = (record.last.utime - record.first.utime) * tickMillis;
+        double systemMs = (record.last.stime - record.first.stime) * tickMillis;
+        uint64_t voluntary = record.last.voluntary - record.first.voluntary;
+        uint64_t involuntary = record.last.involuntary - record.first.involuntary;
+        // 只采样到一次的线程没有时间间隔，比率为0
+        double cpuPercent = seconds > 0 ? (userMs + systemMs) / 10.0 / seconds : 0.0;
+        double wakeups = seconds > 0 ? voluntary / seconds : 0.0;
+        double preemptions = seconds > 0 ? involuntary / seconds : 0.0;
+        table << std::setw(9) << it->first << "  " << std::left << std::setw(16) << record.name << std::right
+              << std::setw(9) << userMs << std::setw(9) << systemMs << std::setw(7) << cpuPercent << std::setw(10)
+              << voluntary << std::setw(10) << wakeups << std::setw(10) << involuntary << std::setw(9) << preemptions
+              << std::endl;
+    }
+    out << table.str();
+}
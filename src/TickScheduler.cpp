@@ -0,0 +1,62 @@
+#include "../include/TickScheduler.h"
+#include <cerrno>
+#include <time.h>
+
+// 构造函数
+TickScheduler::TickScheduler(TickPolicy policy, int maxCatchUp)
+    : policy(policy), maxCatchUp(maxCatchUp), period(0), deadline(0), catchUpRun(0), tickCount(0),
+      missedDeadlines(0), skippedTicks(0) {
+}
+
+// 从now开始调度
+void TickScheduler::start(int64_t now, int64_t periodNanos) {
+    period = periodNanos;
+    deadline = now + period;
+    catchUpRun = 0;
+}
+
+// 改变周期，保持相位
+void TickScheduler::setPeriod(int64_t periodNanos) {
+    // 在beginTick和advance之间调用时deadline仍是本帧的截止时间，advance从它加上新周期
+    period = periodNanos;
+}
+
+// 等待到下一帧的截止时间
+void TickScheduler::sleepUntilDeadline() const {
+    struct timespec target;
+    target.tv_sec = static_cast<time_t>(deadline / 1000000000LL);
+    target.tv_nsec = static_cast<long>(deadline % 1000000000LL);
+    // 绝对时间的等待被信号打断后重新调用仍然等到同一时刻
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, nullptr) == EINTR) {
+    }
+}
+
+// 一帧开始执行
+void TickScheduler::beginTick(int64_t now) {
+    lateness.record(now - deadline);
+    tickCount++;
+}
+
+// 计算下一帧的截止时间
+void TickScheduler::advance(int64_t now) {
+    int64_t tickDeadline = deadline;
+    deadline = tickDeadline + period;
+    if (now < deadline) {
+        catchUpRun = 0;
+        return;
+    }
+
+    // 这一帧结束时下一帧的截止时间已经过了
+    missedDeadlines++;
+    if (policy == TickPolicy::CATCH_UP && catchUpRun < maxCatchUp) {
+        // 保持截止时间不变，下一帧立即执行
+        catchUpRun++;
+        return;
+    }
+
+    // 跳过已经错过的帧，对齐到now之后的第一个节拍
+    int64_t behind = (now - deadline) / period + 1;
+    skippedTicks += static_cast<uint64_t>(behind);
+    deadline += behind * period;
+    catchUpRun = 0;
+}
@@ -0,0 +1,132 @@
+#include "../include/Trace.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace {
+    // 一个线程的环形缓冲区
+    // 只有所属线程写入：先写区间再以release递增written；读者复制后重新读取written，
+    // 丢弃复制期间可能被覆盖的区间，因此不需要锁
+    struct TraceBuffer {
+        const char* threadName;
+        long threadId;
+        std::atomic<uint64_t> written;
+        TraceEvent events[Trace::EVENTS_PER_THREAD];
+        TraceBuffer* next;
+    };
+
+    // 所有线程的缓冲区（新缓冲区插入表头）。线程结束后缓冲区保留到进程退出，其中的区间仍会写出
+    std::atomic<TraceBuffer*> buffers(nullptr);
+
+    thread_local TraceBuffer* threadBuffer = nullptr;
+    thread_local const char* threadName = nullptr;
+
+    // 为当前线程创建缓冲区（每个线程第一次记录区间时调用一次）
+    TraceBuffer* createBuffer() {
+        TraceBuffer* buffer = new TraceBuffer();
+        buffer->threadName = threadName;
+        buffer->threadId = syscall(SYS_gettid);
+        buffer->written.store(0, std::memory_order_relaxed);
+        TraceBuffer* head = buffers.load(std::memory_order_relaxed);
+        do {
+            buffer->next = head;
+        } while (!buffers.compare_exchange_weak(head, buffer, std::memory_order_release, std::memory_order_relaxed));
+        threadBuffer = buffer;
+        return buffer;
+    }
+
+    // 纳秒转换为trace-event使用的微秒
+    void writeMicros(std::ostream& out, int64_t nanos) {
+        out << nanos / 1000 << '.' << std::setw(3) << std::setfill('0') << nanos % 1000;
+    }
+}
+
+// 类内初始化的静态常量在按引用传递时需要定义
+const size_t Trace::EVENTS_PER_THREAD;
+
+std::atomic<bool> Trace::enabled(false);
+std::atomic<bool> Trace::flushRequested(false);
+
+// 开始记录区间
+void Trace::start() {
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+// 设置当前线程的名称
+void Trace::setThreadName(const char* name) {
+    threadName = name;
+    if (threadBuffer) {
+        threadBuffer->threadName = name;
+    }
+}
+
+// 记录当前线程的一个区间
+void Trace::record(const char* name, int64_t start, int64_t end) {
+    if (!isEnabled()) {
+        return;
+    }
+    TraceBuffer* buffer = threadBuffer ? threadBuffer : createBuffer();
+    uint64_t index = buffer->written.load(std::memory_order_relaxed);
+    TraceEvent& event = buffer->events[index % EVENTS_PER_THREAD];
+    event.name = name;
+    event.start = start;
+    event.duration = end - start;
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+// 写出trace-event JSON文件
+bool Trace::writeFile(const std::string& path, int64_t since) {
+    std::ofstream file(path.c_str());
+    if (!file) {
+        return false;
+    }
+
+    int pid = static_cast<int>(getpid());
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"args\":{\"name\":\"greedy-snake\"}}";
+
+    std::vector<TraceEvent> events;
+    events.reserve(EVENTS_PER_THREAD);
+    size_t total = 0;
+    for (TraceBuffer* buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        // 复制最近的区间，复制期间写者可能已经覆盖了最早的几个
+        uint64_t end = buffer->written.load(std::memory_order_acquire);
+        uint64_t begin = end > EVENTS_PER_THREAD ? end - EVENTS_PER_THREAD : 0;
+        events.clear();
+        for (uint64_t i = begin; i < end; i++) {
+            events.push_back(buffer->events[i % EVENTS_PER_THREAD]);
+        }
+        uint64_t after = buffer->written.load(std::memory_order_acquire);
+        size_t skip = 0;
+        if (after + 1 > begin + EVENTS_PER_THREAD) {
+            skip = static_cast<size_t>(std::min<uint64_t>(after + 1 - EVENTS_PER_THREAD - begin, events.size()));
+        }
+
+        file << "," << std::endl << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":"
+             << buffer->threadId << ",\"args\":{\"name\":\"" << (buffer->threadName ? buffer->threadName : "thread")
+             << "\"}}";
+        // 区间名称都是程序中的字符串常量，不需要转义
+        for (size_t i = skip; i < events.size(); i++) {
+            if (events[i].start + events[i].duration < since) {
+                continue;
+            }
+            total++;
+            file << "," << std::endl << "{\"name\":\"" << events[i].name << "\",\"ph\":\"X\",\"pid\":" << pid
+                 << ",\"tid\":" << buffer->threadId << ",\"ts\":";
+            writeMicros(file, events[i].start);
+            file << ",\"dur\":";
+            writeMicros(file, events[i].duration);
+            file << "}";
+        }
+    }
+    file << std::endl << "]}" << std::endl;
+    if (!file) {
+        return false;
+    }
+    std::cout << "Trace written to " << path << " (" << total << " spans)" << std::endl;
+    return true;
+}
@@ -0,0 +1,68 @@
+#include "../include/UiState.h"
+
+// 类内初始化的静态常量在按引用传递时需要定义
+const int UiStateMachine::GAME_OVER_SCREEN_MS;
+const int UiStateMachine::RESTART_GUARD_MS;
+
+namespace {
+    // 毫秒转换为纳秒
+    int64_t millisToNanos(int ms) {
+        return static_cast<int64_t>(ms) * 1000000LL;
+    }
+}
+
+// 构造函数
+UiStateMachine::UiStateMachine(GameOverPolicy policy)
+    : state(UiState::PAUSED), policy(policy), gameOverTime(0), deadline(0) {
+}
+
+// 游戏开始、继续或开始新的一局
+void UiStateMachine::onRunning() {
+    state = UiState::RUNNING;
+    deadline = 0;
+}
+
+// 游戏暂停
+void UiStateMachine::onPaused() {
+    state = UiState::PAUSED;
+    deadline = 0;
+}
+
+// 游戏结束
+void UiStateMachine::onGameOver(int64_t now) {
+    state = UiState::GAME_OVER;
+    gameOverTime = now;
+    deadline = now + millisToNanos(GAME_OVER_SCREEN_MS);
+}
+
+// 玩家操作
+UiAction UiStateMachine::onTap(int64_t now) {
+    // 只有玩家自己玩的游戏在结束画面上响应操作（演示模式的接管由Game处理）
+    UiState current = state;
+    if (policy != GameOverPolicy::PROMPT ||
+        (current != UiState::GAME_OVER && current != UiState::RESTART_PROMPT)) {
+        return UiAction::NONE;
+    }
+    if (now - gameOverTime < millisToNanos(RESTART_GUARD_MS)) {
+        return UiAction::NONE;
+    }
+    deadline = 0;
+    return UiAction::RESTART;
+}
+
+// 截止时间到达
+UiAction UiStateMachine::onTimeout(int64_t now) {
+    if (state != UiState::GAME_OVER || deadline == 0 || now < deadline) {
+        return UiAction::NONE;
+    }
+    deadline = 0;
+    switch (policy) {
+        case GameOverPolicy::PROMPT:
+            state = UiState::RESTART_PROMPT;
+            return UiAction::SHOW_RESTART_PROMPT;
+        case GameOverPolicy::AUTO_RESTART:
+            return UiAction::RESTART;
+        default:
+            return UiAction::EXIT;
+    }
+}
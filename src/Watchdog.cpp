@@ -0,0 +1,149 @@
+#include "../include/Watchdog.h"
+#include "../include/Trace.h"
+#include "../include/ThreadStats.h"
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
+
+namespace {
+    const char* const CHANNEL_NAMES[] = {"game tick", "render frame"};
+    static_assert(sizeof(CHANNEL_NAMES) / sizeof(CHANNEL_NAMES[0]) == static_cast<size_t>(WatchdogChannel::COUNT),
+                  "every watchdog channel needs a name");
+
+    // 监视线程的检查间隔为阈值的几分之一（不短于1毫秒）
+    const int POLLS_PER_THRESHOLD = 4;
+    const int64_t MIN_POLL_NANOS = 1000000;
+}
+
+// 类内初始化的静态常量在按引用传递时需要定义
+const int64_t Watchdog::CONTEXT_NANOS;
+
+// 构造函数
+Watchdog::Watchdog() : threshold(0), lastDump(0), dumpCount(0), stopping(false) {
+}
+
+// 析构函数
+Watchdog::~Watchdog() {
+    stop();
+}
+
+// 启动监视线程
+void Watchdog::start(int64_t thresholdNanos, const std::string& path) {
+    if (thread.joinable()) {
+        return;
+    }
+    threshold = thresholdNanos;
+    dumpPath = path;
+    stopping = false;
+    // 卡顿时需要之前几秒的活动，从现在开始记录跟踪区间
+    Trace::start();
+    thread = std::thread(&Watchdog::monitorLoop, this);
+}
+
+// 停止监视线程
+void Watchdog::stop() {
+    if (!thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    stopCondition.notify_all();
+    thread.join();
+}
+
+// 从now开始监视
+void Watchdog::arm(WatchdogChannel channel, int64_t now, int64_t targetNanos) {
+    Channel& watched = channels[static_cast<int>(channel)];
+    watched.target.store(targetNanos, std::memory_order_relaxed);
+    watched.lastBeat.store(now, std::memory_order_relaxed);
+}
+
+// 停止监视
+void Watchdog::disarm(WatchdogChannel channel) {
+    channels[static_cast<int>(channel)].lastBeat.store(0, std::memory_order_relaxed);
+}
+
+// 一个周期开始
+void Watchdog::beat(WatchdogChannel channel, int64_t now, int64_t nextTargetNanos) {
+    Channel& watched = channels[static_cast<int>(channel)];
+    int64_t last = watched.lastBeat.load(std::memory_order_relaxed);
+    int64_t target = watched.target.load(std::memory_order_relaxed);
+    watched.target.store(nextTargetNanos, std::memory_order_relaxed);
+    watched.lastBeat.store(now, std::memory_order_relaxed);
+    if (last == 0) {
+        return;
+    }
+
+    int64_t interval = now - last;
+    watched.jitter.record(std::abs(interval - target));
+    if (interval > target + threshold) {
+        watched.stalls.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (interval > watched.worstInterval.load(std::memory_order_relaxed)) {
+        // 每个通道只有一个线程调用beat，不需要比较交换
+        watched.worstInterval.store(interval, std::memory_order_relaxed);
+    }
+}
+
+// 监视线程主循环
+// 只能发现持续时间超过一个检查间隔的卡顿，更短的卡顿由beat计入统计但不写跟踪文件
+void Watchdog::monitorLoop() {
+    ThreadStats::nameThread("watchdog");
+    std::chrono::nanoseconds poll(std::max(threshold / POLLS_PER_THRESHOLD, MIN_POLL_NANOS));
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopCondition.wait_for(lock, poll, [this] { return stopping; })) {
+        int64_t now = monotonicNanos();
+        for (int i = 0; i < static_cast<int>(WatchdogChannel::COUNT); i++) {
+            Channel& watched = channels[i];
+            int64_t last = watched.lastBeat.load(std::memory_order_relaxed);
+            int64_t target = watched.target.load(std::memory_order_relaxed);
+            if (last == 0 || last == watched.reportedBeat || now - last <= target + threshold) {
+                continue;
+            }
+            // 同一次卡顿只报告一次
+            watched.reportedBeat = last;
+            reportStall(static_cast<WatchdogChannel>(i), now - last, target);
+        }
+    }
+    ThreadStats::sampleCurrentThread();
+}
+
+// 报告卡顿并写出跟踪文件
+void Watchdog::reportStall(WatchdogChannel channel, int64_t silentNanos, int64_t target) {
+    int64_t now = monotonicNanos();
+    std::cerr << "Watchdog: " << CHANNEL_NAMES[static_cast<int>(channel)] << " stalled, nothing for "
+              << silentNanos / 1000000 << " ms (target " << target / 1000000 << " ms)" << std::endl;
+
+    // 跟踪文件已经包含之前几秒的活动，短时间内的多次卡顿只写一次
+    if (lastDump != 0 && now - lastDump < CONTEXT_NANOS) {
+        return;
+    }
+    lastDump = now;
+    if (Trace::writeFile(dumpPath, now - CONTEXT_NANOS)) {
+        dumpCount++;
+    } else {
+        std::cerr << "Watchdog: failed to write trace " << dumpPath << std::endl;
+    }
+}
+
+// 输出抖动和卡顿统计
+void Watchdog::report(std::ostream& out) const {
+    if (threshold == 0) {
+        return;
+    }
+    out << "Watchdog: stall threshold " << threshold / 1000000 << " ms, " << dumpCount << " trace dumps" << std::endl;
+    for (int i = 0; i < static_cast<int>(WatchdogChannel::COUNT); i++) {
+        const Channel& watched = channels[i];
+        if (watched.jitter.getCount() == 0) {
+            continue;
+        }
+        out << "  " << CHANNEL_NAMES[i] << ": " << watched.jitter.getCount() << " intervals, jitter mean "
+            << watched.jitter.getMeanMicros() << " us, p99 " << watched.jitter.getPercentileMicros(99) << " us, max "
+            << watched.jitter.getMaxMicros() << " us, " << watched.stalls.load(std::memory_order_relaxed)
+            << " stalls, longest interval " << watched.worstInterval.load(std::memory_order_relaxed) / 1000000
+            << " ms" << std::endl;
+    }
+}
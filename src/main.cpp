@@ -4,7 +4,19 @@
 #include <sys/stat.h>
 #include <limits.h>  // 添加PATH_MAX的头文件
 #include <libgen.h>  // 添加dirname函数的头文件
+#include <cstdlib>
+#include <cstdio>
+#include <csignal>
+#include <cstring>
 #include "../include/Game.h"
+#include "../include/LatencyBench.h"
+#include "../include/PlayerBench.h"
+#include "../include/FrameCheck.h"
+#include "../include/BatchRunner.h"
+#include "../include/Telemetry.h"
+#include "../include/Trace.h"
+#include "../include/ThreadStats.h"
+#include "../include/Log.h"
 
 // 检查目录是否存在
 bool directoryExists(const std::string& path) {
@@ -26,34 +38,317 @@ std::string getExecutableDir() {
     return ".";
 }
 
+// SIGUSR1：请求写出跟踪文件（信号处理函数中只设置标志，由主线程写文件）
+void onTraceSignal(int) {
+    Trace::requestFlush();
+}
+
+// 开始记录线程活动，收到SIGUSR1时写出跟踪文件
+void startTrace() {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onTraceSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, nullptr);
+    Trace::start();
+}
+
 // 主函数
 int main(int argc, char* argv[]) {
     // 设置屏幕大小和单元格大小
     const int SCREEN_WIDTH = 800;
     const int SCREEN_HEIGHT = 480;
     const int CELL_SIZE = 40;
+    // 地图每边最多的格子数（检查点用16位保存坐标，地图的格子数用int计算）
+    const int MAX_BOARD_SIZE = 4096;
+    // 对手蛇最多的数量
+    const int MAX_RIVALS = 256;
     
     // 获取可执行文件所在的目录
     std::string execDir = getExecutableDir();
     std::cout << "Executable directory: " << execDir << std::endl;
     
+    // 解析命令行参数：以--开头的是选项，其余第一个参数是资源路径
+    const char* resourceArg = nullptr;
+    std::string latencyReportPath;
+    int latencyBenchTurns = 0;
+    bool fastReplay = false;
+    int playerBenchGames = 0;
+    int rivalBenchTicks = 0;
+    bool resetBench = false;
+    int verifyFrames = 0;
+    PlayerKind benchPlayer = PlayerKind::AUTOPILOT;
+    int boardWidth = SCREEN_WIDTH / CELL_SIZE;
+    int boardHeight = SCREEN_HEIGHT / CELL_SIZE;
+    BatchOptions batch;
+    batch.games = 0;
+    GameOptions options;
+    std::string levelPath;
+    std::string telemetryName = "/greedy-snake";
+    std::string tracePath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--latency-report" && i + 1 < argc) {
+            // 退出时将输入延迟直方图写入文件
+            latencyReportPath = argv[++i];
+        } else if (arg == "--latency-bench" && i + 1 < argc) {
+            // 无头延迟测试，注入指定次数的合成转向
+            latencyBenchTurns = std::atoi(argv[++i]);
+        } else if (arg == "--runtime" && i + 1 < argc) {
+            // 运行模式：threaded（默认）或event-loop
+            std::string mode = argv[++i];
+            if (mode == "event-loop") {
+                options.runtime = RuntimeMode::EVENT_LOOP;
+            } else if (mode == "threaded") {
+                options.runtime = RuntimeMode::THREADED;
+            } else {
+                std::cerr << "Unknown runtime mode: " << mode << " (expected threaded or event-loop)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--tick-policy" && i + 1 < argc) {
+            // 游戏帧错过截止时间后：skip（默认，跳过错过的帧）或catch-up（连续执行追上进度）
+            std::string policy = argv[++i];
+            if (policy == "skip") {
+                options.tickPolicy = TickPolicy::SKIP;
+            } else if (policy == "catch-up") {
+                options.tickPolicy = TickPolicy::CATCH_UP;
+            } else {
+                std::cerr << "Unknown tick policy: " << policy << " (expected skip or catch-up)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--seed" && i + 1 < argc) {
+            // 固定随机种子（0表示随机）
+            options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--record" && i + 1 < argc) {
+            // 将本局录制到文件
+            options.recordPath = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            // 回放录像文件
+            options.replayPath = argv[++i];
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            // 每帧保存检查点，启动时从中恢复
+            options.checkpointPath = argv[++i];
+        } else if (arg == "--autopilot") {
+            // 自动驾驶（稳定性测试），游戏结束后自动开始下一局
+            options.player = PlayerKind::AUTOPILOT;
+        } else if (arg == "--attract") {
+            // 演示模式：自动驾驶，玩家操作时接管
+            options.player = PlayerKind::AUTOPILOT;
+            options.attractMode = true;
+        } else if (arg == "--autopilot-bench" && i + 1 < argc) {
+            // 无头自动驾驶测试，进行指定局数
+            playerBenchGames = std::atoi(argv[++i]);
+            benchPlayer = PlayerKind::AUTOPILOT;
+        } else if (arg == "--solver") {
+            // 哈密顿回路玩家，能填满整个地图
+            options.player = PlayerKind::SOLVER;
+        } else if (arg == "--solver-bench" && i + 1 < argc) {
+            // 无头哈密顿回路测试，进行指定局数
+            playerBenchGames = std::atoi(argv[++i]);
+            benchPlayer = PlayerKind::SOLVER;
+        } else if (arg == "--mcts") {
+            // 蒙特卡洛树搜索玩家，多线程推演
+            options.player = PlayerKind::MCTS;
+        } else if (arg == "--mcts-bench" && i + 1 < argc) {
+            // 无头MCTS测试，进行指定局数，报告每秒推演次数
+            playerBenchGames = std::atoi(argv[++i]);
+            benchPlayer = PlayerKind::MCTS;
+        } else if (arg == "--mcts-ms" && i + 1 < argc) {
+            // MCTS每次决策的时间预算（毫秒）
+            options.mcts.budgetMs = std::atoi(argv[++i]);
+            if (options.mcts.budgetMs <= 0) {
+                std::cerr << "Invalid MCTS budget: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--rivals" && i + 1 < argc) {
+            // 对手蛇数量，同时用于游戏、批量模拟和对手蛇测试
+            int rivals = std::atoi(argv[++i]);
+            if (rivals < 0 || rivals > MAX_RIVALS) {
+                std::cerr << "Invalid rival count: " << argv[i] << " (expected 0 to " << MAX_RIVALS << ")" << std::endl;
+                return 1;
+            }
+            options.rules.rivalSnakes = static_cast<size_t>(rivals);
+            batch.rules.rivalSnakes = options.rules.rivalSnakes;
+        } else if (arg == "--rivals-bench" && i + 1 < argc) {
+            // 无头对手蛇测试：每种蛇的数量执行指定帧数
+            rivalBenchTicks = std::atoi(argv[++i]);
+        } else if (arg == "--reset-bench") {
+            // 无头重新开局测试：重置耗时与上一局蛇长的关系
+            resetBench = true;
+        } else if (arg == "--board" && i + 1 < argc) {
+            // 地图尺寸（格子数），例如40x24；大于屏幕时摄像机跟随蛇头滚动
+            if (std::sscanf(argv[++i], "%dx%d", &boardWidth, &boardHeight) != 2 || boardWidth <= 0 || boardHeight <= 0) {
+                std::cerr << "Invalid board size: " << argv[i] << " (expected WIDTHxHEIGHT)" << std::endl;
+                return 1;
+            }
+            if (boardWidth > MAX_BOARD_SIZE || boardHeight > MAX_BOARD_SIZE) {
+                std::cerr << "Board size is limited to " << MAX_BOARD_SIZE << "x" << MAX_BOARD_SIZE << std::endl;
+                return 1;
+            }
+            options.mapWidth = boardWidth;
+            options.mapHeight = boardHeight;
+        } else if (arg == "--level" && i + 1 < argc) {
+            // 关卡文件（墙、出生点和食物区），地图尺寸由关卡决定
+            levelPath = argv[++i];
+        } else if (arg == "--compile-level" && i + 2 < argc) {
+            // 把文本关卡编译为关卡文件后退出
+            bool compiled = Level::compile(argv[i + 1], argv[i + 2]);
+            return compiled ? 0 : 1;
+        } else if (arg == "--telemetry" && i + 1 < argc) {
+            // 遥测共享内存的名称（snake-top读取），off表示不发布
+            telemetryName = argv[++i];
+            if (telemetryName != "off" && telemetryName[0] != '/') {
+                telemetryName = "/" + telemetryName;
+            }
+        } else if (arg == "--watchdog" && i + 1 < argc) {
+            // 卡顿阈值（毫秒）：游戏帧或渲染帧的间隔超过目标加上阈值时输出日志并写出最近几秒的跟踪
+            options.watchdogMs = std::atoi(argv[++i]);
+            if (options.watchdogMs <= 0) {
+                std::cerr << "Invalid watchdog threshold: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--watchdog-dump" && i + 1 < argc) {
+            // 卡顿时写出的跟踪文件
+            options.watchdogDumpPath = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            // 记录各线程的活动，退出时（以及收到SIGUSR1时）写成trace-event JSON文件
+            tracePath = argv[++i];
+        } else if (arg == "--batch" && i + 1 < argc) {
+            // 批量无头模拟，进行指定局数
+            batch.games = std::atoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            // 批量模拟和MCTS搜索的线程数（默认使用全部核心）
+            batch.threads = std::atoi(argv[++i]);
+            options.mcts.threads = batch.threads;
+        } else if (arg == "--rule" && i + 1 < argc) {
+            // 调整批量模拟的游戏规则，例如speed-min=120
+            if (!parseSimulationRule(argv[++i], batch.rules)) {
+                std::cerr << "Invalid rule: " << argv[i] << " (expected initial-speed, speed-base, speed-step,"
+                          << " speed-min, pepper-ms, max-foods, food-lifetime, rivals or food-weights=a,b,c,d)"
+                          << std::endl;
+                return 1;
+            }
+        } else if (arg == "--batch-out" && i + 1 < argc) {
+            // 批量模拟每局结果的CSV文件
+            batch.outputPath = argv[++i];
+        } else if (arg == "--verify-frames" && i + 1 < argc) {
+            // 画面校验：参考绘制与优化绘制逐帧比较，最多指定帧数（回放--replay给出的录像，否则自动驾驶）
+            verifyFrames = std::atoi(argv[++i]);
+        } else if (arg == "--log-check") {
+            // 日志限速自检：两种文本交替经过同一个语句时应被限速
+            return runLogCheck();
+        } else if (arg == "--checkpoint-check") {
+            // 检查点自检：CRC正确但蛇身不合法的槽应被拒绝并改用另一个槽
+            return runCheckpointCheck();
+        } else if (arg == "--fast") {
+            // 与--replay一起使用：无头快进回放并校验结果
+            fastReplay = true;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            std::cerr << "Usage: " << argv[0]
+                      << " [--runtime threaded|event-loop] [--tick-policy skip|catch-up] [--latency-report file]"
+                      << " [--latency-bench turns] [--seed n] [--record file]"
+                      << " [--replay file [--fast]] [--checkpoint file] [--autopilot | --attract | --solver | --mcts]"
+                      << " [--autopilot-bench games | --solver-bench games | --mcts-bench games] [--board WxH]"
+                      << " [--mcts-ms ms] [--rivals n] [--rivals-bench ticks] [--reset-bench] [--level file] [--telemetry name|off]"
+                      << " [--trace file] [--watchdog ms [--watchdog-dump file]] [--verify-frames frames] [--log-check] [--checkpoint-check]"
+                      << " [--compile-level text_file level_file]"
+                      << " [--batch games [--threads n] [--rule name=value]... [--batch-out file]]"
+                      << " [resource_path]" << std::endl;
+            return 1;
+        } else if (!resourceArg) {
+            resourceArg = argv[i];
+        }
+    }
+    
+#ifdef NO_TRACE
+    if (!tracePath.empty()) {
+        std::cerr << "Tracing is compiled out (built with TRACE=0), ignoring --trace" << std::endl;
+        tracePath.clear();
+    }
+    if (options.watchdogMs > 0) {
+        std::cerr << "Tracing is compiled out (built with TRACE=0), watchdog stall dumps will be empty" << std::endl;
+    }
+#endif
+    
+    // 录像和检查点只保存玩家的蛇
+    if (options.rules.rivalSnakes > 0 &&
+        (!options.recordPath.empty() || !options.replayPath.empty() || !options.checkpointPath.empty())) {
+        std::cerr << "--rivals cannot be combined with --record, --replay or --checkpoint" << std::endl;
+        return 1;
+    }
+    
+    // 关卡决定地图尺寸；哈密顿回路、录像和检查点都假设地图上没有墙
+    Level level;
+    if (!levelPath.empty()) {
+        if (options.player == PlayerKind::SOLVER || !options.recordPath.empty() || !options.replayPath.empty() ||
+            !options.checkpointPath.empty()) {
+            std::cerr << "--level cannot be combined with --solver, --record, --replay or --checkpoint" << std::endl;
+            return 1;
+        }
+        if (!level.load(levelPath)) {
+            return 1;
+        }
+        boardWidth = level.getWidth();
+        boardHeight = level.getHeight();
+        options.mapWidth = boardWidth;
+        options.mapHeight = boardHeight;
+        options.level = &level;
+        batch.level = &level;
+    }
+    
+    // 对手蛇测试只执行游戏逻辑，默认从0条逐次加倍到64条
+    if (rivalBenchTicks > 0) {
+        size_t maxRivals = options.rules.rivalSnakes > 0 ? options.rules.rivalSnakes : 64;
+        return runRivalBench(rivalBenchTicks, maxRivals, options.seed != 0 ? options.seed : 1, boardWidth, boardHeight);
+    }
+    
+    // 重新开局测试只执行游戏逻辑
+    if (resetBench) {
+        return runResetBench(options.seed != 0 ? options.seed : 1, boardWidth, boardHeight);
+    }
+    
+    // 快进回放只执行游戏逻辑，不需要资源文件
+    if (fastReplay) {
+        if (options.replayPath.empty()) {
+            std::cerr << "--fast requires --replay file" << std::endl;
+            return 1;
+        }
+        return runReplayFastForward(options.replayPath);
+    }
+    
+    // 批量模拟同样只执行游戏逻辑，默认使用自动驾驶
+    if (batch.games > 0) {
+        if (options.player == PlayerKind::MCTS) {
+            std::cerr << "Batch runs do not support the MCTS player (it already uses every core per decision)"
+                      << std::endl;
+            return 1;
+        }
+        batch.seed = options.seed != 0 ? options.seed : 1;
+        batch.player = options.player == PlayerKind::SOLVER ? PlayerKind::SOLVER : PlayerKind::AUTOPILOT;
+        batch.mapWidth = boardWidth;
+        batch.mapHeight = boardHeight;
+        return runBatch(batch);
+    }
+    
     // 检查资源路径参数
     std::string resourcePath = execDir + "/assets/pic";
-    if (argc > 1) {
+    if (resourceArg) {
         // 如果提供了命令行参数，使用绝对路径
-        if (argv[1][0] == '/') {
+        if (resourceArg[0] == '/') {
             // 已经是绝对路径
-            resourcePath = argv[1];
+            resourcePath = resourceArg;
         } else {
             // 相对路径，转换为绝对路径
             char absPath[PATH_MAX];
-            if (realpath(argv[1], absPath) != nullptr) {
+            if (realpath(resourceArg, absPath) != nullptr) {
                 resourcePath = absPath;
             } else {
                 // 如果转换失败，尝试基于当前目录构建路径
                 char cwd[PATH_MAX];
                 if (getcwd(cwd, sizeof(cwd)) != nullptr) {
-                    resourcePath = std::string(cwd) + "/" + argv[1];
+                    resourcePath = std::string(cwd) + "/" + resourceArg;
                 }
             }
         }
@@ -120,9 +415,35 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    // 无头自动玩家测试在内存帧缓冲区上测量绘制
+    if (playerBenchGames > 0) {
+        return runPlayerBench(benchPlayer, playerBenchGames, options.seed != 0 ? options.seed : 1,
+                              boardWidth, boardHeight, resourcePath, options.mcts);
+    }
+    
+    // 画面校验在两块内存帧缓冲区上绘制
+    if (verifyFrames > 0) {
+        return runFrameCheck(verifyFrames, options.seed != 0 ? options.seed : 1, boardWidth, boardHeight, resourcePath,
+                             options);
+    }
+    
+    // 无头延迟测试不需要屏幕和触摸屏
+    if (latencyBenchTurns > 0) {
+        if (!tracePath.empty()) {
+            startTrace();
+        }
+        Log::start();
+        int result = runLatencyBench(resourcePath, latencyBenchTurns, latencyReportPath, options);
+        Log::stop();
+        if (!tracePath.empty() && !Trace::writeFile(tracePath)) {
+            std::cerr << "Failed to write trace: " << tracePath << std::endl;
+        }
+        return result;
+    }
+    
     try {
         // 创建游戏对象
-        Game game(SCREEN_WIDTH, SCREEN_HEIGHT, CELL_SIZE, resourcePath);
+        Game game(SCREEN_WIDTH, SCREEN_HEIGHT, CELL_SIZE, resourcePath, options);
         
         // 初始化游戏
         if (!game.initialize()) {
@@ -130,28 +451,48 @@ int main(int argc, char* argv[]) {
             return 1;
         }
         
+        // 发布遥测计数器，失败时只是无法从外部查看
+        if (telemetryName != "off") {
+            Telemetry::publish(telemetryName);
+        }
+        if (!tracePath.empty()) {
+            startTrace();
+        }
+        
+        // 游戏、渲染和输入线程的日志由后台线程写出
+        Log::start();
+        
         // 开始游戏
         game.start();
         
         // 等待游戏结束
+        // 游戏结束画面、重新开始的提示、自动开始下一局和回放结束后的退出都由游戏中的界面状态机按超时事件处理，
+        // 在同一个进程中开始新的一局（资源检查、帧缓冲区映射、背景缓存和线程创建都只做一次）
         while (game.getState() != GameState::EXIT) {
-            // 检查游戏是否结束
-            if (game.getState() == GameState::GAME_OVER) {
-                std::cout << "Game Over! Exiting..." << std::endl;
-                
-                // 等待一段时间后退出游戏
-                sleep(3);
-                
-                // 设置游戏状态为EXIT，直接退出游戏
-                game.exit();
-            }
-            
-            // 控制主循环频率
+            // 控制主循环频率，顺便采样各线程的CPU时间
             sleep(1);
+            ThreadStats::sample();
+            
+            // 按需写出跟踪文件（不影响游戏和渲染线程）
+            if (Trace::takeFlushRequest() && !Trace::writeFile(tracePath)) {
+                std::cerr << "Failed to write trace: " << tracePath << std::endl;
+            }
         }
         
         // 等待所有游戏线程结束
         game.waitForThreads();
+        Log::stop();
+        Telemetry::unpublish();
+        
+        // 输出输入延迟和运行时统计
+        game.getLatencyTracker().report(std::cout);
+        game.reportRuntimeStats(std::cout);
+        if (!latencyReportPath.empty() && !game.getLatencyTracker().writeReport(latencyReportPath)) {
+            std::cerr << "Failed to write latency report: " << latencyReportPath << std::endl;
+        }
+        if (!tracePath.empty() && !Trace::writeFile(tracePath)) {
+            std::cerr << "Failed to write trace: " << tracePath << std::endl;
+        }
         
         std::cout << "Game exited." << std::endl;
         return 0;
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+#include <cerrno>
+#include <signal.h>
+#include <unistd.h>
+#include "../include/Telemetry.h"
+#include "../include/Latency.h"
+
+// snake-top：轮询游戏发布在共享内存中的遥测计数器，显示当前值和每秒的变化
+// 只读映射，不与游戏进程交换任何消息，对游戏没有影响
+int main(int argc, char* argv[]) {
+    std::string name = "/greedy-snake";
+    int intervalMs = 1000;
+    bool once = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--name" && i + 1 < argc) {
+            name = argv[++i];
+            if (name[0] != '/') {
+                name = "/" + name;
+            }
+        } else if (arg == "--interval" && i + 1 < argc) {
+            intervalMs = std::atoi(argv[++i]);
+        } else if (arg == "--once") {
+            once = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--name shm_name] [--interval ms] [--once]" << std::endl;
+            return 1;
+        }
+    }
+    if (intervalMs <= 0) {
+        std::cerr << "Invalid interval: " << intervalMs << std::endl;
+        return 1;
+    }
+
+    const size_t counterCount = static_cast<size_t>(TelemetryCounter::COUNT);
+    const TelemetryBlock* block = nullptr;
+    uint64_t previous[static_cast<size_t>(TelemetryCounter::COUNT)] = {};
+    int64_t previousTime = 0;
+    bool waiting = false;
+    while (true) {
+        // 游戏重新启动时会新建共享内存，旧进程退出后重新映射
+        if (block && kill(block->pid, 0) != 0 && errno == ESRCH) {
+            Telemetry::detach(block);
+            block = nullptr;
+        }
+        if (!block) {
+            block = Telemetry::attach(name);
+            previousTime = 0;
+        }
+        if (!block) {
+            if (once) {
+                std::cerr << "No telemetry published at " << name << std::endl;
+                return 1;
+            }
+            if (!waiting) {
+                std::cout << "Waiting for the game to publish telemetry at " << name << "..." << std::endl;
+                waiting = true;
+            }
+            usleep(intervalMs * 1000);
+            continue;
+        }
+        waiting = false;
+
+        // 逐个原子读取（各计数器之间不保证是同一时刻的值）
+        uint64_t values[static_cast<size_t>(TelemetryCounter::COUNT)];
+        for (size_t i = 0; i < counterCount; i++) {
+            values[i] = block->values[i].load(std::memory_order_relaxed);
+        }
+        int64_t now = monotonicNanos();
+        double seconds = previousTime > 0 ? (now - previousTime) / 1e9 : 0.0;
+
+        if (!once) {
+            std::cout << "\033[H\033[2J";
+        }
+        std::cout << "greedy-snake pid " << block->pid << " (" << name << ")" << std::endl;
+        std::cout << std::left << std::setw(20) << "counter" << std::right << std::setw(16) << "value"
+                  << std::setw(14) << "per second" << std::endl;
+        for (size_t i = 0; i < counterCount; i++) {
+            TelemetryCounter counter = static_cast<TelemetryCounter>(i);
+            std::cout << std::left << std::setw(20) << Telemetry::counterName(counter) << std::right
+                      << std::setw(16) << values[i];
+            if (!Telemetry::isGauge(counter) && seconds > 0) {
+                std::cout << std::setw(14) << std::fixed << std::setprecision(1)
+                          << (values[i] - previous[i]) / seconds;
+            }
+            std::cout << std::endl;
+            previous[i] = values[i];
+        }
+        previousTime = now;
+
+        if (once) {
+            break;
+        }
+        usleep(intervalMs * 1000);
+    }
+    Telemetry::detach(block);
+    return 0;
+}